@@ -0,0 +1,278 @@
+#include "actorgraph.h"
+#include <stdlib.h>
+#include <string.h>
+
+void initActorGraph(ActorGraph *graph) {
+  memset(graph, 0, sizeof(*graph));
+  initNameTable(&graph->actors);
+}
+
+void freeActorGraph(ActorGraph *graph) {
+  int side;
+
+  freeNameTable(&graph->actors);
+  free(graph->actorStart);
+  free(graph->actorMovies);
+  free(graph->castStart);
+  free(graph->movieCast);
+  for (side = 0; side < 2; side++) {
+    free(graph->depth[side]);
+    free(graph->parentActor[side]);
+    free(graph->parentMovie[side]);
+    free(graph->movieSeen[side]);
+    free(graph->queue[side]);
+  }
+  initActorGraph(graph);
+}
+
+/* Intern the casts and lay out both directions of the movie/actor
+   incidence in CSR form - two counting passes, no sorting */
+static int buildActorGraph(ActorGraph *graph, const MovieDatabase *db) {
+  int n = db->count;
+  int totalCast = 0, actorCount, side, ok = 1;
+  int p, i, j, id, slot;
+  int *next;
+
+  freeActorGraph(graph);
+
+  for (p = 0; p < n; p++) {
+    totalCast += db->movies[p].actorCount;
+  }
+
+  graph->castStart = (int *)malloc((size_t)(n + 1) * sizeof(int));
+  graph->movieCast = (int *)malloc((size_t)(totalCast + 1) * sizeof(int));
+  if (graph->castStart == NULL || graph->movieCast == NULL) {
+    freeActorGraph(graph);
+    return 0;
+  }
+
+  /* Movie -> distinct cast ids */
+  graph->castStart[0] = 0;
+  for (p = 0; ok && p < n; p++) {
+    slot = graph->castStart[p];
+    for (i = 0; ok && i < db->movies[p].actorCount; i++) {
+      id = internName(&graph->actors, db->movies[p].actors[i]);
+      ok = id >= 0;
+      j = graph->castStart[p];
+      while (j < slot && graph->movieCast[j] != id) {
+        j++;
+      }
+      if (ok && j == slot) {
+        graph->movieCast[slot++] = id;
+      }
+    }
+    graph->castStart[p + 1] = slot;
+  }
+
+  actorCount = graph->actors.count;
+  graph->actorStart = (int *)calloc((size_t)actorCount + 1, sizeof(int));
+  graph->actorMovies =
+      (int *)malloc((size_t)(graph->castStart[n] + 1) * sizeof(int));
+  next = (int *)malloc((size_t)(actorCount + 1) * sizeof(int));
+  for (side = 0; side < 2; side++) {
+    graph->depth[side] = (int *)malloc((size_t)(actorCount + 1) * sizeof(int));
+    graph->parentActor[side] =
+        (int *)malloc((size_t)(actorCount + 1) * sizeof(int));
+    graph->parentMovie[side] =
+        (int *)malloc((size_t)(actorCount + 1) * sizeof(int));
+    graph->queue[side] = (int *)malloc((size_t)(actorCount + 1) * sizeof(int));
+    graph->movieSeen[side] =
+        (unsigned int *)calloc((size_t)n + 1, sizeof(unsigned int));
+    ok = ok && graph->depth[side] != NULL &&
+         graph->parentActor[side] != NULL &&
+         graph->parentMovie[side] != NULL && graph->queue[side] != NULL &&
+         graph->movieSeen[side] != NULL;
+  }
+  if (!ok || graph->actorStart == NULL || graph->actorMovies == NULL ||
+      next == NULL) {
+    free(next);
+    freeActorGraph(graph);
+    return 0;
+  }
+
+  /* Actor -> movies, the transpose of the cast lists */
+  for (j = 0; j < graph->castStart[n]; j++) {
+    graph->actorStart[graph->movieCast[j] + 1]++;
+  }
+  for (id = 0; id < actorCount; id++) {
+    graph->actorStart[id + 1] += graph->actorStart[id];
+  }
+  memcpy(next, graph->actorStart, (size_t)actorCount * sizeof(int));
+  for (p = 0; p < n; p++) {
+    for (j = graph->castStart[p]; j < graph->castStart[p + 1]; j++) {
+      graph->actorMovies[next[graph->movieCast[j]]++] = p;
+    }
+  }
+  free(next);
+
+  for (side = 0; side < 2; side++) {
+    for (id = 0; id < actorCount; id++) {
+      graph->depth[side][id] = -1;
+    }
+  }
+
+  graph->built = 1;
+  graph->version = db->version;
+  graph->movieCount = n;
+  return 1;
+}
+
+int prepareActorGraph(ActorGraph *graph, const MovieDatabase *db) {
+  if (graph->built && graph->version == db->version &&
+      graph->movieCount == db->count) {
+    return 1;
+  }
+  return buildActorGraph(graph, db);
+}
+
+/* Expand one whole BFS level of a side. Returns the actor with the
+   shortest total path through it if the level touched the other side,
+   or -1 */
+static int expandLevel(ActorGraph *graph, int side, int *head, int *tail) {
+  int other = 1 - side;
+  int levelEnd = *tail;
+  int best = -1, bestLength = 0;
+  int actor, movie, costar, i, j, length;
+
+  for (; *head < levelEnd; (*head)++) {
+    actor = graph->queue[side][*head];
+    for (i = graph->actorStart[actor]; i < graph->actorStart[actor + 1];
+         i++) {
+      movie = graph->actorMovies[i];
+      if (graph->movieSeen[side][movie] == graph->stamp) {
+        continue;
+      }
+      graph->movieSeen[side][movie] = graph->stamp;
+
+      for (j = graph->castStart[movie]; j < graph->castStart[movie + 1];
+           j++) {
+        costar = graph->movieCast[j];
+        if (graph->depth[side][costar] != -1) {
+          continue;
+        }
+        graph->depth[side][costar] = graph->depth[side][actor] + 1;
+        graph->parentActor[side][costar] = actor;
+        graph->parentMovie[side][costar] = movie;
+        graph->queue[side][(*tail)++] = costar;
+
+        if (graph->depth[other][costar] != -1) {
+          length = graph->depth[side][costar] + graph->depth[other][costar];
+          if (best == -1 || length < bestLength) {
+            best = costar;
+            bestLength = length;
+          }
+        }
+      }
+    }
+  }
+
+  return best;
+}
+
+/* Forget the actors reached by the last query */
+static void resetSearch(ActorGraph *graph, const int *tail) {
+  int side, i;
+
+  for (side = 0; side < 2; side++) {
+    for (i = 0; i < tail[side]; i++) {
+      graph->depth[side][graph->queue[side][i]] = -1;
+    }
+  }
+}
+
+/* Grow the smaller frontier one level at a time until the two searches
+   meet. Each side only covers about half the distance, which on a graph
+   with a wide fan-out reaches far fewer actors than a one-sided BFS */
+int findActorPath(ActorGraph *graph, int from, int to, int *actors,
+                  int *movies, int maxActors) {
+  int head[2], tail[2], roots[2];
+  int meet = -1, side, count, actor, i, t;
+
+  if (from < 0 || to < 0 || from >= graph->actors.count ||
+      to >= graph->actors.count || maxActors < 1) {
+    return 0;
+  }
+  if (from == to) {
+    actors[0] = from;
+    return 1;
+  }
+
+  /* New stamp for the expanded-movie marks, clearing them on wrap */
+  if (++graph->stamp == 0) {
+    for (side = 0; side < 2; side++) {
+      memset(graph->movieSeen[side], 0,
+             (size_t)graph->movieCount * sizeof(unsigned int));
+    }
+    graph->stamp = 1;
+  }
+
+  roots[0] = from;
+  roots[1] = to;
+  for (side = 0; side < 2; side++) {
+    graph->depth[side][roots[side]] = 0;
+    graph->parentActor[side][roots[side]] = -1;
+    graph->queue[side][0] = roots[side];
+    head[side] = 0;
+    tail[side] = 1;
+  }
+
+  while (meet == -1 && head[0] < tail[0] && head[1] < tail[1]) {
+    side = (tail[0] - head[0] <= tail[1] - head[1]) ? 0 : 1;
+    meet = expandLevel(graph, side, &head[side], &tail[side]);
+  }
+
+  if (meet == -1) {
+    resetSearch(graph, tail);
+    return 0;
+  }
+
+  count = graph->depth[0][meet] + graph->depth[1][meet] + 1;
+  if (count > maxActors) {
+    resetSearch(graph, tail);
+    return -1;
+  }
+
+  /* Source half, written backwards from the meeting actor */
+  i = graph->depth[0][meet];
+  for (actor = meet; actor != from; actor = graph->parentActor[0][actor]) {
+    actors[i] = actor;
+    movies[i - 1] = graph->parentMovie[0][actor];
+    i--;
+  }
+  actors[0] = from;
+
+  /* Target half, forwards */
+  i = graph->depth[0][meet];
+  for (actor = meet; actor != to; actor = t) {
+    t = graph->parentActor[1][actor];
+    movies[i] = graph->parentMovie[1][actor];
+    actors[++i] = t;
+  }
+
+  resetSearch(graph, tail);
+  return count;
+}
+
+/* Every array has one spare entry so empty catalogues still allocate */
+long getActorGraphBytes(const ActorGraph *graph, long *used) {
+  long allocated, actors, movies, cast, entries;
+
+  allocated = getNameTableBytes(&graph->actors, used);
+  if (!graph->built) {
+    return allocated;
+  }
+
+  actors = graph->actors.count;
+  movies = graph->movieCount;
+  cast = graph->castStart[graph->movieCount];
+
+  /* actorStart, castStart, both incidence lists, then per side depth,
+     parentActor, parentMovie, queue and movieSeen */
+  entries = (actors + 1) + (movies + 1) + 2 * (cast + 1) +
+            2 * (4 * (actors + 1) + (movies + 1));
+  allocated += entries * (long)sizeof(int);
+  *used += (actors + 1 + movies + 1 + 2 * cast +
+            2 * (4 * actors + movies)) *
+           (long)sizeof(int);
+  return allocated;
+}
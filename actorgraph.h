@@ -0,0 +1,52 @@
+#ifndef ACTORGRAPH_H
+#define ACTORGRAPH_H
+
+#include "names.h"
+#include "types.h"
+
+/* Longest actor chain a path query reports */
+#define MAX_PATH_ACTORS 32
+
+/* Co-star graph - actors are nodes, linked through every movie they share.
+   Kept as bipartite CSR (actor -> movies, movie -> cast), so it builds in
+   one pass and its size is linear in the cast lists rather than quadratic
+   in cast size. Rebuilt when the database version changes */
+typedef struct {
+  int built;
+  unsigned long version; /* Database version the graph belongs to */
+  int movieCount;
+  NameTable actors;
+  /* Movies of actor a are actorMovies[actorStart[a]..actorStart[a+1]] */
+  int *actorStart;
+  int *actorMovies;
+  /* Distinct cast of position p is movieCast[castStart[p]..castStart[p+1]] */
+  int *castStart;
+  int *movieCast;
+  /* Search state per side (0 from the source, 1 from the target) */
+  int *depth[2];       /* -1 when not reached */
+  int *parentActor[2]; /* Previous actor on the way from the side's root */
+  int *parentMovie[2]; /* Movie shared with that actor */
+  unsigned int *movieSeen[2]; /* Equal to stamp once the cast is expanded */
+  int *queue[2];              /* Reached actors, in BFS order */
+  unsigned int stamp;         /* Current query */
+} ActorGraph;
+
+void initActorGraph(ActorGraph *graph);
+void freeActorGraph(ActorGraph *graph);
+
+/* Build the graph if it is missing or stale, returns 0 on allocation
+   failure */
+int prepareActorGraph(ActorGraph *graph, const MovieDatabase *db);
+
+/* Shortest chain between two actor ids (bidirectional BFS). Fills actors
+   with the chain and movies with the position linking actors[i] and
+   actors[i + 1]. Returns the number of actors, 0 if they are not
+   connected, -1 if the chain is longer than maxActors */
+int findActorPath(ActorGraph *graph, int from, int to, int *actors,
+                  int *movies, int maxActors);
+
+/* Heap bytes of the name table, both CSR directions and the search state,
+   bytes in use in *used */
+long getActorGraphBytes(const ActorGraph *graph, long *used);
+
+#endif /* ACTORGRAPH_H */
@@ -0,0 +1,201 @@
+#include "analytics.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIRST_DECADE (MIN_YEAR / 10)
+#define DECADE_COUNT (MAX_YEAR / 10 - FIRST_DECADE + 1)
+
+/* Name table used by compareDirectorGroups (qsort has no context) */
+static const NameTable *sortNames = NULL;
+
+/* Get display name of a group-by key */
+const char *getGroupByName(GroupBy groupBy) {
+  switch (groupBy) {
+  case GROUP_BY_GENRE:
+    return "Genre";
+  case GROUP_BY_DIRECTOR:
+    return "Director";
+  case GROUP_BY_DECADE:
+    return "Decade";
+  case GROUP_BY_YEAR:
+    return "Year";
+  }
+  return "Unknown";
+}
+
+/* Format the label of a group */
+void getGroupLabel(const AnalyticsReport *report, const GroupStats *group,
+                   char *buffer, int bufferSize) {
+  char label[MAX_STRING_LENGTH];
+
+  switch (report->groupBy) {
+  case GROUP_BY_GENRE:
+    sprintf(label, "%s", getGenreName((Genre)group->key));
+    break;
+  case GROUP_BY_DIRECTOR:
+    strncpy(label, getNameById(&report->directors, group->key),
+            MAX_STRING_LENGTH - 1);
+    label[MAX_STRING_LENGTH - 1] = '\0';
+    break;
+  case GROUP_BY_DECADE:
+    sprintf(label, "%ds", group->key);
+    break;
+  default:
+    sprintf(label, "%d", group->key);
+    break;
+  }
+
+  strncpy(buffer, label, bufferSize - 1);
+  buffer[bufferSize - 1] = '\0';
+}
+
+/* Directors are listed by movie count (descending), then by name */
+static int compareDirectorGroups(const void *a, const void *b) {
+  const GroupStats *groupA = (const GroupStats *)a;
+  const GroupStats *groupB = (const GroupStats *)b;
+
+  if (groupA->movieCount != groupB->movieCount) {
+    return groupB->movieCount - groupA->movieCount;
+  }
+  return strcmp(getNameById(sortNames, groupA->key),
+                getNameById(sortNames, groupB->key));
+}
+
+/* Add one movie's numeric fields to a group */
+static void accumulate(GroupStats *group, const Movie *movie) {
+  group->movieCount++;
+  group->ratingSum += movie->rating;
+  group->revenueSum += movie->revenue;
+  group->favoriteSum += movie->favorite;
+  group->durationSum += movie->duration;
+}
+
+/* Compute grouped stats in one pass over the movies. Groups are dense
+   arrays indexed directly by the key (genre bit, interned director id,
+   decade or year offset), so each movie costs O(1) per group it joins. */
+int computeAnalytics(const MovieDatabase *db, GroupBy groupBy,
+                     AnalyticsReport *report) {
+  int slotCount, i, j, kept;
+  unsigned long genreMask;
+  int directorId;
+
+  if (db == NULL || report == NULL) {
+    return 0;
+  }
+
+  report->groupBy = groupBy;
+  report->groups = NULL;
+  report->groupCount = 0;
+  initNameTable(&report->directors);
+
+  switch (groupBy) {
+  case GROUP_BY_GENRE:
+    slotCount = GENRE_WESTERN + 1;
+    break;
+  case GROUP_BY_DIRECTOR:
+    slotCount = db->count;
+    break;
+  case GROUP_BY_DECADE:
+    slotCount = DECADE_COUNT;
+    break;
+  default:
+    slotCount = YEAR_BUCKETS;
+    break;
+  }
+
+  if (slotCount == 0) {
+    return 1;
+  }
+
+  report->groups = (GroupStats *)calloc(slotCount, sizeof(GroupStats));
+  if (report->groups == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  for (i = 0; i < db->count; i++) {
+    const Movie *movie = &db->movies[i];
+
+    switch (groupBy) {
+    case GROUP_BY_GENRE:
+      /* A movie joins each distinct genre in its mask once */
+      genreMask = 0;
+      for (j = 0; j < movie->genreCount; j++) {
+        if (movie->genres[j] <= GENRE_WESTERN) {
+          genreMask |= 1UL << movie->genres[j];
+        }
+      }
+      for (j = 0; genreMask != 0; j++, genreMask >>= 1) {
+        if (genreMask & 1UL) {
+          accumulate(&report->groups[j], movie);
+        }
+      }
+      break;
+
+    case GROUP_BY_DIRECTOR:
+      directorId = internName(&report->directors, movie->director);
+      if (directorId < 0) {
+        freeAnalyticsReport(report);
+        return 0;
+      }
+      accumulate(&report->groups[directorId], movie);
+      break;
+
+    case GROUP_BY_DECADE:
+      if (isValidYear(movie->year)) {
+        accumulate(&report->groups[movie->year / 10 - FIRST_DECADE], movie);
+      }
+      break;
+
+    default:
+      if (isValidYear(movie->year)) {
+        accumulate(&report->groups[movie->year - MIN_YEAR], movie);
+      }
+      break;
+    }
+  }
+
+  /* Fill in keys and drop empty groups */
+  kept = 0;
+  for (i = 0; i < slotCount; i++) {
+    if (report->groups[i].movieCount == 0) {
+      continue;
+    }
+    report->groups[kept] = report->groups[i];
+    switch (groupBy) {
+    case GROUP_BY_DECADE:
+      report->groups[kept].key = (i + FIRST_DECADE) * 10;
+      break;
+    case GROUP_BY_YEAR:
+      report->groups[kept].key = i + MIN_YEAR;
+      break;
+    default:
+      report->groups[kept].key = i;
+      break;
+    }
+    kept++;
+  }
+  report->groupCount = kept;
+
+  if (groupBy == GROUP_BY_DIRECTOR) {
+    sortNames = &report->directors;
+    qsort(report->groups, kept, sizeof(GroupStats), compareDirectorGroups);
+    sortNames = NULL;
+  }
+
+  return 1;
+}
+
+/* Release memory owned by a report */
+void freeAnalyticsReport(AnalyticsReport *report) {
+  if (report == NULL) {
+    return;
+  }
+
+  free(report->groups);
+  report->groups = NULL;
+  report->groupCount = 0;
+  freeNameTable(&report->directors);
+}
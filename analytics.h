@@ -0,0 +1,35 @@
+#ifndef ANALYTICS_H
+#define ANALYTICS_H
+
+#include "names.h"
+#include "types.h"
+
+/* Aggregated statistics for one group */
+typedef struct {
+  int key;            /* Genre, director id, decade start or year */
+  int movieCount;     /* Movies in the group */
+  double ratingSum;   /* Sum of ratings */
+  double revenueSum;  /* Sum of revenue (millions) */
+  double favoriteSum; /* Sum of favorite counts */
+  double durationSum; /* Sum of durations (minutes) */
+} GroupStats;
+
+/* Grouped report - only non-empty groups are kept */
+typedef struct {
+  GroupBy groupBy;
+  GroupStats *groups;
+  int groupCount;
+  NameTable directors; /* Interned director names (GROUP_BY_DIRECTOR) */
+} AnalyticsReport;
+
+/* Compute grouped stats in a single pass, returns 1 on success */
+int computeAnalytics(const MovieDatabase *db, GroupBy groupBy,
+                     AnalyticsReport *report);
+void freeAnalyticsReport(AnalyticsReport *report);
+
+/* Report helpers */
+const char *getGroupByName(GroupBy groupBy);
+void getGroupLabel(const AnalyticsReport *report, const GroupStats *group,
+                   char *buffer, int bufferSize);
+
+#endif /* ANALYTICS_H */
@@ -0,0 +1,476 @@
+/* Microbenchmarks for the string and CSV helpers used on the import and
+   search paths.
+
+   Usage: cinemania-bench [--baseline FILE] [--write FILE] [--threshold PCT]
+
+   Each helper is timed on several realistic input sizes. With --baseline
+   the ns/op figures are compared against a JSON object of
+   "helper/size": ns pairs and the program exits with status 1 when any
+   case is slower than the baseline by more than the threshold (default
+   25%). A case over the threshold is timed again before it counts, so a
+   noisy measurement does not fail the run. --write stores the current
+   figures as a new baseline, taking the median of several measurements
+   per case so it holds typical rather than lucky figures.
+
+   Timings only compare within one machine, so the baseline is not kept in
+   the repository - "make bench" records it on the first run and checks
+   against it afterwards. */
+
+#include "fileio.h"
+#include "types.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_CYCLE_COUNTER
+#endif
+
+#define MAX_INPUT_LENGTH 1024
+#define MAX_CASES 32
+#define MAX_CASE_NAME 48
+#define MIN_SAMPLE_CLOCKS (CLOCKS_PER_SEC / 20)
+#define SAMPLE_COUNT 5
+#define DEFAULT_THRESHOLD 25.0
+#define RETIME_ATTEMPTS 5
+#define BASELINE_RUNS 3
+
+/* Input of one benchmark case, prepared before timing */
+typedef struct {
+  char text[MAX_INPUT_LENGTH + 1]; /* Pristine input */
+  char work[MAX_INPUT_LENGTH + 1]; /* Scratch copy for in-place helpers */
+  char output[MAX_INPUT_LENGTH + 1];
+  int length;
+} BenchInput;
+
+/* One timed operation, returns a value folded into the sink */
+typedef unsigned long (*BenchFunction)(BenchInput *input);
+
+/* Measured case */
+typedef struct {
+  char name[MAX_CASE_NAME];
+  int bytes;
+  double nsPerOp;
+  double bytesPerCycle; /* 0 when no cycle counter is available */
+  double baselineNs;    /* 0 when the baseline has no entry */
+} BenchResult;
+
+/* Baseline figure of one case */
+typedef struct {
+  char name[MAX_CASE_NAME];
+  double ns;
+} BaselineEntry;
+
+/* Keeps the timed calls observable */
+static unsigned long benchSink = 0;
+
+/* Loaded baseline, empty without --baseline */
+static BaselineEntry baselineEntries[MAX_CASES];
+static int baselineCount = 0;
+static double regressionThreshold = DEFAULT_THRESHOLD;
+
+/* Measurements per case, BASELINE_RUNS when writing a baseline */
+static int measureRuns = 1;
+
+/* Realistic text - a movie description */
+static const char sampleText[] =
+    "A stranger in the city asks questions no one has asked before. His "
+    "childlike curiosity will take him on a journey of love, laughter, and "
+    "letting go. ";
+
+/* Realistic numeric tail of an import line */
+static const char sampleNumbers[] = "8,2;103279;10,57;";
+
+/* Timestamp counter, or 0 */
+static unsigned long readCycles(void) {
+#ifdef HAVE_CYCLE_COUNTER
+  return (unsigned long)__builtin_ia32_rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/* Fill dest with length characters of a repeating pattern */
+static void repeatText(char *dest, const char *pattern, int length) {
+  int patternLength = (int)strlen(pattern);
+  int i;
+
+  for (i = 0; i < length; i++) {
+    dest[i] = pattern[i % patternLength];
+  }
+  dest[length] = '\0';
+}
+
+/* Quoted CSV cell with escaped quotes, followed by the next field */
+static void makeQuotedField(char *dest, int length) {
+  repeatText(dest, sampleText, length);
+  if (length < 6) {
+    return;
+  }
+  dest[0] = '"';
+  dest[length / 2] = '"';
+  dest[length / 2 + 1] = '"';
+  dest[length - 2] = '"';
+  dest[length - 1] = ';';
+}
+
+static unsigned long benchTrim(BenchInput *input) {
+  memcpy(input->work, input->text, input->length + 1);
+  trimString(input->work);
+  return (unsigned long)(unsigned char)input->work[0];
+}
+
+static unsigned long benchToLower(BenchInput *input) {
+  toLowerString(input->output, input->text);
+  return (unsigned long)(unsigned char)input->output[0];
+}
+
+static unsigned long benchContains(BenchInput *input) {
+  /* Absent needle - every haystack position is examined */
+  return (unsigned long)containsSubstring(input->text, "qzx");
+}
+
+static unsigned long benchParseField(BenchInput *input) {
+  char *line = input->text;
+
+  parseCSVField(&line, input->output, MAX_INPUT_LENGTH);
+  return (unsigned long)(line - input->text);
+}
+
+static unsigned long benchReplaceComma(BenchInput *input) {
+  memcpy(input->work, input->text, input->length + 1);
+  replaceCommaWithDot(input->work);
+  return (unsigned long)(unsigned char)input->work[1];
+}
+
+static unsigned long benchDecimal(BenchInput *input) {
+  double value = 0.0;
+
+  parseDecimalField(input->text, 0.0, 1e12, &value);
+  return (unsigned long)value;
+}
+
+static unsigned long benchInteger(BenchInput *input) {
+  long value = 0;
+
+  parseIntegerField(input->text, 0, 9999, &value);
+  return (unsigned long)value;
+}
+
+static unsigned long benchGenre(BenchInput *input) {
+  return (unsigned long)getGenreFromString(input->text);
+}
+
+/* Time one sample of iterations calls */
+static void timeSample(BenchFunction function, BenchInput *input,
+                       unsigned long iterations, clock_t *elapsed,
+                       unsigned long *cycles) {
+  unsigned long i;
+  clock_t start;
+
+  *cycles = readCycles();
+  start = clock();
+  for (i = 0; i < iterations; i++) {
+    benchSink += function(input);
+  }
+  *elapsed = clock() - start;
+  *cycles = readCycles() - *cycles;
+}
+
+/* Size the sample until it is long enough, then keep the fastest of
+   several samples so scheduler noise does not read as a regression */
+static void measureCase(BenchFunction function, BenchInput *input,
+                        BenchResult *result) {
+  unsigned long iterations = 1024;
+  unsigned long cycles, bestCycles;
+  clock_t elapsed, best;
+  int sample;
+
+  timeSample(function, input, iterations, &elapsed, &cycles);
+  while (elapsed < MIN_SAMPLE_CLOCKS) {
+    iterations *= 2;
+    timeSample(function, input, iterations, &elapsed, &cycles);
+  }
+
+  best = elapsed;
+  bestCycles = cycles;
+  for (sample = 1; sample < SAMPLE_COUNT; sample++) {
+    timeSample(function, input, iterations, &elapsed, &cycles);
+    if (elapsed < best) {
+      best = elapsed;
+      bestCycles = cycles;
+    }
+  }
+
+  result->nsPerOp = (double)best * 1e9 / CLOCKS_PER_SEC / (double)iterations;
+  result->bytesPerCycle =
+      (bestCycles > 0)
+          ? (double)result->bytes * iterations / (double)bestCycles
+          : 0.0;
+}
+
+/* Baseline ns/op of a case, or 0 */
+static double findBaseline(const char *name) {
+  int i;
+
+  for (i = 0; i < baselineCount; i++) {
+    if (strcmp(baselineEntries[i].name, name) == 0) {
+      return baselineEntries[i].ns;
+    }
+  }
+  return 0.0;
+}
+
+
+/* Whether a time is slower than the baseline by more than the threshold */
+static int isRegression(double ns, double baselineNs) {
+  return baselineNs > 0.0 &&
+         (ns - baselineNs) * 100.0 / baselineNs > regressionThreshold;
+}
+
+/* Add one case to the results, timing it again while it looks like a
+   regression and keeping the fastest figure */
+static void runCase(const char *helper, const char *variant,
+                    BenchFunction function, BenchInput *input,
+                    BenchResult *results, int *count) {
+  BenchResult *result;
+  BenchResult retry;
+  BenchResult runs[BASELINE_RUNS];
+  int attempt, i, j;
+
+  if (*count >= MAX_CASES) {
+    return;
+  }
+
+  result = &results[(*count)++];
+  sprintf(result->name, "%s/%s", helper, variant);
+  result->bytes = input->length;
+  result->baselineNs = findBaseline(result->name);
+
+  /* Median of the runs (insertion sort by ns/op) */
+  for (i = 0; i < measureRuns; i++) {
+    runs[i] = *result;
+    measureCase(function, input, &runs[i]);
+    for (j = i; j > 0 && runs[j].nsPerOp < runs[j - 1].nsPerOp; j--) {
+      retry = runs[j];
+      runs[j] = runs[j - 1];
+      runs[j - 1] = retry;
+    }
+  }
+  *result = runs[measureRuns / 2];
+
+  retry = *result;
+  for (attempt = 0; attempt < RETIME_ATTEMPTS &&
+                    isRegression(result->nsPerOp, result->baselineNs);
+       attempt++) {
+    measureCase(function, input, &retry);
+    if (retry.nsPerOp < result->nsPerOp) {
+      *result = retry;
+    }
+  }
+}
+
+/* Run every case */
+static int runBenchmarks(BenchResult *results) {
+  static BenchInput input;
+  static const int sizes[] = {16, 128, 1000};
+  static const char *genres[] = {"Action", "Western", "Documentary"};
+  static const char *genreVariants[] = {"first", "last", "miss"};
+  char variant[16];
+  int count = 0;
+  int s, length;
+
+  for (s = 0; s < 3; s++) {
+    length = sizes[s];
+    sprintf(variant, "%d", length);
+
+    /* Padded field as read from a prompt or CSV cell */
+    repeatText(input.text, sampleText, length);
+    memset(input.text, ' ', 4);
+    memset(input.text + length - 4, ' ', 4);
+    input.length = length;
+    runCase("trimString", variant, benchTrim, &input, results, &count);
+
+    repeatText(input.text, sampleText, length);
+    runCase("toLowerString", variant, benchToLower, &input, results, &count);
+    runCase("containsSubstring", variant, benchContains, &input, results,
+            &count);
+
+    makeQuotedField(input.text, length);
+    runCase("parseCSVField", variant, benchParseField, &input, results,
+            &count);
+
+    repeatText(input.text, sampleNumbers, length);
+    runCase("replaceCommaWithDot", variant, benchReplaceComma, &input,
+            results, &count);
+  }
+
+  for (s = 0; s < 3; s++) {
+    strcpy(input.text, genres[s]);
+    input.length = (int)strlen(genres[s]);
+    runCase("getGenreFromString", genreVariants[s], benchGenre, &input,
+            results, &count);
+  }
+
+  /* CSV numeric cells */
+  strcpy(input.text, "333,13");
+  input.length = 6;
+  runCase("parseDecimalField", "revenue", benchDecimal, &input, results,
+          &count);
+  strcpy(input.text, "2014");
+  input.length = 4;
+  runCase("parseIntegerField", "year", benchInteger, &input, results,
+          &count);
+
+  return count;
+}
+
+/* Read "name": number pairs from a flat JSON object */
+static int loadBaseline(const char *filename) {
+  FILE *file;
+  char name[MAX_CASE_NAME];
+  double value;
+  int c, length;
+
+  file = fopen(filename, "r");
+  if (file == NULL) {
+    printf("Error: Could not open baseline '%s'.\n", filename);
+    return -1;
+  }
+
+  while ((c = fgetc(file)) != EOF) {
+    if (c != '"') {
+      continue;
+    }
+
+    length = 0;
+    while ((c = fgetc(file)) != EOF && c != '"') {
+      if (length < MAX_CASE_NAME - 1) {
+        name[length++] = (char)c;
+      }
+    }
+    name[length] = '\0';
+
+    /* Skip the colon, then read the value */
+    while ((c = fgetc(file)) != EOF && c != ':') {
+    }
+    if (c == EOF || fscanf(file, "%lf", &value) != 1) {
+      break;
+    }
+
+    if (baselineCount < MAX_CASES) {
+      strcpy(baselineEntries[baselineCount].name, name);
+      baselineEntries[baselineCount].ns = value;
+      baselineCount++;
+    }
+  }
+
+  fclose(file);
+  return baselineCount;
+}
+
+/* Write the current figures as a baseline */
+static int writeBaseline(const char *filename, const BenchResult *results,
+                         int count) {
+  FILE *file;
+  int i;
+
+  file = fopen(filename, "w");
+  if (file == NULL) {
+    printf("Error: Could not create baseline '%s'.\n", filename);
+    return 0;
+  }
+
+  fprintf(file, "{\n");
+  for (i = 0; i < count; i++) {
+    fprintf(file, "  \"%s\": %.2f%s\n", results[i].name, results[i].nsPerOp,
+            (i + 1 < count) ? "," : "");
+  }
+  fprintf(file, "}\n");
+
+  fclose(file);
+  return 1;
+}
+
+/* Print the results, returns the number of regressions */
+static int printResults(const BenchResult *results, int count) {
+  double change;
+  int i, regressions = 0;
+
+  printf("%-30s %6s %10s %10s %10s %8s\n", "Case", "Bytes", "ns/op",
+         "B/cycle", "Base ns", "Change");
+  printLine(80);
+
+  for (i = 0; i < count; i++) {
+    printf("%-30s %6d %10.2f ", results[i].name, results[i].bytes,
+           results[i].nsPerOp);
+    if (results[i].bytesPerCycle > 0.0) {
+      printf("%10.3f ", results[i].bytesPerCycle);
+    } else {
+      printf("%10s ", "-");
+    }
+
+    if (results[i].baselineNs > 0.0) {
+      change = (results[i].nsPerOp - results[i].baselineNs) * 100.0 /
+               results[i].baselineNs;
+      printf("%10.2f %+7.1f%%", results[i].baselineNs, change);
+      if (isRegression(results[i].nsPerOp, results[i].baselineNs)) {
+        printf("  REGRESSION");
+        regressions++;
+      }
+    } else {
+      printf("%10s %8s", "-", "-");
+    }
+    printf("\n");
+  }
+
+  return regressions;
+}
+
+int main(int argc, char *argv[]) {
+  static BenchResult results[MAX_CASES];
+  const char *baseline = NULL;
+  const char *output = NULL;
+  int count, regressions, i;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baseline = argv[++i];
+    } else if (strcmp(argv[i], "--write") == 0 && i + 1 < argc) {
+      output = argv[++i];
+      measureRuns = BASELINE_RUNS;
+    } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+      regressionThreshold = atof(argv[++i]);
+    } else {
+      printf("Usage: %s [--baseline FILE] [--write FILE] "
+             "[--threshold PCT]\n",
+             argv[0]);
+      return 2;
+    }
+  }
+
+  if (baseline != NULL && loadBaseline(baseline) < 0) {
+    return 2;
+  }
+
+  count = runBenchmarks(results);
+  regressions = printResults(results, count);
+  printf("(sink %lu)\n", benchSink % 10);
+
+  if (output != NULL) {
+    if (!writeBaseline(output, results, count)) {
+      return 2;
+    }
+    printf("Baseline written to '%s'.\n", output);
+  }
+
+  if (regressions > 0) {
+    printf("%d case(s) regressed by more than %.0f%%.\n", regressions,
+           regressionThreshold);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,372 @@
+#include "bgimport.h"
+#include "compress.h"
+#include "fileio.h"
+#include "movie.h"
+#include "textstore.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+
+#ifdef USE_THREADS
+
+/* One parsed line in the queue */
+typedef struct {
+  Movie movie;
+  char description[MAX_DESCRIPTION_LENGTH];
+  CsvRowStatus status;
+} ImportRow;
+
+/* Process-wide import, at most one at a time. The queue fields and the
+   progress are guarded by importLock; state changes also hold the
+   database lock, so the commit thread can read it under either */
+static struct {
+  int started; /* Threads created and not yet joined */
+  pthread_t reader;
+  pthread_t committer;
+  ImportRow *rows; /* Ring of IMPORT_QUEUE_SIZE rows */
+  int head;        /* Oldest queued row */
+  int queued;
+  int readerDone;
+  LineReader input;
+  MovieDatabase *db;
+  ImportProgress progress;
+  time_t startTime;
+  time_t endTime;
+  int *codes; /* Committed codes, for rollback (database lock) */
+  int codeCount;
+} import;
+
+static pthread_mutex_t importLock = PTHREAD_MUTEX_INITIALIZER;
+/* Signalled when the queue, the state or readerDone changes */
+static pthread_cond_t importChanged = PTHREAD_COND_INITIALIZER;
+
+static pthread_mutex_t databaseLock = PTHREAD_MUTEX_INITIALIZER;
+
+int isBackgroundImportAvailable(void) { return 1; }
+
+void lockDatabase(void) { pthread_mutex_lock(&databaseLock); }
+
+void unlockDatabase(void) { pthread_mutex_unlock(&databaseLock); }
+
+/* Reader thread - parses lines into free queue slots */
+static void *readRows(void *argument) {
+  char line[4096];
+  ImportRow *row;
+  long offset;
+  int running = 1;
+
+  (void)argument;
+
+  while (running && readLine(&import.input, line, sizeof(line)) != NULL) {
+    offset = getLineReaderOffset(&import.input);
+    if (strlen(line) <= 1) {
+      continue;
+    }
+
+    pthread_mutex_lock(&importLock);
+    while (import.queued == IMPORT_QUEUE_SIZE &&
+           import.progress.state == IMPORT_RUNNING) {
+      pthread_cond_wait(&importChanged, &importLock);
+    }
+    running = import.progress.state == IMPORT_RUNNING;
+    row = &import.rows[(import.head + import.queued) % IMPORT_QUEUE_SIZE];
+    pthread_mutex_unlock(&importLock);
+
+    if (running) {
+      /* The slot is not queued yet, so only this thread touches it */
+      row->status = parseMovieCSVLine(line, &row->movie, row->description);
+
+      pthread_mutex_lock(&importLock);
+      import.queued++;
+      import.progress.rowsRead++;
+      import.progress.bytesRead = offset;
+      pthread_cond_broadcast(&importChanged);
+      pthread_mutex_unlock(&importLock);
+    }
+  }
+
+  closeLineReader(&import.input);
+
+  pthread_mutex_lock(&importLock);
+  import.readerDone = 1;
+  pthread_cond_broadcast(&importChanged);
+  pthread_mutex_unlock(&importLock);
+  return NULL;
+}
+
+/* Add queued rows [first, first + count) to the database - called with
+   the database lock held */
+static void commitBatch(int first, int count, long *added, long *duplicates,
+                        long *rejected) {
+  MovieDatabase *db = import.db;
+  ImportRow *row;
+  int i;
+
+  for (i = 0; i < count; i++) {
+    row = &import.rows[(first + i) % IMPORT_QUEUE_SIZE];
+    if (row->status == CSV_ROW_BAD_CODE) {
+      (*rejected)++;
+    } else if (movieCodeExists(db, row->movie.code)) {
+      (*duplicates)++;
+    } else if (row->status != CSV_ROW_OK ||
+               checkMovieData(&row->movie) != NULL ||
+               db->count >= MAX_MOVIES) {
+      (*rejected)++;
+    } else if (addMovie(db, &row->movie, row->description)) {
+      import.codes[import.codeCount++] = row->movie.code;
+      (*added)++;
+    } else {
+      (*rejected)++;
+    }
+  }
+}
+
+/* Commit thread - moves whatever is queued into the database, one batch
+   per lock hold so menu actions are never blocked for long */
+static void *commitRows(void *argument) {
+  long added, duplicates, rejected;
+  int first, count;
+
+  (void)argument;
+
+  for (;;) {
+    pthread_mutex_lock(&importLock);
+    while (import.queued == 0 && !import.readerDone &&
+           import.progress.state == IMPORT_RUNNING) {
+      pthread_cond_wait(&importChanged, &importLock);
+    }
+    if (import.progress.state != IMPORT_RUNNING || import.queued == 0) {
+      pthread_mutex_unlock(&importLock);
+      break;
+    }
+    first = import.head;
+    count = import.queued;
+    pthread_mutex_unlock(&importLock);
+
+    added = duplicates = rejected = 0;
+    lockDatabase();
+    /* A cancel may have happened while waiting for the lock */
+    if (import.progress.state == IMPORT_RUNNING) {
+      commitBatch(first, count, &added, &duplicates, &rejected);
+    }
+    unlockDatabase();
+
+    pthread_mutex_lock(&importLock);
+    import.head = (first + count) % IMPORT_QUEUE_SIZE;
+    import.queued -= count;
+    import.progress.rowsCommitted += added;
+    import.progress.duplicates += duplicates;
+    import.progress.rejected += rejected;
+    pthread_cond_broadcast(&importChanged);
+    pthread_mutex_unlock(&importLock);
+  }
+
+  lockDatabase();
+  pthread_mutex_lock(&importLock);
+  if (import.progress.state == IMPORT_RUNNING) {
+    import.progress.state = IMPORT_FINISHED;
+    import.endTime = time(NULL);
+  }
+  pthread_mutex_unlock(&importLock);
+
+  if (import.progress.state == IMPORT_FINISHED) {
+    retrainTextStore(import.db, import.codeCount);
+  }
+  unlockDatabase();
+
+  return NULL;
+}
+
+/* Start the reader and commit threads on an open input */
+int startBackgroundImport(MovieDatabase *db, const char *filename) {
+  char header[4096];
+  FILE *file;
+
+  if (import.started) {
+    printf("Error: A background import is already running.\n");
+    return 0;
+  }
+
+  if (!openLineReader(&import.input, filename)) {
+    return 0;
+  }
+  if (readLine(&import.input, header, sizeof(header)) == NULL) {
+    printf("Error: File is empty.\n");
+    closeLineReader(&import.input);
+    return 0;
+  }
+
+  import.rows = (ImportRow *)malloc(IMPORT_QUEUE_SIZE * sizeof(ImportRow));
+  import.codes = (int *)malloc(MAX_MOVIES * sizeof(int));
+  if (import.rows == NULL || import.codes == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    free(import.rows);
+    free(import.codes);
+    closeLineReader(&import.input);
+    return 0;
+  }
+
+  memset(&import.progress, 0, sizeof(import.progress));
+  strncpy(import.progress.filename, filename, MAX_STRING_LENGTH - 1);
+  import.progress.filename[MAX_STRING_LENGTH - 1] = '\0';
+  import.progress.state = IMPORT_RUNNING;
+  import.progress.totalBytes = -1;
+  file = fopen(filename, "rb");
+  if (file != NULL) {
+    if (fseek(file, 0L, SEEK_END) == 0) {
+      import.progress.totalBytes = ftell(file);
+    }
+    fclose(file);
+  }
+
+  import.db = db;
+  import.head = 0;
+  import.queued = 0;
+  import.readerDone = 0;
+  import.codeCount = 0;
+  import.startTime = time(NULL);
+
+  if (pthread_create(&import.reader, NULL, readRows, NULL) != 0) {
+    printf("Error: Could not start the import thread.\n");
+    closeLineReader(&import.input);
+    free(import.rows);
+    free(import.codes);
+    import.progress.state = IMPORT_IDLE;
+    return 0;
+  }
+  if (pthread_create(&import.committer, NULL, commitRows, NULL) != 0) {
+    printf("Error: Could not start the import thread.\n");
+    pthread_mutex_lock(&importLock);
+    import.progress.state = IMPORT_CANCELLED;
+    pthread_cond_broadcast(&importChanged);
+    pthread_mutex_unlock(&importLock);
+    pthread_join(import.reader, NULL);
+    free(import.rows);
+    free(import.codes);
+    return 0;
+  }
+
+  import.started = 1;
+  return 1;
+}
+
+/* Copy the progress and estimate the time left from the bytes read */
+void getImportProgress(ImportProgress *progress) {
+  time_t now;
+  double elapsed;
+
+  pthread_mutex_lock(&importLock);
+  *progress = import.progress;
+  now = (progress->state == IMPORT_RUNNING) ? time(NULL) : import.endTime;
+  pthread_mutex_unlock(&importLock);
+
+  if (progress->state == IMPORT_IDLE) {
+    return;
+  }
+
+  elapsed = difftime(now, import.startTime);
+  progress->elapsedSeconds = (long)elapsed;
+  progress->etaSeconds = -1;
+  if (progress->state == IMPORT_RUNNING && elapsed > 0 &&
+      progress->bytesRead > 0 && progress->totalBytes >= progress->bytesRead) {
+    progress->etaSeconds =
+        (long)(elapsed * (progress->totalBytes - progress->bytesRead) /
+               progress->bytesRead);
+  }
+}
+
+int cancelBackgroundImport(MovieDatabase *db, int rollback) {
+  DeletePredicate predicate;
+
+  pthread_mutex_lock(&importLock);
+  if (import.progress.state != IMPORT_RUNNING) {
+    pthread_mutex_unlock(&importLock);
+    return 0;
+  }
+  import.progress.state = rollback ? IMPORT_ROLLED_BACK : IMPORT_CANCELLED;
+  import.endTime = time(NULL);
+  pthread_cond_broadcast(&importChanged);
+  pthread_mutex_unlock(&importLock);
+
+  /* The commit thread needs the database lock we hold, so no batch can
+     land between the state change and the rollback */
+  if (rollback && import.codeCount > 0) {
+    predicate.criterion = DELETE_BY_CODES;
+    predicate.codes = import.codes;
+    predicate.codeCount = import.codeCount;
+    deleteMatchingMovies(db, &predicate);
+
+    pthread_mutex_lock(&importLock);
+    import.progress.rowsCommitted = 0;
+    pthread_mutex_unlock(&importLock);
+    import.codeCount = 0;
+  }
+
+  return 1;
+}
+
+void reapBackgroundImport(void) {
+  ImportState state;
+
+  if (!import.started) {
+    return;
+  }
+
+  pthread_mutex_lock(&importLock);
+  state = import.progress.state;
+  pthread_mutex_unlock(&importLock);
+  if (state == IMPORT_RUNNING) {
+    return;
+  }
+
+  pthread_join(import.reader, NULL);
+  pthread_join(import.committer, NULL);
+  free(import.rows);
+  free(import.codes);
+  import.rows = NULL;
+  import.codes = NULL;
+  import.started = 0;
+}
+
+void stopBackgroundImport(void) {
+  if (!import.started) {
+    return;
+  }
+
+  lockDatabase();
+  cancelBackgroundImport(import.db, 0);
+  unlockDatabase();
+  reapBackgroundImport();
+}
+
+#else /* !USE_THREADS */
+
+int isBackgroundImportAvailable(void) { return 0; }
+
+int startBackgroundImport(MovieDatabase *db, const char *filename) {
+  return importMoviesFromCSV(db, filename) > 0;
+}
+
+void getImportProgress(ImportProgress *progress) {
+  memset(progress, 0, sizeof(*progress));
+  progress->state = IMPORT_IDLE;
+}
+
+int cancelBackgroundImport(MovieDatabase *db, int rollback) {
+  (void)db;
+  (void)rollback;
+  return 0;
+}
+
+void reapBackgroundImport(void) {}
+
+void stopBackgroundImport(void) {}
+
+void lockDatabase(void) {}
+
+void unlockDatabase(void) {}
+
+#endif /* USE_THREADS */
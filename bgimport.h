@@ -0,0 +1,60 @@
+#ifndef BGIMPORT_H
+#define BGIMPORT_H
+
+#include "types.h"
+
+/* Parsed rows waiting for the commit thread */
+#define IMPORT_QUEUE_SIZE 64
+
+/* Lifecycle of a background import */
+typedef enum {
+  IMPORT_IDLE,       /* None started yet */
+  IMPORT_RUNNING,    /* Reading and committing */
+  IMPORT_FINISHED,   /* Reached the end of the file */
+  IMPORT_CANCELLED,  /* Stopped early, committed movies kept */
+  IMPORT_ROLLED_BACK /* Stopped early, committed movies removed again */
+} ImportState;
+
+/* Snapshot of the current (or last) background import */
+typedef struct {
+  ImportState state;
+  char filename[MAX_STRING_LENGTH];
+  long rowsRead;      /* Data lines parsed */
+  long rowsCommitted; /* Movies added to the database */
+  long duplicates;    /* Rows whose code already existed */
+  long rejected;      /* Invalid rows, or rows that did not fit */
+  long bytesRead;     /* Compressed bytes for gzip input */
+  long totalBytes;    /* File size, -1 if unknown */
+  long elapsedSeconds;
+  long etaSeconds; /* -1 until it can be estimated */
+} ImportProgress;
+
+/* Background imports need threads, otherwise imports run in the
+   foreground */
+int isBackgroundImportAvailable(void);
+
+/* Start importing a CSV file (plain or gzip) - a reader thread parses rows
+   into a bounded queue and a commit thread adds them to db in batches
+   under the database lock. Returns 0 if it could not start */
+int startBackgroundImport(MovieDatabase *db, const char *filename);
+
+void getImportProgress(ImportProgress *progress);
+
+/* Stop a running import, keeping or removing (rollback) the movies it
+   already committed. Call with the database lock held. Returns 0 if no
+   import was running */
+int cancelBackgroundImport(MovieDatabase *db, int rollback);
+
+/* Join the threads of an import that has ended - call without the
+   database lock */
+void reapBackgroundImport(void);
+
+/* Cancel (keeping committed movies) and join, e.g. on exit */
+void stopBackgroundImport(void);
+
+/* Serialise database access between menu actions and the commit thread -
+   reads and edits from the menu see only whole committed batches */
+void lockDatabase(void);
+void unlockDatabase(void);
+
+#endif /* BGIMPORT_H */
@@ -0,0 +1,639 @@
+#include "columnar.h"
+#include "fileio.h"
+#include "movie.h"
+#include "outbuf.h"
+#include "textstore.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORD_SIZE ((unsigned long)sizeof(ColumnWord))
+#define HEADER_SIZE (COLUMNAR_MAGIC_LENGTH + 4 * WORD_SIZE)
+#define ENTRY_SIZE (COLUMN_NAME_LENGTH + 4 * WORD_SIZE)
+#define SECTION_ALIGNMENT 8
+
+/* Columns of the movie table */
+typedef enum {
+  MOVIE_COLUMN_CODE,
+  MOVIE_COLUMN_YEAR,
+  MOVIE_COLUMN_DURATION,
+  MOVIE_COLUMN_RATING,
+  MOVIE_COLUMN_FAVORITE,
+  MOVIE_COLUMN_REVENUE,
+  MOVIE_COLUMN_TITLE,
+  MOVIE_COLUMN_DIRECTOR,
+  MOVIE_COLUMN_DESCRIPTION,
+  MOVIE_COLUMN_GENRES,
+  MOVIE_COLUMN_ACTORS,
+  MOVIE_COLUMN_COUNT
+} MovieColumn;
+
+/* Schema entry of a column */
+typedef struct {
+  const char *name;
+  ColumnType type;
+} ColumnSpec;
+
+static const ColumnSpec columnSpecs[MOVIE_COLUMN_COUNT] = {
+    {"code", COLUMN_INT32},         {"year", COLUMN_INT32},
+    {"duration", COLUMN_INT32},     {"rating", COLUMN_FLOAT32},
+    {"favorite", COLUMN_INT32},     {"revenue", COLUMN_FLOAT32},
+    {"title", COLUMN_STRING},       {"director", COLUMN_STRING},
+    {"description", COLUMN_STRING}, {"genres", COLUMN_BYTE_LIST},
+    {"actors", COLUMN_STRING_LIST}};
+
+/* The format stores 32-bit words, ints and floats */
+static int hasColumnarTypes(void) {
+  if (sizeof(ColumnWord) != 4 || sizeof(int) != 4 || sizeof(float) != 4) {
+    printf("Error: Columnar files are not supported on this platform.\n");
+    return 0;
+  }
+  return 1;
+}
+
+/* Bytes needed to reach the next section boundary */
+static unsigned long alignPadding(unsigned long offset) {
+  return (SECTION_ALIGNMENT - offset % SECTION_ALIGNMENT) % SECTION_ALIGNMENT;
+}
+
+/* Width in bytes of one element of a column */
+static ColumnWord elementSize(ColumnType type) {
+  switch (type) {
+  case COLUMN_INT32:
+    return (ColumnWord)sizeof(int);
+  case COLUMN_FLOAT32:
+    return (ColumnWord)sizeof(float);
+  case COLUMN_BYTE_LIST:
+    return 1;
+  default:
+    return (ColumnWord)WORD_SIZE; /* Offset width */
+  }
+}
+
+/* Length of a string column value */
+static unsigned long textLength(const Movie *movie, MovieColumn column) {
+  switch (column) {
+  case MOVIE_COLUMN_TITLE:
+    return (unsigned long)strlen(movie->title);
+  case MOVIE_COLUMN_DIRECTOR:
+    return (unsigned long)strlen(movie->director);
+  default:
+    return (unsigned long)movie->description.rawLength;
+  }
+}
+
+/* String column value (descriptions are decoded into buffer) */
+static const char *columnText(const MovieDatabase *db, const Movie *movie,
+                              MovieColumn column, char *buffer) {
+  switch (column) {
+  case MOVIE_COLUMN_TITLE:
+    return movie->title;
+  case MOVIE_COLUMN_DIRECTOR:
+    return movie->director;
+  default:
+    return loadText(&db->text, &movie->description, buffer);
+  }
+}
+
+/* Size of a column section, excluding alignment padding */
+static unsigned long columnLength(const MovieDatabase *db,
+                                  MovieColumn column) {
+  unsigned long rows = (unsigned long)db->count;
+  unsigned long length = 0, items = 0;
+  int i, j;
+
+  switch (columnSpecs[column].type) {
+  case COLUMN_INT32:
+  case COLUMN_FLOAT32:
+    return rows * 4;
+
+  case COLUMN_STRING:
+    for (i = 0; i < db->count; i++) {
+      length += textLength(&db->movies[i], column);
+    }
+    return (rows + 1) * WORD_SIZE + length;
+
+  case COLUMN_BYTE_LIST:
+    for (i = 0; i < db->count; i++) {
+      length += (unsigned long)db->movies[i].genreCount;
+    }
+    return (rows + 1) * WORD_SIZE + length;
+
+  case COLUMN_STRING_LIST:
+    for (i = 0; i < db->count; i++) {
+      items += (unsigned long)db->movies[i].actorCount;
+      for (j = 0; j < db->movies[i].actorCount; j++) {
+        length += (unsigned long)strlen(db->movies[i].actors[j]);
+      }
+    }
+    return (rows + 1 + items + 1) * WORD_SIZE + length;
+  }
+
+  return 0;
+}
+
+/* Append one word */
+static void outputWord(OutputBuffer *out, unsigned long value) {
+  ColumnWord word = (ColumnWord)value;
+
+  outputChars(out, (const char *)&word, sizeof(word));
+}
+
+/* Append a fixed-width numeric value */
+static void outputNumber(OutputBuffer *out, const Movie *movie,
+                         MovieColumn column) {
+  int value;
+  float decimal;
+
+  switch (column) {
+  case MOVIE_COLUMN_RATING:
+  case MOVIE_COLUMN_REVENUE:
+    decimal = (column == MOVIE_COLUMN_RATING) ? movie->rating : movie->revenue;
+    outputChars(out, (const char *)&decimal, sizeof(decimal));
+    return;
+  case MOVIE_COLUMN_YEAR:
+    value = movie->year;
+    break;
+  case MOVIE_COLUMN_DURATION:
+    value = movie->duration;
+    break;
+  case MOVIE_COLUMN_FAVORITE:
+    value = movie->favorite;
+    break;
+  default:
+    value = movie->code;
+    break;
+  }
+  outputChars(out, (const char *)&value, sizeof(value));
+}
+
+/* Write one column section */
+static void outputColumn(OutputBuffer *out, const MovieDatabase *db,
+                         MovieColumn column) {
+  char description[MAX_DESCRIPTION_LENGTH];
+  const Movie *movie;
+  unsigned long running = 0;
+  int i, j;
+
+  switch (columnSpecs[column].type) {
+  case COLUMN_INT32:
+  case COLUMN_FLOAT32:
+    for (i = 0; i < db->count; i++) {
+      outputNumber(out, &db->movies[i], column);
+    }
+    break;
+
+  case COLUMN_STRING:
+    outputWord(out, 0);
+    for (i = 0; i < db->count; i++) {
+      running += textLength(&db->movies[i], column);
+      outputWord(out, running);
+    }
+    for (i = 0; i < db->count; i++) {
+      movie = &db->movies[i];
+      outputChars(out, columnText(db, movie, column, description),
+                  textLength(movie, column));
+    }
+    break;
+
+  case COLUMN_BYTE_LIST:
+    outputWord(out, 0);
+    for (i = 0; i < db->count; i++) {
+      running += (unsigned long)db->movies[i].genreCount;
+      outputWord(out, running);
+    }
+    for (i = 0; i < db->count; i++) {
+      for (j = 0; j < db->movies[i].genreCount; j++) {
+        outputChar(out, (char)db->movies[i].genres[j]);
+      }
+    }
+    break;
+
+  case COLUMN_STRING_LIST:
+    /* Row starts into the item list, then item offsets, then bytes */
+    outputWord(out, 0);
+    for (i = 0; i < db->count; i++) {
+      running += (unsigned long)db->movies[i].actorCount;
+      outputWord(out, running);
+    }
+    running = 0;
+    outputWord(out, 0);
+    for (i = 0; i < db->count; i++) {
+      for (j = 0; j < db->movies[i].actorCount; j++) {
+        running += (unsigned long)strlen(db->movies[i].actors[j]);
+        outputWord(out, running);
+      }
+    }
+    for (i = 0; i < db->count; i++) {
+      for (j = 0; j < db->movies[i].actorCount; j++) {
+        outputString(out, db->movies[i].actors[j]);
+      }
+    }
+    break;
+  }
+}
+
+/* Export movies to a columnar binary file */
+int exportMoviesToColumnar(const MovieDatabase *db, const char *filename) {
+  char name[COLUMN_NAME_LENGTH];
+  unsigned long lengths[MOVIE_COLUMN_COUNT];
+  unsigned long offset;
+  OutputBuffer out;
+  FILE *file;
+  FILE *testFile;
+  int column, ok;
+
+  if (db == NULL || filename == NULL) {
+    printf("Error: Invalid parameters.\n");
+    return 0;
+  }
+
+  if (db->count == 0) {
+    printf("Error: No movies to export.\n");
+    return 0;
+  }
+
+  if (!hasColumnarTypes()) {
+    return 0;
+  }
+
+  /* Never overwrite an existing file */
+  testFile = fopen(filename, "r");
+  if (testFile != NULL) {
+    fclose(testFile);
+    printf("Error: File '%s' already exists. Export cancelled.\n", filename);
+    return 0;
+  }
+
+  file = fopen(filename, "wb");
+  if (file == NULL) {
+    printf("Error: Could not create file '%s'.\n", filename);
+    return 0;
+  }
+
+  if (!openOutputBuffer(&out, file)) {
+    fclose(file);
+    return 0;
+  }
+
+  printf("Exporting %d movies to '%s'...\n", db->count, filename);
+
+  /* Schema header */
+  outputChars(&out, COLUMNAR_MAGIC, COLUMNAR_MAGIC_LENGTH);
+  outputWord(&out, COLUMNAR_BYTE_ORDER);
+  outputWord(&out, COLUMNAR_VERSION);
+  outputWord(&out, (unsigned long)db->count);
+  outputWord(&out, MOVIE_COLUMN_COUNT);
+
+  offset = HEADER_SIZE + MOVIE_COLUMN_COUNT * ENTRY_SIZE;
+  offset += alignPadding(offset);
+  for (column = 0; column < MOVIE_COLUMN_COUNT; column++) {
+    lengths[column] = columnLength(db, (MovieColumn)column);
+
+    memset(name, 0, sizeof(name));
+    strncpy(name, columnSpecs[column].name, COLUMN_NAME_LENGTH - 1);
+    outputChars(&out, name, COLUMN_NAME_LENGTH);
+    outputWord(&out, (unsigned long)columnSpecs[column].type);
+    outputWord(&out, elementSize(columnSpecs[column].type));
+    outputWord(&out, offset);
+    outputWord(&out, lengths[column]);
+
+    offset += lengths[column];
+    offset += alignPadding(offset);
+  }
+  outputRepeat(&out, '\0',
+               (int)alignPadding(HEADER_SIZE +
+                                 MOVIE_COLUMN_COUNT * ENTRY_SIZE));
+
+  /* Column sections */
+  for (column = 0; column < MOVIE_COLUMN_COUNT; column++) {
+    outputColumn(&out, db, (MovieColumn)column);
+    outputRepeat(&out, '\0', (int)alignPadding(lengths[column]));
+  }
+
+  ok = closeOutputBuffer(&out);
+  if (fclose(file) != 0) {
+    ok = 0;
+  }
+
+  if (!ok) {
+    printf("Error: Could not write file '%s'.\n", filename);
+    return 0;
+  }
+
+  printf("Export complete: %d movies exported to '%s'.\n", db->count, filename);
+  return 1;
+}
+
+/* A column section of a loaded file */
+typedef struct {
+  const unsigned char *data;
+  unsigned long length;
+  ColumnWord type;
+} ColumnView;
+
+/* Read the word at a byte position (sections may be unaligned in memory) */
+static unsigned long readWord(const unsigned char *data, unsigned long index) {
+  ColumnWord word;
+
+  memcpy(&word, data + index * WORD_SIZE, sizeof(word));
+  return word;
+}
+
+/* Check that count + 1 offsets start at 0, never decrease and stay within
+   limit */
+static int checkOffsets(const unsigned char *data, unsigned long count,
+                        unsigned long limit) {
+  unsigned long i, previous = 0, value;
+
+  if (readWord(data, 0) != 0) {
+    return 0;
+  }
+  for (i = 1; i <= count; i++) {
+    value = readWord(data, i);
+    if (value < previous || value > limit) {
+      return 0;
+    }
+    previous = value;
+  }
+  return 1;
+}
+
+/* Check the internal structure of a column section */
+static int checkColumn(const ColumnView *view, ColumnType type,
+                       unsigned long rows) {
+  unsigned long header = (rows + 1) * WORD_SIZE;
+  unsigned long items;
+
+  if (view->type != (ColumnWord)type) {
+    return 0;
+  }
+
+  switch (type) {
+  case COLUMN_INT32:
+  case COLUMN_FLOAT32:
+    return view->length >= rows * 4;
+
+  case COLUMN_STRING:
+  case COLUMN_BYTE_LIST:
+    return view->length >= header &&
+           checkOffsets(view->data, rows, view->length - header);
+
+  case COLUMN_STRING_LIST:
+    if (view->length < header) {
+      return 0;
+    }
+    items = readWord(view->data, rows);
+    if ((view->length - header) / WORD_SIZE < items + 1 ||
+        !checkOffsets(view->data, rows, items)) {
+      return 0;
+    }
+    header += (items + 1) * WORD_SIZE;
+    return checkOffsets(view->data + (rows + 1) * WORD_SIZE, items,
+                        view->length - header);
+  }
+
+  return 0;
+}
+
+/* Copy a length-delimited string, truncated to size - 1 bytes */
+static void copyText(char *dest, int size, const unsigned char *src,
+                     unsigned long length) {
+  if (length > (unsigned long)(size - 1)) {
+    length = (unsigned long)(size - 1);
+  }
+  memcpy(dest, src, length);
+  dest[length] = '\0';
+}
+
+/* Copy string number index of a section holding count offsets before the
+   bytes (data points at the offsets) */
+static void copyItem(char *dest, int size, const unsigned char *data,
+                     unsigned long count, unsigned long index) {
+  unsigned long begin = readWord(data, index);
+  unsigned long end = readWord(data, index + 1);
+
+  copyText(dest, size, data + (count + 1) * WORD_SIZE + begin, end - begin);
+}
+
+/* Fixed-width value of a numeric column */
+static int intAt(const ColumnView *view, int row) {
+  int value;
+
+  memcpy(&value, view->data + (unsigned long)row * sizeof(int), sizeof(int));
+  return value;
+}
+
+static float floatAt(const ColumnView *view, int row) {
+  float value;
+
+  memcpy(&value, view->data + (unsigned long)row * sizeof(float),
+         sizeof(float));
+  return value;
+}
+
+/* Rebuild one movie from the column sections */
+static void readMovieRow(const ColumnView *views, unsigned long rows,
+                         int row, Movie *movie, char *description) {
+  const ColumnView *genres = &views[MOVIE_COLUMN_GENRES];
+  const ColumnView *actors = &views[MOVIE_COLUMN_ACTORS];
+  const unsigned char *items;
+  unsigned long i, begin, end, itemCount;
+  char actor[MAX_ACTOR_NAME_LENGTH];
+
+  memset(movie, 0, sizeof(Movie));
+  for (i = 0; i < MAX_GENRES_PER_MOVIE; i++) {
+    movie->genres[i] = GENRE_NONE;
+  }
+
+  movie->code = intAt(&views[MOVIE_COLUMN_CODE], row);
+  movie->year = intAt(&views[MOVIE_COLUMN_YEAR], row);
+  movie->duration = intAt(&views[MOVIE_COLUMN_DURATION], row);
+  movie->rating = floatAt(&views[MOVIE_COLUMN_RATING], row);
+  movie->favorite = intAt(&views[MOVIE_COLUMN_FAVORITE], row);
+  movie->revenue = floatAt(&views[MOVIE_COLUMN_REVENUE], row);
+
+  copyItem(movie->title, MAX_STRING_LENGTH, views[MOVIE_COLUMN_TITLE].data,
+           rows, (unsigned long)row);
+  copyItem(movie->director, MAX_STRING_LENGTH,
+           views[MOVIE_COLUMN_DIRECTOR].data, rows, (unsigned long)row);
+  copyItem(description, MAX_DESCRIPTION_LENGTH,
+           views[MOVIE_COLUMN_DESCRIPTION].data, rows, (unsigned long)row);
+
+  /* Out-of-range genre numbers are dropped, like unknown genre names */
+  begin = readWord(genres->data, (unsigned long)row);
+  end = readWord(genres->data, (unsigned long)row + 1);
+  for (i = begin; i < end && movie->genreCount < MAX_GENRES_PER_MOVIE; i++) {
+    if (genres->data[(rows + 1) * WORD_SIZE + i] < GENRE_NONE) {
+      movie->genres[movie->genreCount++] =
+          (Genre)genres->data[(rows + 1) * WORD_SIZE + i];
+    }
+  }
+
+  begin = readWord(actors->data, (unsigned long)row);
+  end = readWord(actors->data, (unsigned long)row + 1);
+  itemCount = readWord(actors->data, rows);
+  items = actors->data + (rows + 1) * WORD_SIZE;
+  for (i = begin; i < end && movie->actorCount < MAX_ACTORS_PER_MOVIE; i++) {
+    copyItem(actor, MAX_ACTOR_NAME_LENGTH, items, itemCount, i);
+    if (actor[0] != '\0') {
+      strcpy(movie->actors[movie->actorCount++], actor);
+    }
+  }
+}
+
+/* Locate every column of the schema in the directory */
+static int findColumns(const unsigned char *file, unsigned long fileSize,
+                       ColumnView *views) {
+  const unsigned char *entry;
+  char name[COLUMN_NAME_LENGTH];
+  unsigned long rows, columns, offset, length, i;
+  int column;
+
+  rows = readWord(file + COLUMNAR_MAGIC_LENGTH, 2);
+  columns = readWord(file + COLUMNAR_MAGIC_LENGTH, 3);
+  if (columns > (fileSize - HEADER_SIZE) / ENTRY_SIZE) {
+    return 0;
+  }
+
+  for (column = 0; column < MOVIE_COLUMN_COUNT; column++) {
+    views[column].data = NULL;
+  }
+
+  /* Unknown columns are ignored, so newer writers stay readable */
+  for (i = 0; i < columns; i++) {
+    entry = file + HEADER_SIZE + i * ENTRY_SIZE;
+    memcpy(name, entry, COLUMN_NAME_LENGTH);
+    name[COLUMN_NAME_LENGTH - 1] = '\0';
+    offset = readWord(entry + COLUMN_NAME_LENGTH, 2);
+    length = readWord(entry + COLUMN_NAME_LENGTH, 3);
+    if (offset > fileSize || length > fileSize - offset) {
+      return 0;
+    }
+
+    for (column = 0; column < MOVIE_COLUMN_COUNT; column++) {
+      if (strcmp(name, columnSpecs[column].name) == 0) {
+        views[column].data = file + offset;
+        views[column].length = length;
+        views[column].type = (ColumnWord)readWord(entry + COLUMN_NAME_LENGTH,
+                                                  0);
+      }
+    }
+  }
+
+  for (column = 0; column < MOVIE_COLUMN_COUNT; column++) {
+    if (views[column].data == NULL ||
+        !checkColumn(&views[column], columnSpecs[column].type, rows)) {
+      printf("Error: Column '%s' is missing or damaged.\n",
+             columnSpecs[column].name);
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/* Read a whole file into memory */
+static unsigned char *loadFile(const char *filename, unsigned long *size) {
+  unsigned char *data;
+  FILE *file;
+  long length;
+
+  file = fopen(filename, "rb");
+  if (file == NULL) {
+    printf("Error: Could not open file '%s'.\n", filename);
+    return NULL;
+  }
+
+  if (fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < 0 ||
+      fseek(file, 0, SEEK_SET) != 0) {
+    printf("Error: Could not read file '%s'.\n", filename);
+    fclose(file);
+    return NULL;
+  }
+
+  data = (unsigned char *)malloc((size_t)length + 1);
+  if (data == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    fclose(file);
+    return NULL;
+  }
+
+  if (fread(data, 1, (size_t)length, file) != (size_t)length) {
+    printf("Error: Could not read file '%s'.\n", filename);
+    free(data);
+    fclose(file);
+    return NULL;
+  }
+
+  fclose(file);
+  *size = (unsigned long)length;
+  return data;
+}
+
+/* Import movies from a columnar binary file */
+int importMoviesFromColumnar(MovieDatabase *db, const char *filename) {
+  ColumnView views[MOVIE_COLUMN_COUNT];
+  char description[MAX_DESCRIPTION_LENGTH];
+  unsigned char *data;
+  unsigned long size, rows;
+  Movie movie;
+  int importedCount = 0;
+  int duplicateCount = 0;
+  int row;
+
+  if (db == NULL || filename == NULL) {
+    printf("Error: Invalid parameters.\n");
+    return 0;
+  }
+
+  if (!hasColumnarTypes()) {
+    return 0;
+  }
+
+  data = loadFile(filename, &size);
+  if (data == NULL) {
+    return 0;
+  }
+
+  printf("Importing movies from '%s'...\n", filename);
+
+  if (size < HEADER_SIZE ||
+      memcmp(data, COLUMNAR_MAGIC, COLUMNAR_MAGIC_LENGTH) != 0 ||
+      readWord(data + COLUMNAR_MAGIC_LENGTH, 0) != COLUMNAR_BYTE_ORDER ||
+      readWord(data + COLUMNAR_MAGIC_LENGTH, 1) != COLUMNAR_VERSION) {
+    printf("Error: '%s' is not a columnar file of this platform.\n",
+           filename);
+    free(data);
+    return 0;
+  }
+
+  if (!findColumns(data, size, views)) {
+    free(data);
+    return 0;
+  }
+
+  /* Same duplicate and validation rules as the CSV import */
+  rows = readWord(data + COLUMNAR_MAGIC_LENGTH, 2);
+  for (row = 0; (unsigned long)row < rows; row++) {
+    readMovieRow(views, rows, row, &movie, description);
+
+    if (movieCodeExists(db, movie.code)) {
+      duplicateCount++;
+      continue;
+    }
+
+    if (validateMovieData(&movie)) {
+      if (addMovie(db, &movie, description)) {
+        importedCount++;
+      }
+    } else {
+      printf("Warning: Invalid data in row %d, skipped.\n", row + 1);
+    }
+  }
+
+  free(data);
+
+  finishImport(db, importedCount, duplicateCount);
+  return importedCount;
+}
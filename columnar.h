@@ -0,0 +1,45 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include "types.h"
+
+/* Columnar binary format (.cmcol), in the byte order of the writer:
+
+     magic "CINECOL1", then words byteOrder (0x01020304), formatVersion,
+     rowCount, columnCount
+     columnCount directory entries: name[16], then words type,
+     elementSize, offset, length (offset and length of the section in
+     bytes from the start of the file, sections are 8-byte aligned)
+
+   Sections by type:
+     COLUMN_INT32, COLUMN_FLOAT32  rowCount values
+     COLUMN_STRING                 rowCount + 1 offsets, then the bytes
+                                   (row i spans offsets[i]..offsets[i+1])
+     COLUMN_BYTE_LIST              rowCount + 1 starts, then the items
+     COLUMN_STRING_LIST            rowCount + 1 item starts, itemCount + 1
+                                   offsets, then the bytes
+
+   A consumer can map the file and scan one numeric column directly. */
+
+#define COLUMNAR_MAGIC "CINECOL1"
+#define COLUMNAR_MAGIC_LENGTH 8
+#define COLUMNAR_BYTE_ORDER 0x01020304UL
+#define COLUMNAR_VERSION 1
+#define COLUMN_NAME_LENGTH 16
+
+/* 32-bit word used for counts and offsets (checked at run time) */
+typedef unsigned int ColumnWord;
+
+/* Column encodings */
+typedef enum {
+  COLUMN_INT32 = 1,
+  COLUMN_FLOAT32,
+  COLUMN_STRING,
+  COLUMN_BYTE_LIST, /* Genre numbers */
+  COLUMN_STRING_LIST
+} ColumnType;
+
+int exportMoviesToColumnar(const MovieDatabase *db, const char *filename);
+int importMoviesFromColumnar(MovieDatabase *db, const char *filename);
+
+#endif /* COLUMNAR_H */
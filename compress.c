@@ -0,0 +1,301 @@
+#include "compress.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+
+/* Blocks in flight between the formatting and compressing threads */
+#define COMPRESS_BLOCK_COUNT 2
+
+/* Read one header and decide what the file holds */
+static StreamFormat detectFormat(FILE *file) {
+  unsigned char magic[4];
+  size_t length;
+
+  length = fread(magic, 1, sizeof(magic), file);
+  rewind(file);
+
+  if (length >= 2 && magic[0] == 0x1F && magic[1] == 0x8B) {
+    return STREAM_GZIP;
+  }
+  if (length == 4 && magic[0] == 0x28 && magic[1] == 0xB5 &&
+      magic[2] == 0x2F && magic[3] == 0xFD) {
+    return STREAM_ZSTD;
+  }
+  return STREAM_PLAIN;
+}
+
+/* Open a plain or gzip-compressed file for line reading */
+int openLineReader(LineReader *reader, const char *filename) {
+  reader->file = fopen(filename, "rb");
+  if (reader->file == NULL) {
+    printf("Error: Could not open file '%s'.\n", filename);
+    return 0;
+  }
+
+  reader->format = detectFormat(reader->file);
+  if (reader->format == STREAM_PLAIN) {
+    return 1;
+  }
+
+  fclose(reader->file);
+  reader->file = NULL;
+
+  if (reader->format == STREAM_ZSTD) {
+    printf("Error: '%s' is zstd-compressed, only gzip is supported.\n",
+           filename);
+    return 0;
+  }
+
+#ifdef USE_ZLIB
+  reader->gzip = gzopen(filename, "rb");
+  if (reader->gzip == NULL) {
+    printf("Error: Could not open file '%s'.\n", filename);
+    return 0;
+  }
+  gzbuffer(reader->gzip, COMPRESS_BLOCK_SIZE);
+  return 1;
+#else
+  printf("Error: '%s' is gzip-compressed, rebuild with ZLIB=1 to read it.\n",
+         filename);
+  return 0;
+#endif
+}
+
+/* Read the next line, inflating compressed input on the fly */
+char *readLine(LineReader *reader, char *buffer, int size) {
+#ifdef USE_ZLIB
+  if (reader->format == STREAM_GZIP) {
+    return gzgets(reader->gzip, buffer, size);
+  }
+#endif
+  return fgets(buffer, size, reader->file);
+}
+
+void closeLineReader(LineReader *reader) {
+#ifdef USE_ZLIB
+  if (reader->format == STREAM_GZIP) {
+    gzclose(reader->gzip);
+    return;
+  }
+#endif
+  fclose(reader->file);
+}
+
+long getLineReaderOffset(LineReader *reader) {
+#ifdef USE_ZLIB
+  if (reader->format == STREAM_GZIP) {
+    return (long)gzoffset(reader->gzip);
+  }
+#endif
+  return ftell(reader->file);
+}
+
+#ifdef USE_ZLIB
+
+struct CompressedWriter {
+  FILE *file;
+  z_stream stream;
+  unsigned char output[COMPRESS_BLOCK_SIZE]; /* Deflate output */
+  int failed;
+#ifdef USE_THREADS
+  int threaded; /* Zero if the compressor thread could not start */
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t changed; /* A block was queued, consumed or closing */
+  char blocks[COMPRESS_BLOCK_COUNT][COMPRESS_BLOCK_SIZE];
+  size_t lengths[COMPRESS_BLOCK_COUNT];
+  int head;   /* Next block to compress */
+  int queued; /* Blocks waiting for the compressor */
+  int closing;
+#endif
+};
+
+/* Feed bytes to deflate and write whatever it produces */
+static void deflateBytes(CompressedWriter *writer, const char *data,
+                         size_t length, int flush) {
+  z_stream *stream = &writer->stream;
+  size_t produced;
+  int status;
+
+  stream->next_in = (const Bytef *)data;
+  stream->avail_in = (uInt)length;
+  do {
+    stream->next_out = writer->output;
+    stream->avail_out = sizeof(writer->output);
+    status = deflate(stream, flush);
+    if (status == Z_STREAM_ERROR) {
+      writer->failed = 1;
+      return;
+    }
+
+    produced = sizeof(writer->output) - stream->avail_out;
+    if (produced > 0 && !writer->failed &&
+        fwrite(writer->output, 1, produced, writer->file) != produced) {
+      writer->failed = 1;
+    }
+  } while (stream->avail_out == 0 ||
+           (flush == Z_FINISH && status != Z_STREAM_END));
+}
+
+#ifdef USE_THREADS
+
+/* Compressor thread - deflates queued blocks in order until closed */
+static void *compressBlocks(void *argument) {
+  CompressedWriter *writer = (CompressedWriter *)argument;
+  int block;
+
+  pthread_mutex_lock(&writer->lock);
+  for (;;) {
+    while (writer->queued == 0 && !writer->closing) {
+      pthread_cond_wait(&writer->changed, &writer->lock);
+    }
+    if (writer->queued == 0) {
+      break;
+    }
+
+    block = writer->head;
+    pthread_mutex_unlock(&writer->lock);
+
+    deflateBytes(writer, writer->blocks[block], writer->lengths[block],
+                 Z_NO_FLUSH);
+
+    pthread_mutex_lock(&writer->lock);
+    writer->head = (writer->head + 1) % COMPRESS_BLOCK_COUNT;
+    writer->queued--;
+    pthread_cond_signal(&writer->changed);
+  }
+  pthread_mutex_unlock(&writer->lock);
+
+  return NULL;
+}
+
+/* Hand one block to the compressor, waiting while both blocks are busy */
+static void queueBlock(CompressedWriter *writer, const char *data,
+                       size_t length) {
+  int block;
+
+  pthread_mutex_lock(&writer->lock);
+  while (writer->queued == COMPRESS_BLOCK_COUNT) {
+    pthread_cond_wait(&writer->changed, &writer->lock);
+  }
+  block = (writer->head + writer->queued) % COMPRESS_BLOCK_COUNT;
+  pthread_mutex_unlock(&writer->lock);
+
+  /* Not queued yet, so the compressor does not touch this block */
+  memcpy(writer->blocks[block], data, length);
+  writer->lengths[block] = length;
+
+  pthread_mutex_lock(&writer->lock);
+  writer->queued++;
+  pthread_cond_signal(&writer->changed);
+  pthread_mutex_unlock(&writer->lock);
+}
+
+#endif /* USE_THREADS */
+
+/* Start a gzip stream on file */
+CompressedWriter *openCompressedWriter(FILE *file) {
+  CompressedWriter *writer;
+
+  writer = (CompressedWriter *)malloc(sizeof(CompressedWriter));
+  if (writer == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return NULL;
+  }
+
+  writer->file = file;
+  writer->failed = 0;
+  memset(&writer->stream, 0, sizeof(writer->stream));
+  /* 15-bit window, +16 selects the gzip wrapper */
+  if (deflateInit2(&writer->stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                   15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    printf("Error: Could not start the compressor.\n");
+    free(writer);
+    return NULL;
+  }
+
+#ifdef USE_THREADS
+  writer->head = 0;
+  writer->queued = 0;
+  writer->closing = 0;
+  pthread_mutex_init(&writer->lock, NULL);
+  pthread_cond_init(&writer->changed, NULL);
+  writer->threaded =
+      pthread_create(&writer->thread, NULL, compressBlocks, writer) == 0;
+#endif
+
+  return writer;
+}
+
+/* Compress length bytes (OutputBuffer sink) */
+int writeCompressed(void *context, const char *data, size_t length) {
+  CompressedWriter *writer = (CompressedWriter *)context;
+#ifdef USE_THREADS
+  size_t chunk;
+
+  if (writer->threaded) {
+    while (length > 0) {
+      chunk = length < COMPRESS_BLOCK_SIZE ? length : COMPRESS_BLOCK_SIZE;
+      queueBlock(writer, data, chunk);
+      data += chunk;
+      length -= chunk;
+    }
+    return 1; /* Write errors are reported when closing */
+  }
+#endif
+
+  deflateBytes(writer, data, length, Z_NO_FLUSH);
+  return !writer->failed;
+}
+
+/* Drain the queue, write the gzip trailer and release the writer */
+int closeCompressedWriter(CompressedWriter *writer) {
+  int ok;
+
+#ifdef USE_THREADS
+  if (writer->threaded) {
+    pthread_mutex_lock(&writer->lock);
+    writer->closing = 1;
+    pthread_cond_signal(&writer->changed);
+    pthread_mutex_unlock(&writer->lock);
+    pthread_join(writer->thread, NULL);
+  }
+  pthread_cond_destroy(&writer->changed);
+  pthread_mutex_destroy(&writer->lock);
+#endif
+
+  deflateBytes(writer, NULL, 0, Z_FINISH);
+  deflateEnd(&writer->stream);
+
+  ok = !writer->failed;
+  free(writer);
+  return ok;
+}
+
+#else /* !USE_ZLIB */
+
+struct CompressedWriter {
+  int unused;
+};
+
+CompressedWriter *openCompressedWriter(FILE *file) {
+  (void)file;
+  printf("Error: gzip export is not available, rebuild with ZLIB=1.\n");
+  return NULL;
+}
+
+int writeCompressed(void *context, const char *data, size_t length) {
+  (void)context;
+  (void)data;
+  (void)length;
+  return 0;
+}
+
+int closeCompressedWriter(CompressedWriter *writer) {
+  free(writer);
+  return 0;
+}
+
+#endif /* USE_ZLIB */
@@ -0,0 +1,48 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stddef.h>
+#include <stdio.h>
+#ifdef USE_ZLIB
+#define ZLIB_CONST /* Input pointers are const */
+#include <zlib.h>
+#endif
+
+/* Uncompressed bytes handed to the compressor at a time */
+#define COMPRESS_BLOCK_SIZE 65536
+
+/* Container recognised from the first bytes of a file */
+typedef enum { STREAM_PLAIN, STREAM_GZIP, STREAM_ZSTD } StreamFormat;
+
+/* Line-by-line reader over a plain or gzip-compressed file - compressed
+   input is inflated as it is read, without a temporary file */
+typedef struct {
+  FILE *file; /* Plain input */
+#ifdef USE_ZLIB
+  gzFile gzip; /* Compressed input */
+#endif
+  StreamFormat format;
+} LineReader;
+
+/* Open, detecting the format by magic bytes. Prints the reason and
+   returns 0 for missing files and formats this build cannot read */
+int openLineReader(LineReader *reader, const char *filename);
+/* Same contract as fgets */
+char *readLine(LineReader *reader, char *buffer, int size);
+void closeLineReader(LineReader *reader);
+/* Bytes of the file consumed so far (compressed bytes for gzip input) */
+long getLineReaderOffset(LineReader *reader);
+
+/* gzip writer over an open binary stream. With threads, deflate runs on a
+   separate thread so it overlaps with formatting the next block */
+typedef struct CompressedWriter CompressedWriter;
+
+/* Returns NULL (after printing why) if compression is unavailable */
+CompressedWriter *openCompressedWriter(FILE *file);
+/* Queue bytes for compression - usable as an OutputBuffer sink */
+int writeCompressed(void *writer, const char *data, size_t length);
+/* Finish the stream and free the writer, returns 0 if any write failed.
+   The caller still closes the file */
+int closeCompressedWriter(CompressedWriter *writer);
+
+#endif /* COMPRESS_H */
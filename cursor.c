@@ -0,0 +1,128 @@
+#include "cursor.h"
+#include "index.h"
+#include <limits.h>
+#include <stdlib.h>
+
+/* Open a cursor positioned on the first page */
+void openMovieCursor(MovieCursor *cursor, const MovieDatabase *db,
+                     SortOrder order) {
+  if (cursor == NULL) {
+    return;
+  }
+
+  cursor->db = db;
+  cursor->order = order;
+  cursor->position = 0;
+  cursor->rowCount = 0;
+
+  if (db != NULL) {
+    cursorSeekPosition(cursor, 0);
+  }
+}
+
+/* Materialise the page starting at a given offset in cursor order */
+int cursorSeekPosition(MovieCursor *cursor, int position) {
+  const MovieDatabase *db;
+  const int *byCode;
+  int i, offset;
+
+  if (cursor == NULL || cursor->db == NULL) {
+    return 0;
+  }
+
+  db = cursor->db;
+  byCode = db->indexes.byField[INDEX_CODE];
+
+  if (position > db->count - 1) {
+    position = db->count - 1;
+  }
+  if (position < 0) {
+    position = 0;
+  }
+
+  cursor->position = position;
+  cursor->rowCount = 0;
+
+  for (i = 0; i < LINES_PER_PAGE && position + i < db->count; i++) {
+    offset = position + i;
+    if (cursor->order == SORT_DESCENDING) {
+      offset = db->count - 1 - offset;
+    }
+    cursor->rows[cursor->rowCount++] = byCode[offset];
+  }
+
+  return cursor->rowCount;
+}
+
+/* Jump to a 1-based page number */
+int cursorSeekPage(MovieCursor *cursor, int page) {
+  if (cursor == NULL) {
+    return 0;
+  }
+  return cursorSeekPosition(cursor, (page - 1) * LINES_PER_PAGE);
+}
+
+/* Keyset navigation - start the page at the first movie after code
+   (returns 0 and keeps the current page if no movie follows it) */
+int cursorSeekAfterCode(MovieCursor *cursor, int code) {
+  RangePredicate before;
+  int first, last;
+
+  if (cursor == NULL || cursor->db == NULL) {
+    return 0;
+  }
+
+  /* Number of codes <= code (ascending) or >= code (descending) */
+  if (cursor->order == SORT_ASCENDING) {
+    initRangePredicate(&before, INDEX_CODE, INT_MIN, code);
+  } else {
+    initRangePredicate(&before, INDEX_CODE, code, INT_MAX);
+  }
+  findIndexRange(cursor->db, &before, &first, &last);
+
+  if (last - first >= cursor->db->count) {
+    return 0; /* Nothing after code - stay on the current page */
+  }
+
+  return cursorSeekPosition(cursor, last - first);
+}
+
+/* Advance to the next page */
+int cursorNextPage(MovieCursor *cursor) {
+  if (!cursorHasNextPage(cursor)) {
+    return 0;
+  }
+  return cursorSeekPosition(cursor, cursor->position + LINES_PER_PAGE);
+}
+
+/* Go back to the previous page */
+int cursorPreviousPage(MovieCursor *cursor) {
+  if (cursor == NULL || cursor->position == 0) {
+    return 0;
+  }
+  return cursorSeekPosition(cursor, cursor->position - LINES_PER_PAGE);
+}
+
+/* Page number containing the first row of the current page */
+int cursorCurrentPage(const MovieCursor *cursor) {
+  if (cursor == NULL) {
+    return 0;
+  }
+  return cursor->position / LINES_PER_PAGE + 1;
+}
+
+/* Total number of pages */
+int cursorPageCount(const MovieCursor *cursor) {
+  if (cursor == NULL || cursor->db == NULL) {
+    return 0;
+  }
+  return (cursor->db->count + LINES_PER_PAGE - 1) / LINES_PER_PAGE;
+}
+
+/* Check if rows remain after the current page */
+int cursorHasNextPage(const MovieCursor *cursor) {
+  if (cursor == NULL || cursor->db == NULL) {
+    return 0;
+  }
+  return cursor->position + cursor->rowCount < cursor->db->count;
+}
@@ -0,0 +1,31 @@
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include "types.h"
+
+/* Page-by-page cursor over all movies in code order. Rows come from a
+   walk of the code index, so only the visible page is materialised. */
+typedef struct {
+  const MovieDatabase *db;
+  SortOrder order;
+  int position;              /* Offset of the first row in cursor order */
+  int rows[LINES_PER_PAGE];  /* Movie indices of the current page */
+  int rowCount;              /* Rows on the current page */
+} MovieCursor;
+
+void openMovieCursor(MovieCursor *cursor, const MovieDatabase *db,
+                     SortOrder order);
+
+/* Navigation - each returns the number of rows on the new page */
+int cursorSeekPosition(MovieCursor *cursor, int position);
+int cursorSeekPage(MovieCursor *cursor, int page);
+int cursorSeekAfterCode(MovieCursor *cursor, int code);
+int cursorNextPage(MovieCursor *cursor);
+int cursorPreviousPage(MovieCursor *cursor);
+
+/* Page information (1-based page numbers) */
+int cursorCurrentPage(const MovieCursor *cursor);
+int cursorPageCount(const MovieCursor *cursor);
+int cursorHasNextPage(const MovieCursor *cursor);
+
+#endif /* CURSOR_H */
@@ -1,66 +1,88 @@
 #include "display.h"
 #include "movie.h"
+#include "render.h"
 #include "utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* Size of the stack buffer used to print a single header or row */
+#define LINE_BUFFER_SIZE 1024
+
 /* Print table header for movie list */
 void printTableHeader(void) {
-  printLine(150);
-  printf("%-6s | %-40s | %-25s | %-25s | %-6s | %-4s | %-6s | %-8s | %-8s\n",
-         "Code", "Title", "Genres", "Director", "Year", "Dur", "Rating",
-         "Favorite", "Revenue");
-  printLine(150);
+  char storage[LINE_BUFFER_SIZE];
+  OutputBuffer out;
+
+  attachOutputBuffer(&out, stdout, storage, sizeof(storage));
+  renderTableHeader(&out);
+  flushOutputBuffer(&out);
 }
 
 /* Print a single movie as table row */
 void printMovieRow(const Movie *movie) {
-  char genresStr[MAX_STRING_LENGTH] = "";
-  int i;
+  char storage[LINE_BUFFER_SIZE];
+  OutputBuffer out;
 
   if (movie == NULL) {
     return;
   }
 
-  /* Build genres string */
-  for (i = 0; i < movie->genreCount && i < 3; i++) {
-    if (i > 0) {
-      strcat(genresStr, ", ");
+  attachOutputBuffer(&out, stdout, storage, sizeof(storage));
+  renderMovieRow(&out, movie);
+  flushOutputBuffer(&out);
+}
+
+/* Render rows [first, last) of an index list (or of the database when
+   indices is NULL) */
+static void renderRows(OutputBuffer *out, const MovieDatabase *db,
+                       const int *indices, int first, int last) {
+  int i;
+
+  for (i = first; i < last; i++) {
+    if (indices != NULL) {
+      renderMovieRow(out, &db->movies[indices[i]]);
+    } else {
+      renderMovieRow(out, &db->movies[i]);
     }
-    strncat(genresStr, getGenreName(movie->genres[i]),
-            MAX_STRING_LENGTH - strlen(genresStr) - 1);
-  }
-  if (movie->genreCount > 3) {
-    strcat(genresStr, "...");
   }
+}
 
-  /* Truncate title if too long */
-  if (strlen(movie->title) > 40) {
-    printf(
-        "%-6d | %.37s... | %-25s | %-25s | %-6d | %-4d | %6.1f | %8d | %8.2f\n",
-        movie->code, movie->title, genresStr, movie->director, movie->year,
-        movie->duration, movie->rating, movie->favorite, movie->revenue);
-  } else {
-    printf("%-6d | %-40s | %-25s | %-25s | %-6d | %-4d | %6.1f | %8d | %8.2f\n",
-           movie->code, movie->title, genresStr, movie->director, movie->year,
-           movie->duration, movie->rating, movie->favorite, movie->revenue);
-  }
+/* Render a complete table of movies */
+static void renderTable(OutputBuffer *out, const MovieDatabase *db,
+                        const int *indices, int count) {
+  renderTableHeader(out);
+  renderRows(out, db, indices, 0, count);
+  renderTableLine(out);
+}
+
+/* Render the complete table of a cursor, streaming it page by page */
+static void renderCursorTable(OutputBuffer *out, MovieCursor *cursor) {
+  renderTableHeader(out);
+  cursorSeekPosition(cursor, 0);
+  do {
+    renderRows(out, cursor->db, cursor->rows, 0, cursor->rowCount);
+  } while (cursorNextPage(cursor) > 0);
+  renderTableLine(out);
 }
 
 /* Display movies in table format with optional pagination */
 void displayMoviesTable(const MovieDatabase *db, const int *indices, int count,
                         int usePagination) {
-  int i;
   int page = 0;
   int totalPages;
   char input[10];
+  OutputBuffer out;
 
   if (db == NULL || count == 0) {
     printf("No movies to display.\n");
     return;
   }
 
+  if (!openOutputBuffer(&out, stdout)) {
+    return;
+  }
+
   if (usePagination) {
     totalPages = (count + LINES_PER_PAGE - 1) / LINES_PER_PAGE;
 
@@ -69,20 +91,16 @@ void displayMoviesTable(const MovieDatabase *db, const int *indices, int count,
       printHeader("Movie List");
       printf("Page %d of %d (Total movies: %d)\n\n", page + 1, totalPages,
              count);
-
-      printTableHeader();
+      fflush(stdout);
 
       /* Display movies for current page */
-      for (i = page * LINES_PER_PAGE;
-           i < (page + 1) * LINES_PER_PAGE && i < count; i++) {
-        if (indices != NULL) {
-          printMovieRow(&db->movies[indices[i]]);
-        } else {
-          printMovieRow(&db->movies[i]);
-        }
-      }
-
-      printLine(150);
+      renderTableHeader(&out);
+      renderRows(&out, db, indices, page * LINES_PER_PAGE,
+                 (page + 1) * LINES_PER_PAGE < count
+                     ? (page + 1) * LINES_PER_PAGE
+                     : count);
+      renderTableLine(&out);
+      flushOutputBuffer(&out);
 
       /* Navigation options */
       if ((page + 1) * LINES_PER_PAGE < count) {
@@ -99,6 +117,8 @@ void displayMoviesTable(const MovieDatabase *db, const int *indices, int count,
           } else if (input[0] == 'q') {
             break;
           }
+        } else {
+          break;
         }
       } else if (page > 0) {
         /* Last page but not first page - show previous/quit */
@@ -112,6 +132,8 @@ void displayMoviesTable(const MovieDatabase *db, const int *indices, int count,
           } else {
             break;
           }
+        } else {
+          break;
         }
       } else {
         /* Only one page - exit without pausing (caller handles pause) */
@@ -120,23 +142,189 @@ void displayMoviesTable(const MovieDatabase *db, const int *indices, int count,
     }
   } else {
     /* No pagination - display all */
-    printTableHeader();
-    for (i = 0; i < count; i++) {
-      if (indices != NULL) {
-        printMovieRow(&db->movies[indices[i]]);
-      } else {
-        printMovieRow(&db->movies[i]);
+    fflush(stdout);
+    renderTable(&out, db, indices, count);
+  }
+
+  closeOutputBuffer(&out);
+}
+
+/* Open a listing destination - "-" is standard output, existing files are
+   never overwritten (same rule as CSV export) */
+static FILE *openListingFile(const char *filename) {
+  FILE *file;
+
+  if (strcmp(filename, "-") == 0) {
+    fflush(stdout);
+    return stdout;
+  }
+
+  file = fopen(filename, "r");
+  if (file != NULL) {
+    fclose(file);
+    printf("Error: File '%s' already exists.\n", filename);
+    return NULL;
+  }
+
+  file = fopen(filename, "w");
+  if (file == NULL) {
+    printf("Error: Could not create file '%s'.\n", filename);
+  }
+  return file;
+}
+
+/* Finish a listing, reporting the outcome */
+static int closeListingFile(OutputBuffer *out, FILE *file,
+                            const char *filename, int count) {
+  int ok = closeOutputBuffer(out);
+
+  if (file != stdout && fclose(file) != 0) {
+    ok = 0;
+  }
+
+  if (!ok) {
+    printf("Error: Could not write listing to '%s'.\n", filename);
+  } else if (file != stdout) {
+    printf("%d movie(s) written to '%s'.\n", count, filename);
+  }
+  return ok;
+}
+
+/* Write movies as a plain table (no screen control codes or pagination) */
+int saveMoviesTable(const MovieDatabase *db, const int *indices, int count,
+                    const char *filename) {
+  OutputBuffer out;
+  FILE *file;
+
+  if (db == NULL || filename == NULL) {
+    return 0;
+  }
+
+  file = openListingFile(filename);
+  if (file == NULL) {
+    return 0;
+  }
+
+  if (!openOutputBuffer(&out, file)) {
+    if (file != stdout) {
+      fclose(file);
+    }
+    return 0;
+  }
+
+  renderTable(&out, db, indices, count);
+  return closeListingFile(&out, file, filename, count);
+}
+
+/* Write all movies of a cursor as a plain table */
+int saveCursorTable(MovieCursor *cursor, const char *filename) {
+  OutputBuffer out;
+  FILE *file;
+
+  if (cursor == NULL || cursor->db == NULL || filename == NULL) {
+    return 0;
+  }
+
+  file = openListingFile(filename);
+  if (file == NULL) {
+    return 0;
+  }
+
+  if (!openOutputBuffer(&out, file)) {
+    if (file != stdout) {
+      fclose(file);
+    }
+    return 0;
+  }
+
+  renderCursorTable(&out, cursor);
+  return closeListingFile(&out, file, filename, cursor->db->count);
+}
+
+/* Display movies from a cursor - only one page of rows is materialised at
+   a time, so the first page shows without ordering the whole database */
+void displayMoviesCursor(MovieCursor *cursor, int usePagination) {
+  char input[10];
+  int value;
+  OutputBuffer out;
+
+  if (cursor == NULL || cursor->db == NULL || cursor->db->count == 0) {
+    printf("No movies to display.\n");
+    return;
+  }
+
+  if (!openOutputBuffer(&out, stdout)) {
+    return;
+  }
+
+  if (!usePagination) {
+    /* No pagination - stream every page */
+    fflush(stdout);
+    renderCursorTable(&out, cursor);
+    closeOutputBuffer(&out);
+    return;
+  }
+
+  while (1) {
+    clearScreen();
+    printHeader("Movie List");
+    printf("Page %d of %d (Total movies: %d)\n\n", cursorCurrentPage(cursor),
+           cursorPageCount(cursor), cursor->db->count);
+    fflush(stdout);
+
+    renderTableHeader(&out);
+    renderRows(&out, cursor->db, cursor->rows, 0, cursor->rowCount);
+    renderTableLine(&out);
+    flushOutputBuffer(&out);
+
+    if (cursorPageCount(cursor) <= 1) {
+      /* Only one page - exit without pausing (caller handles pause) */
+      break;
+    }
+
+    /* Navigation options */
+    printf("\n");
+    if (cursorHasNextPage(cursor)) {
+      printf("[N]ext page | ");
+    }
+    if (cursor->position > 0) {
+      printf("[P]revious page | ");
+    }
+    printf("[G]o to page | [A]fter code | [Q]uit: ");
+
+    if (fgets(input, sizeof(input), stdin) == NULL) {
+      break;
+    }
+    toLowerString(input, input);
+    trimString(input);
+
+    if (input[0] == 'n') {
+      cursorNextPage(cursor);
+    } else if (input[0] == 'p') {
+      cursorPreviousPage(cursor);
+    } else if (input[0] == 'g') {
+      value = readInteger("Page number: ", 1, cursorPageCount(cursor));
+      cursorSeekPage(cursor, value);
+    } else if (input[0] == 'a') {
+      value = readInteger("Show movies after code: ", 0, 999999);
+      if (cursorSeekAfterCode(cursor, value) == 0) {
+        printf("No movies after code %d.\n", value);
+        pauseScreen();
       }
+    } else if (input[0] == 'q') {
+      break;
     }
-    printLine(150);
   }
+
+  closeOutputBuffer(&out);
 }
 
 /* Display detailed information about a single movie */
-void displayMovieDetails(const Movie *movie) {
+void displayMovieDetails(const MovieDatabase *db, const Movie *movie) {
+  char description[MAX_DESCRIPTION_LENGTH];
   int i;
 
-  if (movie == NULL) {
+  if (db == NULL || movie == NULL) {
     printf("Error: Invalid movie.\n");
     return;
   }
@@ -155,7 +343,8 @@ void displayMovieDetails(const Movie *movie) {
   }
   printf("\n");
 
-  printf("Description: %s\n", movie->description);
+  printf("Description: %s\n",
+         loadText(&db->text, &movie->description, description));
   printf("Director:    %s\n", movie->director);
 
   printf("Actors:      ");
@@ -176,11 +365,144 @@ void displayMovieDetails(const Movie *movie) {
   printLine(80);
 }
 
+/* Display "more like this" recommendations, best first */
+void displaySimilarMovies(const MovieDatabase *db,
+                          const SimilarMovie *results, int count) {
+  const Movie *movie;
+  int i;
+
+  printHeader("More Like This");
+
+  if (count == 0) {
+    printf("No similar movies found.\n");
+    return;
+  }
+
+  printf("%-5s | %-6s | %-32s | %-4s | %-20s\n", "Score", "Code", "Title",
+         "Year", "Director");
+  printLine(80);
+  for (i = 0; i < count; i++) {
+    movie = &db->movies[results[i].position];
+    printf("%5.2f | %6d | %-32.32s | %4d | %-20.20s\n", results[i].score,
+           movie->code, movie->title, movie->year, movie->director);
+  }
+  printLine(80);
+}
+
+/* Display a chain of co-stars and the movies linking them */
+void displayActorPath(const MovieDatabase *db, const ActorGraph *graph,
+                      const int *actors, const int *movies, int count) {
+  const Movie *movie;
+  int i;
+
+  printHeader("Actor Connections");
+
+  printf("%s\n", getNameById(&graph->actors, actors[0]));
+  for (i = 1; i < count; i++) {
+    movie = &db->movies[movies[i - 1]];
+    printf("  -> %s (%d) with\n", movie->title, movie->year);
+    printf("%s\n", getNameById(&graph->actors, actors[i]));
+  }
+
+  printLine(80);
+  printf("Degrees of separation: %d\n", count - 1);
+}
+
+/* Lower-case name of an import state */
+static const char *importStateName(ImportState state) {
+  switch (state) {
+  case IMPORT_RUNNING:
+    return "running";
+  case IMPORT_FINISHED:
+    return "finished";
+  case IMPORT_CANCELLED:
+    return "cancelled";
+  case IMPORT_ROLLED_BACK:
+    return "rolled back";
+  default:
+    return "idle";
+  }
+}
+
+/* Display the progress of the current or last background import */
+void displayImportProgress(const ImportProgress *progress) {
+  printHeader("Background Import");
+
+  if (progress->state == IMPORT_IDLE) {
+    printf("No background import has been started.\n");
+    return;
+  }
+
+  printf("File:            %s\n", progress->filename);
+  printf("State:           %s\n", importStateName(progress->state));
+  printf("Rows read:       %ld\n", progress->rowsRead);
+  printf("Movies added:    %ld\n", progress->rowsCommitted);
+  printf("Duplicates:      %ld\n", progress->duplicates);
+  printf("Rejected:        %ld\n", progress->rejected);
+  if (progress->totalBytes > 0) {
+    printf("Bytes read:      %ld of %ld (%.1f%%)\n", progress->bytesRead,
+           progress->totalBytes,
+           100.0 * progress->bytesRead / progress->totalBytes);
+  } else {
+    printf("Bytes read:      %ld\n", progress->bytesRead);
+  }
+  printf("Elapsed:         %lds\n", progress->elapsedSeconds);
+  if (progress->etaSeconds >= 0) {
+    printf("Time left:       about %lds\n", progress->etaSeconds);
+  }
+}
+
+/* Display a one-line import summary above the main menu */
+void displayImportStatusLine(const ImportProgress *progress) {
+  if (progress->state == IMPORT_IDLE) {
+    return;
+  }
+
+  printf("Background import of %s %s: %ld movies added", progress->filename,
+         importStateName(progress->state), progress->rowsCommitted);
+  if (progress->state == IMPORT_RUNNING && progress->totalBytes > 0) {
+    printf(", %.0f%% read", 100.0 * progress->bytesRead / progress->totalBytes);
+  }
+  printf("\n");
+}
+
+/* Display the watched file and the changes applied from it */
+void displayWatchStatus(const WatchStatus *status) {
+  printHeader("Watched File");
+
+  if (!status->active) {
+    printf("No file is being watched.\n");
+    return;
+  }
+
+  printf("File:            %s\n", status->filename);
+  printf("Notified by:     %s\n",
+         status->usingInotify ? "inotify" : "polling");
+  printf("Append scans:    %ld\n", status->appendScans);
+  printf("Full scans:      %ld\n", status->fullScans);
+  printf("Movies added:    %ld\n", status->added);
+  printf("Movies changed:  %ld\n", status->changed);
+  printf("Movies removed:  %ld\n", status->removed);
+  printf("Rejected rows:   %ld\n", status->rejected);
+}
+
+/* Display a one-line watch summary above the main menu */
+void displayWatchStatusLine(const WatchStatus *status) {
+  if (!status->active) {
+    return;
+  }
+
+  printf("Watching %s: %ld added, %ld changed, %ld removed\n",
+         status->filename, status->added, status->changed, status->removed);
+}
+
 /* List all movies with sorting and pagination options */
 void listAllMovies(MovieDatabase *db) {
   int sortChoice;
   int paginationChoice;
   SortOrder order;
+  MovieCursor cursor;
+  char filename[MAX_STRING_LENGTH];
 
   if (db == NULL || db->count == 0) {
     printf("No movies in database.\n");
@@ -197,34 +519,42 @@ void listAllMovies(MovieDatabase *db) {
   sortChoice = readInteger("Choice: ", 1, 2);
 
   order = (sortChoice == 1) ? SORT_ASCENDING : SORT_DESCENDING;
-  sortMoviesByCode(db, order);
 
   /* Ask for pagination */
   printf("\nUse pagination (%d lines per page)?\n", LINES_PER_PAGE);
   printf("1. Yes\n");
   printf("2. No\n");
-  paginationChoice = readInteger("Choice: ", 1, 2);
+  printf("3. No - write to a file instead of the screen\n");
+  paginationChoice = readInteger("Choice: ", 1, 3);
 
   printf("\n");
-  displayMoviesTable(db, NULL, db->count, paginationChoice == 1);
+  openMovieCursor(&cursor, db, order);
+
+  if (paginationChoice == 3) {
+    readString("Enter filename (- for standard output): ", filename,
+               MAX_STRING_LENGTH);
+    if (strlen(filename) == 0) {
+      printf("Filename cannot be empty.\n");
+      return;
+    }
+    saveCursorTable(&cursor, filename);
+    return;
+  }
+
+  displayMoviesCursor(&cursor, paginationChoice == 1);
 }
 
-/* Display search results sorted by title */
-void displaySearchResults(const MovieDatabase *db, const int *indices,
-                          int count) {
+/* Copy search results and sort the copy by title (caller frees) */
+static int *sortResultsByTitle(const MovieDatabase *db, const int *indices,
+                               int count) {
   int *sortedIndices;
   int i;
 
-  if (db == NULL || indices == NULL || count == 0) {
-    printf("No movies found.\n");
-    return;
-  }
-
   /* Create a copy of indices array for sorting */
   sortedIndices = (int *)malloc(count * sizeof(int));
   if (sortedIndices == NULL) {
     printf("Error: Memory allocation failed.\n");
-    return;
+    return NULL;
   }
 
   for (i = 0; i < count; i++) {
@@ -233,6 +563,44 @@ void displaySearchResults(const MovieDatabase *db, const int *indices,
 
   /* Sort by title */
   sortMoviesByTitle(sortedIndices, count, db);
+  return sortedIndices;
+}
+
+/* Write search results sorted by title as a plain table */
+int saveSearchResults(const MovieDatabase *db, const int *indices, int count,
+                      const char *filename) {
+  int *sortedIndices;
+  int ok;
+
+  if (db == NULL || indices == NULL || count == 0) {
+    printf("No movies found.\n");
+    return 0;
+  }
+
+  sortedIndices = sortResultsByTitle(db, indices, count);
+  if (sortedIndices == NULL) {
+    return 0;
+  }
+
+  ok = saveMoviesTable(db, sortedIndices, count, filename);
+  free(sortedIndices);
+  return ok;
+}
+
+/* Display search results sorted by title */
+void displaySearchResults(const MovieDatabase *db, const int *indices,
+                          int count) {
+  int *sortedIndices;
+
+  if (db == NULL || indices == NULL || count == 0) {
+    printf("No movies found.\n");
+    return;
+  }
+
+  sortedIndices = sortResultsByTitle(db, indices, count);
+  if (sortedIndices == NULL) {
+    return;
+  }
 
   printHeader("Search Results");
   printf("Found %d movie(s)\n\n", count);
@@ -242,3 +610,121 @@ void displaySearchResults(const MovieDatabase *db, const int *indices,
 
   free(sortedIndices);
 }
+
+/* Display a grouped analytics report in table format */
+void displayAnalyticsReport(const AnalyticsReport *report) {
+  char label[MAX_STRING_LENGTH];
+  const GroupStats *group;
+  int i;
+
+  if (report == NULL || report->groupCount == 0) {
+    printf("No data to report.\n");
+    return;
+  }
+
+  printLine(110);
+  printf("%-30s | %-6s | %-10s | %-14s | %-12s | %-14s | %-8s\n",
+         getGroupByName(report->groupBy), "Movies", "Avg Rating",
+         "Total Revenue", "Avg Revenue", "Favorites", "Avg Dur");
+  printLine(110);
+
+  for (i = 0; i < report->groupCount; i++) {
+    group = &report->groups[i];
+    getGroupLabel(report, group, label, 31);
+    printf("%-30s | %6d | %10.2f | %14.2f | %12.2f | %14.0f | %8.1f\n",
+           label, group->movieCount, group->ratingSum / group->movieCount,
+           group->revenueSum, group->revenueSum / group->movieCount,
+           group->favoriteSum, group->durationSum / group->movieCount);
+  }
+
+  printLine(110);
+  printf("%d group(s)\n", report->groupCount);
+}
+
+/* Display size and decode speed of the description store */
+void displayTextStoreStats(const MovieDatabase *db,
+                           const TextStoreStats *stats) {
+  if (db == NULL || stats == NULL) {
+    return;
+  }
+
+  printf("Storage mode:       %s\n", getTextStoreModeName(db->text.mode));
+  printf("Descriptions:       %d\n", stats->textCount);
+  printf("Raw text:           %ld bytes\n", stats->rawBytes);
+  printf("Stored text:        %ld bytes\n", stats->storedBytes);
+  printf("Dictionary:         %ld bytes (%d entries)\n",
+         stats->dictionaryBytes, db->text.entryCount);
+  printf("Arena allocated:    %ld bytes (%ld bytes of deleted text)\n",
+         stats->arenaBytes, db->text.deadBytes);
+  printf("Side file:          %ld bytes\n", stats->diskBytes);
+  printf("Compression ratio:  %.2f:1\n", stats->ratio);
+  printf("Inline equivalent:  %ld bytes (%d per movie)\n",
+         (long)db->count * MAX_DESCRIPTION_LENGTH, MAX_DESCRIPTION_LENGTH);
+  printf("Decode latency:     %.3f us per description (%.1f MB/s)\n",
+         stats->decodeMicros, stats->decodeMegabytes);
+}
+
+/* Print a byte count as kilobytes */
+static void printKilobytes(long bytes) { printf("%10.1f KB", bytes / 1024.0); }
+
+/* Display the memory breakdown, Movie layout first */
+void displayMemoryReport(const MemoryReport *report, int movieCount) {
+  const MemoryComponent *component;
+  const FieldLayout *field;
+  int i;
+
+  if (report == NULL) {
+    return;
+  }
+
+  printf("Movie layout (%ld bytes, %ld bytes of padding):\n",
+         report->movieSize, report->paddingBytes);
+  printLine(50);
+  printf("%-14s | %8s | %8s | %8s\n", "Field", "Offset", "Size", "Padding");
+  printLine(50);
+  for (i = 0; i < MOVIE_FIELD_COUNT; i++) {
+    field = &report->fields[i];
+    printf("%-14s | %8ld | %8ld | %8ld\n", field->name, field->offset,
+           field->size, field->padding);
+  }
+  printLine(50);
+
+  printf("\nMemory by component (%d movies, %d slots):\n", movieCount,
+         MAX_MOVIES);
+  printLine(75);
+  printf("%-20s | %13s | %13s | %13s | %5s\n", "Component", "Allocated",
+         "Used", "Slack", "Used%");
+  printLine(75);
+  for (i = 0; i < report->componentCount; i++) {
+    component = &report->components[i];
+    printf("%-20s | ", component->name);
+    printKilobytes(component->allocated);
+    printf(" | ");
+    printKilobytes(component->used);
+    printf(" | ");
+    printKilobytes(component->allocated - component->used);
+    printf(" | %5.1f\n",
+           (component->allocated > 0)
+               ? component->used * 100.0 / component->allocated
+               : 0.0);
+  }
+  printLine(75);
+  printf("%-20s | ", "Total");
+  printKilobytes(report->allocatedBytes);
+  printf(" | ");
+  printKilobytes(report->usedBytes);
+  printf(" | ");
+  printKilobytes(report->allocatedBytes - report->usedBytes);
+  printf(" | %5.1f\n", (report->allocatedBytes > 0)
+                           ? report->usedBytes * 100.0 / report->allocatedBytes
+                           : 0.0);
+  printLine(75);
+
+  printf("\nDatabase struct:    %ld bytes\n", report->databaseBytes);
+  if (report->currentRssKb >= 0) {
+    printf("Resident memory:    %ld KB (peak %ld KB)\n", report->currentRssKb,
+           report->peakRssKb);
+  } else {
+    printf("Resident memory:    unavailable on this platform\n");
+  }
+}
@@ -1,15 +1,42 @@
 #ifndef DISPLAY_H
 #define DISPLAY_H
 
+#include "actorgraph.h"
+#include "analytics.h"
+#include "bgimport.h"
+#include "cursor.h"
+#include "memreport.h"
+#include "similar.h"
+#include "textstore.h"
 #include "types.h"
+#include "watch.h"
 
 /* Display a single movie with all details (including description) */
-void displayMovieDetails(const Movie *movie);
+void displayMovieDetails(const MovieDatabase *db, const Movie *movie);
+
+/* Display similar movies found by findSimilarMovies */
+void displaySimilarMovies(const MovieDatabase *db,
+                          const SimilarMovie *results, int count);
+
+/* Display a path found by findActorPath */
+void displayActorPath(const MovieDatabase *db, const ActorGraph *graph,
+                      const int *actors, const int *movies, int count);
+
+/* Display a background import in full, or as one status line */
+void displayImportProgress(const ImportProgress *progress);
+void displayImportStatusLine(const ImportProgress *progress);
+
+/* Display the watched file in full, or as one status line */
+void displayWatchStatus(const WatchStatus *status);
+void displayWatchStatusLine(const WatchStatus *status);
 
 /* Display movies in table format (without description) */
 void displayMoviesTable(const MovieDatabase *db, const int *indices, int count,
                         int usePagination);
 
+/* Display movies page by page from a cursor (optionally paginated) */
+void displayMoviesCursor(MovieCursor *cursor, int usePagination);
+
 /* Display all movies in table format with sorting options */
 void listAllMovies(MovieDatabase *db);
 
@@ -17,10 +44,28 @@ void listAllMovies(MovieDatabase *db);
 void displaySearchResults(const MovieDatabase *db, const int *indices,
                           int count);
 
+/* Write tables to a file, or to standard output when filename is "-",
+   without screen control codes or pagination */
+int saveMoviesTable(const MovieDatabase *db, const int *indices, int count,
+                    const char *filename);
+int saveCursorTable(MovieCursor *cursor, const char *filename);
+int saveSearchResults(const MovieDatabase *db, const int *indices, int count,
+                      const char *filename);
+
 /* Helper function to format and print table row */
 void printMovieRow(const Movie *movie);
 
 /* Print table header */
 void printTableHeader(void);
 
+/* Display a grouped analytics report in table format */
+void displayAnalyticsReport(const AnalyticsReport *report);
+
+/* Display size and decode speed of the description store */
+void displayTextStoreStats(const MovieDatabase *db,
+                           const TextStoreStats *stats);
+
+/* Display the memory breakdown and Movie field layout */
+void displayMemoryReport(const MemoryReport *report, int movieCount);
+
 #endif /* DISPLAY_H */
@@ -1,6 +1,12 @@
 #include "fileio.h"
+#include "compress.h"
+#include "index.h"
 #include "movie.h"
+#include "outbuf.h"
+#include "textstore.h"
 #include "utils.h"
+#include <float.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,6 +39,111 @@ void replaceDotWithComma(char *str) {
   }
 }
 
+/* Powers of ten that are exact in a double */
+static const double exactPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                          1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15};
+#define MAX_DECIMAL_DIGITS 15
+
+/* mantissa * 10^exponent, exact while both fit the table */
+static double scaleByPowerOfTen(double mantissa, int exponent) {
+  while (exponent > MAX_DECIMAL_DIGITS) {
+    mantissa *= exactPowersOfTen[MAX_DECIMAL_DIGITS];
+    exponent -= MAX_DECIMAL_DIGITS;
+  }
+  while (exponent < -MAX_DECIMAL_DIGITS) {
+    mantissa /= exactPowersOfTen[MAX_DECIMAL_DIGITS];
+    exponent += MAX_DECIMAL_DIGITS;
+  }
+  return (exponent >= 0) ? mantissa * exactPowersOfTen[exponent]
+                         : mantissa / exactPowersOfTen[-exponent];
+}
+
+/* Parse a whole field as an integer in [minimum, maximum] without strtol,
+   returns 1 on success */
+int parseIntegerField(const char *text, long minimum, long maximum,
+                      long *value) {
+  unsigned long magnitude = 0, limit;
+  int negative = 0, digit;
+  const char *p = text;
+
+  if (*p == '-' || *p == '+') {
+    negative = (*p++ == '-');
+  }
+  if (*p < '0' || *p > '9') {
+    return 0;
+  }
+
+  limit = negative ? (unsigned long)LONG_MAX + 1UL : (unsigned long)LONG_MAX;
+  for (; *p >= '0' && *p <= '9'; p++) {
+    digit = *p - '0';
+    if (magnitude > (limit - (unsigned long)digit) / 10UL) {
+      return 0; /* Overflow */
+    }
+    magnitude = magnitude * 10UL + (unsigned long)digit;
+  }
+  if (*p != '\0') {
+    return 0;
+  }
+
+  if (!negative) {
+    *value = (long)magnitude;
+  } else if (magnitude > (unsigned long)LONG_MAX) {
+    *value = LONG_MIN;
+  } else {
+    *value = -(long)magnitude;
+  }
+  return *value >= minimum && *value <= maximum;
+}
+
+/* Parse a whole field as a decimal in [minimum, maximum], with a comma or a
+   dot as separator regardless of the locale, returns 1 on success. Up to 15
+   significant digits and a scale of 15 the result is a single exact
+   division, rounded the same way strtod does; further digits are rounded
+   into the first 15. */
+int parseDecimalField(const char *text, double minimum, double maximum,
+                      double *value) {
+  double mantissa = 0.0;
+  int negative = 0, sawDigit = 0, digits = 0, scale = 0, separator = 0;
+  int dropped = 0, roundUp = 0;
+  const char *p = text;
+
+  if (*p == '-' || *p == '+') {
+    negative = (*p++ == '-');
+  }
+
+  for (;; p++) {
+    if (*p >= '0' && *p <= '9') {
+      if (digits > 0 || *p != '0') {
+        digits++;
+      }
+      if (digits <= MAX_DECIMAL_DIGITS) {
+        mantissa = mantissa * 10.0 + (*p - '0');
+        scale += separator;
+      } else {
+        /* Past the exact range - integer digits still count */
+        roundUp |= (digits == MAX_DECIMAL_DIGITS + 1 && *p >= '5');
+        dropped += !separator;
+      }
+      sawDigit = 1;
+    } else if ((*p == ',' || *p == '.') && !separator) {
+      separator = 1;
+    } else {
+      break;
+    }
+  }
+  /* At least one digit and nothing after the number */
+  if (!sawDigit || *p != '\0') {
+    return 0;
+  }
+
+  *value = scaleByPowerOfTen(mantissa + roundUp, dropped - scale);
+  if (negative) {
+    *value = -*value;
+  }
+  return *value >= minimum && *value <= maximum;
+}
+
 /* Parse a single CSV field, handling quotes and semicolon delimiters */
 char *parseCSVField(char **linePtr, char *buffer, int bufferSize) {
   char *line = *linePtr;
@@ -91,45 +202,170 @@ char *parseCSVField(char **linePtr, char *buffer, int bufferSize) {
   return buffer;
 }
 
+/* Next non-empty item of a comma-separated list (a reentrant
+   strtok(..., ","), so import threads can share the row parser) */
+static char *nextListItem(char **cursor) {
+  char *item = *cursor;
+
+  while (*item == ',') {
+    item++;
+  }
+  if (*item == '\0') {
+    *cursor = item;
+    return NULL;
+  }
+
+  *cursor = item;
+  while (**cursor != '\0' && **cursor != ',') {
+    (*cursor)++;
+  }
+  if (**cursor == ',') {
+    **cursor = '\0';
+    (*cursor)++;
+  }
+  return item;
+}
+
+/* Parse one CSV data line into movie and description (line is modified).
+   Does not touch the database or print, so it is safe on any thread */
+CsvRowStatus parseMovieCSVLine(char *line, Movie *movie, char *description) {
+  char field[MAX_DESCRIPTION_LENGTH];
+  char genreBuffer[MAX_STRING_LENGTH];
+  char actorBuffer[MAX_DESCRIPTION_LENGTH];
+  char *linePtr = line;
+  char *cursor;
+  char *token;
+  Genre genre;
+  long number = 0;
+  double decimal = 0.0;
+  int numbersValid;
+  int i;
+
+  /* Initialise movie structure */
+  movie->genreCount = 0;
+  movie->actorCount = 0;
+  for (i = 0; i < MAX_GENRES_PER_MOVIE; i++) {
+    movie->genres[i] = GENRE_NONE;
+  }
+  for (i = 0; i < MAX_ACTORS_PER_MOVIE; i++) {
+    movie->actors[i][0] = '\0';
+  }
+
+  /* Parse code */
+  parseCSVField(&linePtr, field, sizeof(field));
+  if (!parseIntegerField(field, 1, INT_MAX, &number)) {
+    return CSV_ROW_BAD_CODE;
+  }
+  movie->code = (int)number;
+
+  /* Parse title */
+  parseCSVField(&linePtr, movie->title, MAX_STRING_LENGTH);
+
+  /* Parse genres */
+  parseCSVField(&linePtr, genreBuffer, MAX_STRING_LENGTH);
+  cursor = genreBuffer;
+  while (movie->genreCount < MAX_GENRES_PER_MOVIE &&
+         (token = nextListItem(&cursor)) != NULL) {
+    trimString(token);
+    genre = getGenreFromString(token);
+    if (genre != GENRE_NONE) {
+      movie->genres[movie->genreCount++] = genre;
+    }
+  }
+
+  /* Parse description */
+  parseCSVField(&linePtr, description, MAX_DESCRIPTION_LENGTH);
+
+  /* Parse director */
+  parseCSVField(&linePtr, movie->director, MAX_STRING_LENGTH);
+
+  /* Parse actors */
+  parseCSVField(&linePtr, actorBuffer, MAX_DESCRIPTION_LENGTH);
+  cursor = actorBuffer;
+  while (movie->actorCount < MAX_ACTORS_PER_MOVIE &&
+         (token = nextListItem(&cursor)) != NULL) {
+    trimString(token);
+    if (strlen(token) > 0) {
+      strncpy(movie->actors[movie->actorCount], token,
+              MAX_ACTOR_NAME_LENGTH - 1);
+      movie->actors[movie->actorCount][MAX_ACTOR_NAME_LENGTH - 1] = '\0';
+      movie->actorCount++;
+    }
+  }
+
+  /* Parse year */
+  parseCSVField(&linePtr, field, sizeof(field));
+  numbersValid = parseIntegerField(field, INT_MIN, INT_MAX, &number);
+  movie->year = (int)number;
+
+  /* Parse duration */
+  parseCSVField(&linePtr, field, sizeof(field));
+  numbersValid &= parseIntegerField(field, INT_MIN, INT_MAX, &number);
+  movie->duration = (int)number;
+
+  /* Parse rating (decimal comma) */
+  parseCSVField(&linePtr, field, sizeof(field));
+  numbersValid &= parseDecimalField(field, -FLT_MAX, FLT_MAX, &decimal);
+  movie->rating = (float)decimal;
+
+  /* Parse favorite */
+  parseCSVField(&linePtr, field, sizeof(field));
+  numbersValid &= parseIntegerField(field, INT_MIN, INT_MAX, &number);
+  movie->favorite = (int)number;
+
+  /* Parse revenue (decimal comma) */
+  parseCSVField(&linePtr, field, sizeof(field));
+  numbersValid &= parseDecimalField(field, -FLT_MAX, FLT_MAX, &decimal);
+  movie->revenue = (float)decimal;
+
+  return numbersValid ? CSV_ROW_OK : CSV_ROW_BAD_NUMBER;
+}
+
+/* Retrain the description store and print the summary every importer
+   ends with */
+void finishImport(MovieDatabase *db, int importedCount, int duplicateCount) {
+  retrainTextStore(db, importedCount);
+
+  printf("\nImport complete:\n");
+  printf("- %d movies imported successfully\n", importedCount);
+  if (duplicateCount > 0) {
+    printf("- %d duplicate movies skipped\n", duplicateCount);
+  }
+}
+
 /* Import movies from CSV file */
 int importMoviesFromCSV(MovieDatabase *db, const char *filename) {
-  FILE *file;
+  LineReader reader;
   char line[4096];
-  char field[MAX_DESCRIPTION_LENGTH];
-  char *linePtr;
+  char description[MAX_DESCRIPTION_LENGTH];
   Movie movie;
+  CsvRowStatus status;
   int importedCount = 0;
   int duplicateCount = 0;
   int lineNumber = 0;
-  int i;
-  char *token;
-  char genreBuffer[MAX_STRING_LENGTH];
-  char actorBuffer[MAX_DESCRIPTION_LENGTH];
-  Genre genre;
 
   if (db == NULL || filename == NULL) {
     printf("Error: Invalid parameters.\n");
     return 0;
   }
 
-  file = fopen(filename, "r");
-  if (file == NULL) {
-    printf("Error: Could not open file '%s'.\n", filename);
+  /* Plain or gzip-compressed, decided by the first bytes */
+  if (!openLineReader(&reader, filename)) {
     return 0;
   }
 
   printf("Importing movies from '%s'...\n", filename);
 
   /* Skip header line */
-  if (fgets(line, sizeof(line), file) == NULL) {
+  if (readLine(&reader, line, sizeof(line)) == NULL) {
     printf("Error: File is empty.\n");
-    fclose(file);
+    closeLineReader(&reader);
     return 0;
   }
   lineNumber++;
 
   /* Read each line */
-  while (fgets(line, sizeof(line), file) != NULL) {
+  while (readLine(&reader, line, sizeof(line)) != NULL) {
     lineNumber++;
 
     /* Skip empty lines */
@@ -137,214 +373,398 @@ int importMoviesFromCSV(MovieDatabase *db, const char *filename) {
       continue;
     }
 
-    linePtr = line;
-
-    /* Initialise movie structure */
-    movie.genreCount = 0;
-    movie.actorCount = 0;
-    for (i = 0; i < MAX_GENRES_PER_MOVIE; i++) {
-      movie.genres[i] = GENRE_NONE;
-    }
-    for (i = 0; i < MAX_ACTORS_PER_MOVIE; i++) {
-      movie.actors[i][0] = '\0';
+    status = parseMovieCSVLine(line, &movie, description);
+    if (status == CSV_ROW_BAD_CODE) {
+      printf("Warning: Invalid code on line %d, skipped.\n", lineNumber);
+      continue;
     }
 
-    /* Parse code */
-    parseCSVField(&linePtr, field, sizeof(field));
-    movie.code = atoi(field);
-
     /* Check for duplicate */
     if (movieCodeExists(db, movie.code)) {
       duplicateCount++;
       continue;
     }
 
-    /* Parse title */
-    parseCSVField(&linePtr, movie.title, MAX_STRING_LENGTH);
-
-    /* Parse genres */
-    parseCSVField(&linePtr, genreBuffer, MAX_STRING_LENGTH);
-    token = strtok(genreBuffer, ",");
-    while (token != NULL && movie.genreCount < MAX_GENRES_PER_MOVIE) {
-      trimString(token);
-      genre = getGenreFromString(token);
-      if (genre != GENRE_NONE) {
-        movie.genres[movie.genreCount++] = genre;
+    /* Validate and add movie */
+    if (status == CSV_ROW_OK && validateMovieData(&movie)) {
+      if (addMovie(db, &movie, description)) {
+        importedCount++;
       }
-      token = strtok(NULL, ",");
+    } else {
+      printf("Warning: Invalid data on line %d, skipped.\n", lineNumber);
     }
+  }
+
+  closeLineReader(&reader);
 
-    /* Parse description */
-    parseCSVField(&linePtr, movie.description, MAX_DESCRIPTION_LENGTH);
+  finishImport(db, importedCount, duplicateCount);
+  return importedCount;
+}
 
-    /* Parse director */
-    parseCSVField(&linePtr, movie.director, MAX_STRING_LENGTH);
+/* Rejected edit lines printed individually, the rest are only counted */
+#define MAX_REPORTED_EDITS 20
 
-    /* Parse actors */
-    parseCSVField(&linePtr, actorBuffer, MAX_DESCRIPTION_LENGTH);
-    token = strtok(actorBuffer, ",");
-    while (token != NULL && movie.actorCount < MAX_ACTORS_PER_MOVIE) {
+/* Apply one (field, value) change with the add/edit validation rules -
+   the edit goes to a copy that must pass checkMovieData before it is
+   stored. Returns NULL on success or the reason the change was rejected */
+static const char *applyFieldEdit(Movie *movie, const char *field,
+                                  char *value) {
+  Movie edited = *movie;
+  Genre genre;
+  const char *reason;
+  char *token;
+  long number;
+  double decimal;
+  int genreCount = 0, i;
+
+  if (strcmp(field, "title") == 0) {
+    reason = "title cannot be empty";
+    if (strlen(value) >= MAX_STRING_LENGTH) {
+      return "title too long";
+    }
+    strcpy(edited.title, value);
+  } else if (strcmp(field, "genres") == 0) {
+    reason = "at least one valid genre is required";
+    for (i = 0; i < MAX_GENRES_PER_MOVIE; i++) {
+      edited.genres[i] = GENRE_NONE;
+    }
+    token = strtok(value, ",");
+    while (token != NULL && genreCount < MAX_GENRES_PER_MOVIE) {
       trimString(token);
-      if (strlen(token) > 0) {
-        strncpy(movie.actors[movie.actorCount], token,
-                MAX_ACTOR_NAME_LENGTH - 1);
-        movie.actors[movie.actorCount][MAX_ACTOR_NAME_LENGTH - 1] = '\0';
-        movie.actorCount++;
+      genre = getGenreFromString(token);
+      if (genre == GENRE_NONE) {
+        return "unknown genre";
       }
+      edited.genres[genreCount++] = genre;
       token = strtok(NULL, ",");
     }
-
-    /* Parse year */
-    parseCSVField(&linePtr, field, sizeof(field));
-    movie.year = atoi(field);
-
-    /* Parse duration */
-    parseCSVField(&linePtr, field, sizeof(field));
-    movie.duration = atoi(field);
-
-    /* Parse rating (replace comma with dot for decimal) */
-    parseCSVField(&linePtr, field, sizeof(field));
-    replaceCommaWithDot(field);
-    movie.rating = atof(field);
-
-    /* Parse favorite */
-    parseCSVField(&linePtr, field, sizeof(field));
-    movie.favorite = atoi(field);
-
-    /* Parse revenue (replace comma with dot for decimal) */
-    parseCSVField(&linePtr, field, sizeof(field));
-    replaceCommaWithDot(field);
-    movie.revenue = atof(field);
-
-    /* Validate and add movie */
-    if (validateMovieData(&movie)) {
-      if (addMovie(db, &movie)) {
-        importedCount++;
-      }
-    } else {
-      printf("Warning: Invalid data on line %d, skipped.\n", lineNumber);
+    edited.genreCount = genreCount;
+  } else if (strcmp(field, "year") == 0) {
+    reason = "invalid year";
+    if (!parseIntegerField(value, INT_MIN, INT_MAX, &number)) {
+      return reason;
+    }
+    edited.year = (int)number;
+  } else if (strcmp(field, "duration") == 0) {
+    reason = "invalid duration";
+    if (!parseIntegerField(value, INT_MIN, INT_MAX, &number)) {
+      return reason;
+    }
+    edited.duration = (int)number;
+  } else if (strcmp(field, "rating") == 0) {
+    reason = "invalid rating (must be between 0 and 10)";
+    if (!parseDecimalField(value, -FLT_MAX, FLT_MAX, &decimal)) {
+      return reason;
+    }
+    edited.rating = (float)decimal;
+  } else if (strcmp(field, "favorite") == 0) {
+    /* Not covered by checkMovieData, same range as the edit menu */
+    if (!parseIntegerField(value, 0, 999999999L, &number)) {
+      return "invalid favorites count";
+    }
+    edited.favorite = (int)number;
+    reason = NULL;
+  } else if (strcmp(field, "revenue") == 0) {
+    reason = "invalid revenue (must be non-negative)";
+    if (!parseDecimalField(value, -FLT_MAX, FLT_MAX, &decimal)) {
+      return reason;
     }
+    edited.revenue = (float)decimal;
+  } else if (strcmp(field, "code") == 0 || strcmp(field, "director") == 0 ||
+             strcmp(field, "actors") == 0 ||
+             strcmp(field, "description") == 0) {
+    return "field cannot be edited";
+  } else {
+    return "unknown field";
   }
 
-  fclose(file);
-
-  printf("\nImport complete:\n");
-  printf("- %d movies imported successfully\n", importedCount);
-  if (duplicateCount > 0) {
-    printf("- %d duplicate movies skipped\n", duplicateCount);
+  /* Report the edited field rather than checkMovieData's sentence, the
+     other fields already passed when the movie was added */
+  if (checkMovieData(&edited) != NULL) {
+    return (reason != NULL) ? reason : "invalid movie data";
   }
 
-  return importedCount;
+  *movie = edited;
+  return NULL;
 }
 
-/* Export movies to CSV file */
-int exportMoviesToCSV(const MovieDatabase *db, const char *filename) {
+/* Apply a code;field;value edit file in one pass - indexes are rebuilt
+   once for the whole batch instead of after every edit */
+int applyEditFile(MovieDatabase *db, const char *filename) {
   FILE *file;
-  FILE *testFile;
-  int i, j;
-  char ratingStr[20];
-  char revenueStr[20];
+  char line[4096];
+  char field[MAX_STRING_LENGTH];
+  char value[MAX_DESCRIPTION_LENGTH];
+  char *linePtr;
+  const char *reason;
+  long code;
+  int appliedCount = 0;
+  int rejectedCount = 0;
+  int lineNumber = 0;
+  int position;
 
   if (db == NULL || filename == NULL) {
     printf("Error: Invalid parameters.\n");
     return 0;
   }
 
-  if (db->count == 0) {
-    printf("Error: No movies to export.\n");
+  file = fopen(filename, "r");
+  if (file == NULL) {
+    printf("Error: Could not open file '%s'.\n", filename);
     return 0;
   }
 
-  /* Check if file already exists - portable across all platforms */
-  testFile = fopen(filename, "r");
-  if (testFile != NULL) {
-    fclose(testFile);
-    printf("Error: File '%s' already exists. Export cancelled.\n", filename);
-    return 0;
+  printf("Applying edits from '%s'...\n", filename);
+
+  while (fgets(line, sizeof(line), file) != NULL) {
+    lineNumber++;
+
+    /* Skip empty lines and comments */
+    if (strlen(line) <= 1 || line[0] == '#') {
+      continue;
+    }
+
+    linePtr = line;
+    parseCSVField(&linePtr, field, sizeof(field));
+
+    /* Optional header line */
+    if (lineNumber == 1 &&
+        !parseIntegerField(field, LONG_MIN, LONG_MAX, &code)) {
+      continue;
+    }
+
+    if (!parseIntegerField(field, 1, INT_MAX, &code)) {
+      reason = "invalid movie code";
+    } else if ((position = findMovieByCode(db, (int)code)) == -1) {
+      reason = "movie code not found";
+    } else {
+      parseCSVField(&linePtr, field, sizeof(field));
+      toLowerString(field, field);
+      parseCSVField(&linePtr, value, sizeof(value));
+      reason = applyFieldEdit(&db->movies[position], field, value);
+    }
+
+    if (reason == NULL) {
+      appliedCount++;
+    } else {
+      if (rejectedCount < MAX_REPORTED_EDITS) {
+        printf("Warning: Line %d rejected: %s.\n", lineNumber, reason);
+      }
+      rejectedCount++;
+    }
   }
 
-  file = fopen(filename, "w");
-  if (file == NULL) {
-    printf("Error: Could not create file '%s'.\n", filename);
-    return 0;
+  fclose(file);
+
+  /* Codes never change, so lookups stayed valid throughout the batch */
+  if (appliedCount > 0) {
+    db->version++;
+    rebuildIndexes(db);
   }
 
-  printf("Exporting %d movies to '%s'...\n", db->count, filename);
+  printf("\nEdit file applied:\n");
+  printf("- %d edits applied\n", appliedCount);
+  if (rejectedCount > 0) {
+    printf("- %d edits rejected", rejectedCount);
+    if (rejectedCount > MAX_REPORTED_EDITS) {
+      printf(" (first %d shown)", MAX_REPORTED_EDITS);
+    }
+    printf("\n");
+  }
+
+  return appliedCount;
+}
+
+/* Write the header and one line per movie */
+static void writeMoviesCSV(const MovieDatabase *db, OutputBuffer *out) {
+  int i, j;
+  char ratingStr[20];
+  char revenueStr[20];
+  char description[MAX_DESCRIPTION_LENGTH];
 
-  /* Write header */
-  fprintf(file, "code;title;genres;description;director;actors;year;duration;"
-                "rating;favorite;revenue\n");
+  outputString(out, "code;title;genres;description;director;actors;year;"
+                    "duration;rating;favorite;revenue\n");
 
-  /* Write each movie */
   for (i = 0; i < db->count; i++) {
     const Movie *m = &db->movies[i];
 
     /* Code */
-    fprintf(file, "%d;", m->code);
+    outputInt(out, m->code, 0, 0);
+    outputChar(out, ';');
 
     /* Title */
-    fprintf(file, "%s;", m->title);
+    outputString(out, m->title);
+    outputChar(out, ';');
 
     /* Genres (comma-separated) */
     for (j = 0; j < m->genreCount; j++) {
       if (j > 0) {
-        fprintf(file, ", ");
+        outputString(out, ", ");
       }
-      fprintf(file, "%s", getGenreName(m->genres[j]));
+      outputString(out, getGenreName(m->genres[j]));
     }
-    fprintf(file, ";");
+    outputChar(out, ';');
 
-    /* Description (with proper quote escaping) */
-    if (strchr(m->description, ';') != NULL ||
-        strchr(m->description, '"') != NULL) {
+    /* Description (decoded from the text store, with quote escaping) */
+    loadText(&db->text, &m->description, description);
+    if (strchr(description, ';') != NULL || strchr(description, '"') != NULL) {
       /* Field contains special characters, quote it */
-      fprintf(file, "\"");
-      for (j = 0; m->description[j] != '\0'; j++) {
-        if (m->description[j] == '"') {
-          fprintf(file, "\"\""); /* Escape quote */
+      outputChar(out, '"');
+      for (j = 0; description[j] != '\0'; j++) {
+        if (description[j] == '"') {
+          outputString(out, "\"\""); /* Escape quote */
         } else {
-          fprintf(file, "%c", m->description[j]);
+          outputChar(out, description[j]);
         }
       }
-      fprintf(file, "\"");
+      outputChar(out, '"');
     } else {
-      fprintf(file, "%s", m->description);
+      outputString(out, description);
     }
-    fprintf(file, ";");
+    outputChar(out, ';');
 
     /* Director */
-    fprintf(file, "%s;", m->director);
+    outputString(out, m->director);
+    outputChar(out, ';');
 
     /* Actors (comma-separated) */
     for (j = 0; j < m->actorCount; j++) {
       if (j > 0) {
-        fprintf(file, ", ");
+        outputString(out, ", ");
       }
-      fprintf(file, "%s", m->actors[j]);
+      outputString(out, m->actors[j]);
     }
-    fprintf(file, ";");
-
-    /* Year */
-    fprintf(file, "%d;", m->year);
+    outputChar(out, ';');
 
-    /* Duration */
-    fprintf(file, "%d;", m->duration);
+    /* Year, duration */
+    outputInt(out, m->year, 0, 0);
+    outputChar(out, ';');
+    outputInt(out, m->duration, 0, 0);
+    outputChar(out, ';');
 
     /* Rating (with comma as decimal separator) */
     sprintf(ratingStr, "%.1f", m->rating);
     replaceDotWithComma(ratingStr);
-    fprintf(file, "%s;", ratingStr);
+    outputString(out, ratingStr);
+    outputChar(out, ';');
 
     /* Favorite */
-    fprintf(file, "%d;", m->favorite);
+    outputInt(out, m->favorite, 0, 0);
+    outputChar(out, ';');
 
     /* Revenue (with comma as decimal separator) */
     sprintf(revenueStr, "%.2f", m->revenue);
     replaceDotWithComma(revenueStr);
-    fprintf(file, "%s\n", revenueStr);
+    outputString(out, revenueStr);
+    outputChar(out, '\n');
   }
+}
 
-  fclose(file);
+/* Create a new export file, refusing to overwrite an existing one */
+static FILE *createExportFile(const MovieDatabase *db, const char *filename,
+                              const char *mode) {
+  FILE *testFile;
+  FILE *file;
+
+  if (db == NULL || filename == NULL) {
+    printf("Error: Invalid parameters.\n");
+    return NULL;
+  }
+
+  if (db->count == 0) {
+    printf("Error: No movies to export.\n");
+    return NULL;
+  }
+
+  /* Check if file already exists - portable across all platforms */
+  testFile = fopen(filename, "r");
+  if (testFile != NULL) {
+    fclose(testFile);
+    printf("Error: File '%s' already exists. Export cancelled.\n", filename);
+    return NULL;
+  }
+
+  file = fopen(filename, mode);
+  if (file == NULL) {
+    printf("Error: Could not create file '%s'.\n", filename);
+  }
+  return file;
+}
+
+/* Export movies to CSV file */
+int exportMoviesToCSV(const MovieDatabase *db, const char *filename) {
+  FILE *file;
+  OutputBuffer out;
+  int ok;
+
+  file = createExportFile(db, filename, "w");
+  if (file == NULL) {
+    return 0;
+  }
+  if (!openOutputBuffer(&out, file)) {
+    fclose(file);
+    return 0;
+  }
+
+  printf("Exporting %d movies to '%s'...\n", db->count, filename);
+
+  writeMoviesCSV(db, &out);
+  ok = closeOutputBuffer(&out);
+  if (fclose(file) != 0) {
+    ok = 0;
+  }
+
+  if (!ok) {
+    printf("Error: Could not write to file '%s'.\n", filename);
+    return 0;
+  }
+
+  printf("Export complete: %d movies exported to '%s'.\n", db->count, filename);
+  return 1;
+}
+
+/* Export movies to a gzip-compressed CSV file - rows are formatted on this
+   thread while the compressor deflates the previous block */
+int exportMoviesToGzipCSV(const MovieDatabase *db, const char *filename) {
+  FILE *file;
+  OutputBuffer out;
+  CompressedWriter *writer;
+  int ok;
+
+  file = createExportFile(db, filename, "wb");
+  if (file == NULL) {
+    return 0;
+  }
+
+  writer = openCompressedWriter(file);
+  if (writer == NULL) {
+    fclose(file);
+    remove(filename);
+    return 0;
+  }
+  if (!openOutputBuffer(&out, file)) {
+    closeCompressedWriter(writer);
+    fclose(file);
+    remove(filename);
+    return 0;
+  }
+  setOutputSink(&out, writeCompressed, writer);
+
+  printf("Exporting %d movies to '%s' (gzip)...\n", db->count, filename);
+
+  writeMoviesCSV(db, &out);
+  ok = closeOutputBuffer(&out);
+  if (!closeCompressedWriter(writer)) {
+    ok = 0;
+  }
+  if (fclose(file) != 0) {
+    ok = 0;
+  }
+
+  if (!ok) {
+    printf("Error: Could not write to file '%s'.\n", filename);
+    return 0;
+  }
 
   printf("Export complete: %d movies exported to '%s'.\n", db->count, filename);
   return 1;
@@ -3,13 +3,36 @@
 
 #include "types.h"
 
-/* CSV Import/Export functions */
+/* CSV Import/Export functions (import also reads gzip-compressed CSV) */
 int importMoviesFromCSV(MovieDatabase *db, const char *filename);
 int exportMoviesToCSV(const MovieDatabase *db, const char *filename);
+int exportMoviesToGzipCSV(const MovieDatabase *db, const char *filename);
+
+/* Shared end of every import: retrain the description store, then print
+   the imported and duplicate counts */
+void finishImport(MovieDatabase *db, int importedCount, int duplicateCount);
+
+/* Apply a code;field;value edit file, returns the number of edits applied */
+int applyEditFile(MovieDatabase *db, const char *filename);
+
+/* Outcome of parsing one CSV data line */
+typedef enum {
+  CSV_ROW_OK,
+  CSV_ROW_BAD_CODE,  /* Missing or malformed code - nothing else parsed */
+  CSV_ROW_BAD_NUMBER /* Some other numeric field is malformed */
+} CsvRowStatus;
 
 /* Helper functions for CSV parsing */
+CsvRowStatus parseMovieCSVLine(char *line, Movie *movie, char *description);
 char *parseCSVField(char **linePtr, char *buffer, int bufferSize);
 void replaceCommaWithDot(char *str);
 void replaceDotWithComma(char *str);
 
+/* Locale-independent whole-field decoders, return 1 when the field is a
+   number within [minimum, maximum] */
+int parseIntegerField(const char *text, long minimum, long maximum,
+                      long *value);
+int parseDecimalField(const char *text, double minimum, double maximum,
+                      double *value);
+
 #endif /* FILEIO_H */
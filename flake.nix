@@ -24,7 +24,7 @@
 
           src = ./.;
 
-          buildInputs = [ ];
+          buildInputs = [ pkgs.zlib ];
 
           nativeBuildInputs = [ pkgs.gcc ];
 
@@ -49,6 +49,7 @@
             gcc
             gnumake
             clang-tools
+            zlib
           ];
 
           shellHook = ''
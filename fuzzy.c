@@ -0,0 +1,555 @@
+#include "fuzzy.h"
+#include "names.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* BK-tree node - children are linked through firstChild/nextSibling */
+typedef struct {
+  int nameId;      /* Name stored at this node */
+  int edge;        /* Edit distance to the parent */
+  int firstChild;  /* First child node, or -1 */
+  int nextSibling; /* Next child of the same parent, or -1 */
+} BkNode;
+
+/* Hash buckets of the bigram index (power of two) - collisions only let
+   extra candidates through */
+#define GRAM_BUCKETS 4096
+
+/* Distinct names with a BK-tree over them, per-name movie postings and
+   a bigram index for the count filter */
+typedef struct {
+  NameTable names;
+  BkNode *nodes;     /* One node per name, node i holds name i */
+  int *postingStart; /* CSR offsets into postings, per name id */
+  int *postings;     /* Movie positions */
+  int *gramStart;    /* CSR offsets into gramNames, per bigram bucket */
+  int *gramNames;    /* Name ids, each at most once per bucket */
+} NameDictionary;
+
+/* Cached dictionaries, rebuilt when the database version changes */
+static NameDictionary actorDictionary;
+static NameDictionary directorDictionary;
+static const MovieDatabase *indexedDatabase = NULL;
+static unsigned long indexedVersion = 0;
+
+/* Case-insensitive Levenshtein distance, giving up with limit + 1 as soon
+   as a whole row exceeds limit (MAX_STRING_LENGTH for the exact value) */
+static int editDistance(const char *a, const char *b, int limit) {
+  int row[MAX_STRING_LENGTH + 1];
+  int lengthA = (int)strlen(a);
+  int lengthB = (int)strlen(b);
+  int i, j, diagonal, above, cost, rowMinimum;
+
+  if (lengthA > MAX_STRING_LENGTH) {
+    lengthA = MAX_STRING_LENGTH;
+  }
+  if (lengthB > MAX_STRING_LENGTH) {
+    lengthB = MAX_STRING_LENGTH;
+  }
+
+  for (j = 0; j <= lengthB; j++) {
+    row[j] = j;
+  }
+
+  /* Single-row dynamic programming */
+  for (i = 1; i <= lengthA; i++) {
+    diagonal = row[0];
+    row[0] = i;
+    rowMinimum = i;
+    for (j = 1; j <= lengthB; j++) {
+      above = row[j];
+      cost = (tolower((unsigned char)a[i - 1]) ==
+              tolower((unsigned char)b[j - 1]))
+                 ? 0
+                 : 1;
+      row[j] = diagonal + cost;
+      if (above + 1 < row[j]) {
+        row[j] = above + 1;
+      }
+      if (row[j - 1] + 1 < row[j]) {
+        row[j] = row[j - 1] + 1;
+      }
+      if (row[j] < rowMinimum) {
+        rowMinimum = row[j];
+      }
+      diagonal = above;
+    }
+    /* Row minimums never decrease */
+    if (rowMinimum > limit) {
+      return limit + 1;
+    }
+  }
+
+  return row[lengthB];
+}
+
+/* Bucket of the bigram starting at text */
+static int gramBucket(const char *text) {
+  return (int)(((unsigned int)tolower((unsigned char)text[0]) * 131U +
+                (unsigned int)tolower((unsigned char)text[1])) &
+               (GRAM_BUCKETS - 1));
+}
+
+/* Distinct bigram buckets of a name, returns their number */
+static int collectGrams(const char *name, int *buckets) {
+  int i, j, bucket, count = 0;
+
+  for (i = 0; i < MAX_STRING_LENGTH - 1 && name[i] != '\0' &&
+              name[i + 1] != '\0';
+       i++) {
+    bucket = gramBucket(name + i);
+    j = 0;
+    while (j < count && buckets[j] != bucket) {
+      j++;
+    }
+    if (j == count) {
+      buckets[count++] = bucket;
+    }
+  }
+  return count;
+}
+
+/* Release a dictionary */
+static void freeDictionary(NameDictionary *dictionary) {
+  freeNameTable(&dictionary->names);
+  free(dictionary->nodes);
+  free(dictionary->postingStart);
+  free(dictionary->postings);
+  free(dictionary->gramStart);
+  free(dictionary->gramNames);
+  dictionary->nodes = NULL;
+  dictionary->postingStart = NULL;
+  dictionary->postings = NULL;
+  dictionary->gramStart = NULL;
+  dictionary->gramNames = NULL;
+}
+
+/* Insert name id into the BK-tree rooted at node 0 */
+static void insertNode(NameDictionary *dictionary, int id) {
+  BkNode *nodes = dictionary->nodes;
+  const char *name = getNameById(&dictionary->names, id);
+  int current = 0;
+  int child, distance;
+
+  nodes[id].nameId = id;
+  nodes[id].firstChild = -1;
+  nodes[id].nextSibling = -1;
+  nodes[id].edge = 0;
+
+  if (id == 0) {
+    return; /* Root */
+  }
+
+  while (1) {
+    distance = editDistance(name, getNameById(&dictionary->names, current),
+                            MAX_STRING_LENGTH);
+
+    for (child = nodes[current].firstChild; child != -1;
+         child = nodes[child].nextSibling) {
+      if (nodes[child].edge == distance) {
+        break;
+      }
+    }
+
+    if (child == -1) {
+      nodes[id].edge = distance;
+      nodes[id].nextSibling = nodes[current].firstChild;
+      nodes[current].firstChild = id;
+      return;
+    }
+    current = child;
+  }
+}
+
+/* Bucket every name under its distinct bigrams, in CSR form */
+static int buildGramIndex(NameDictionary *dictionary) {
+  int buckets[MAX_STRING_LENGTH];
+  int *fill;
+  int i, j, count, total = 0;
+
+  dictionary->gramStart = (int *)calloc(GRAM_BUCKETS + 1, sizeof(int));
+  fill = (int *)malloc(GRAM_BUCKETS * sizeof(int));
+  if (dictionary->gramStart == NULL || fill == NULL) {
+    free(fill);
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  for (i = 0; i < dictionary->names.count; i++) {
+    count = collectGrams(getNameById(&dictionary->names, i), buckets);
+    for (j = 0; j < count; j++) {
+      dictionary->gramStart[buckets[j] + 1]++;
+    }
+    total += count;
+  }
+  for (i = 0; i < GRAM_BUCKETS; i++) {
+    dictionary->gramStart[i + 1] += dictionary->gramStart[i];
+    fill[i] = dictionary->gramStart[i];
+  }
+
+  dictionary->gramNames = (int *)malloc((total + 1) * sizeof(int));
+  if (dictionary->gramNames == NULL) {
+    free(fill);
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+  for (i = 0; i < dictionary->names.count; i++) {
+    count = collectGrams(getNameById(&dictionary->names, i), buckets);
+    for (j = 0; j < count; j++) {
+      dictionary->gramNames[fill[buckets[j]]++] = i;
+    }
+  }
+
+  free(fill);
+  return 1;
+}
+
+/* Intern every name of one kind, then build the tree and postings */
+static int buildDictionary(const MovieDatabase *db, SearchType type,
+                           NameDictionary *dictionary) {
+  int *fill;
+  int i, j, id, total = 0;
+
+  initNameTable(&dictionary->names);
+  dictionary->nodes = NULL;
+  dictionary->postingStart = NULL;
+  dictionary->postings = NULL;
+  dictionary->gramStart = NULL;
+  dictionary->gramNames = NULL;
+
+  for (i = 0; i < db->count; i++) {
+    if (type == SEARCH_BY_DIRECTOR) {
+      if (internName(&dictionary->names, db->movies[i].director) < 0) {
+        return 0;
+      }
+      total++;
+    } else {
+      for (j = 0; j < db->movies[i].actorCount; j++) {
+        if (internName(&dictionary->names, db->movies[i].actors[j]) < 0) {
+          return 0;
+        }
+        total++;
+      }
+    }
+  }
+
+  dictionary->nodes =
+      (BkNode *)malloc((dictionary->names.count + 1) * sizeof(BkNode));
+  dictionary->postingStart =
+      (int *)calloc(dictionary->names.count + 1, sizeof(int));
+  dictionary->postings = (int *)malloc((total + 1) * sizeof(int));
+  fill = (int *)malloc((dictionary->names.count + 1) * sizeof(int));
+  if (dictionary->nodes == NULL || dictionary->postingStart == NULL ||
+      dictionary->postings == NULL || fill == NULL) {
+    free(fill);
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  for (i = 0; i < dictionary->names.count; i++) {
+    insertNode(dictionary, i);
+  }
+
+  /* Postings in CSR form: count, prefix sum, fill */
+  for (i = 0; i < db->count; i++) {
+    if (type == SEARCH_BY_DIRECTOR) {
+      dictionary->postingStart[findNameId(&dictionary->names,
+                                          db->movies[i].director) +
+                               1]++;
+    } else {
+      for (j = 0; j < db->movies[i].actorCount; j++) {
+        dictionary->postingStart[findNameId(&dictionary->names,
+                                            db->movies[i].actors[j]) +
+                                 1]++;
+      }
+    }
+  }
+  for (i = 0; i < dictionary->names.count; i++) {
+    dictionary->postingStart[i + 1] += dictionary->postingStart[i];
+    fill[i] = dictionary->postingStart[i];
+  }
+  for (i = 0; i < db->count; i++) {
+    if (type == SEARCH_BY_DIRECTOR) {
+      id = findNameId(&dictionary->names, db->movies[i].director);
+      dictionary->postings[fill[id]++] = i;
+    } else {
+      for (j = 0; j < db->movies[i].actorCount; j++) {
+        id = findNameId(&dictionary->names, db->movies[i].actors[j]);
+        dictionary->postings[fill[id]++] = i;
+      }
+    }
+  }
+
+  free(fill);
+  return buildGramIndex(dictionary);
+}
+
+/* Make sure the dictionaries describe the current database */
+static int ensureIndex(const MovieDatabase *db) {
+  if (indexedDatabase == db && indexedVersion == db->version) {
+    return 1;
+  }
+
+  freeFuzzyIndex();
+
+  if (!buildDictionary(db, SEARCH_BY_ACTOR, &actorDictionary) ||
+      !buildDictionary(db, SEARCH_BY_DIRECTOR, &directorDictionary)) {
+    freeFuzzyIndex();
+    return 0;
+  }
+
+  indexedDatabase = db;
+  indexedVersion = db->version;
+  return 1;
+}
+
+/* Release the cached name dictionaries */
+void freeFuzzyIndex(void) {
+  freeDictionary(&actorDictionary);
+  freeDictionary(&directorDictionary);
+  indexedDatabase = NULL;
+}
+
+/* Default edit distance limit - about one typo per five characters */
+int getDefaultMaxDistance(const char *name) {
+  int length = (name == NULL) ? 0 : (int)strlen(name);
+
+  if (length <= 4) {
+    return 1;
+  }
+  if (length <= 10) {
+    return 2;
+  }
+  return 3;
+}
+
+/* Insert a match into the list kept ordered by distance */
+static int addMatch(FuzzyMatch *matches, int count, int maxMatches,
+                    int nameId, int distance) {
+  int i;
+
+  if (count < maxMatches) {
+    i = count++;
+  } else if (matches[maxMatches - 1].distance > distance) {
+    i = maxMatches - 1;
+  } else {
+    return count; /* List full of closer names */
+  }
+  while (i > 0 && matches[i - 1].distance > distance) {
+    matches[i] = matches[i - 1];
+    i--;
+  }
+  matches[i].nameId = nameId;
+  matches[i].distance = distance;
+  return count;
+}
+
+/* Walk the BK-tree, visiting only children whose edge distance lies in
+   [d - maxDistance, d + maxDistance] (triangle inequality) */
+static int searchTree(const NameDictionary *dictionary, const char *name,
+                      int maxDistance, FuzzyMatch *matches, int maxMatches,
+                      FuzzyStats *stats) {
+  int *stack;
+  int top = 0, count = 0;
+  int node, child, distance;
+
+  stack = (int *)malloc(dictionary->names.count * sizeof(int));
+  if (stack == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  stack[top++] = 0;
+  while (top > 0) {
+    node = stack[--top];
+    distance = editDistance(
+        name, getNameById(&dictionary->names, dictionary->nodes[node].nameId),
+        MAX_STRING_LENGTH);
+    stats->examined++;
+
+    if (distance <= maxDistance) {
+      count = addMatch(matches, count, maxMatches,
+                       dictionary->nodes[node].nameId, distance);
+    }
+
+    for (child = dictionary->nodes[node].firstChild; child != -1;
+         child = dictionary->nodes[child].nextSibling) {
+      if (dictionary->nodes[child].edge >= distance - maxDistance &&
+          dictionary->nodes[child].edge <= distance + maxDistance) {
+        stack[top++] = child;
+      }
+    }
+  }
+
+  free(stack);
+  return count;
+}
+
+/* Count filter: each edit touches at most two bigram positions, so a name
+   within maxDistance shares at least threshold of the query's distinct
+   bigram buckets. Only names reaching it that also pass the length bound
+   get a (bounded) edit distance */
+static int searchGrams(const NameDictionary *dictionary, const char *name,
+                       int bucketCount, const int *buckets, int threshold,
+                       int maxDistance, FuzzyMatch *matches, int maxMatches,
+                       FuzzyStats *stats) {
+  const char *candidate;
+  int *shared;
+  int count = 0, length = (int)strlen(name);
+  int i, j, id, difference, distance;
+
+  shared = (int *)calloc(dictionary->names.count, sizeof(int));
+  if (shared == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  for (i = 0; i < bucketCount; i++) {
+    for (j = dictionary->gramStart[buckets[i]];
+         j < dictionary->gramStart[buckets[i] + 1]; j++) {
+      id = dictionary->gramNames[j];
+      if (++shared[id] != threshold) {
+        continue; /* Below the threshold, or already checked */
+      }
+
+      candidate = getNameById(&dictionary->names, id);
+      difference = (int)strlen(candidate) - length;
+      if (difference > maxDistance || difference < -maxDistance) {
+        continue;
+      }
+
+      distance = editDistance(name, candidate, maxDistance);
+      stats->examined++;
+      if (distance <= maxDistance) {
+        count = addMatch(matches, count, maxMatches, id, distance);
+      }
+    }
+  }
+
+  free(shared);
+  return count;
+}
+
+/* Look the name up through the bigram count filter, or through the
+   BK-tree when the query is too short for the filter to rule anything
+   out */
+int fuzzySearchNames(const MovieDatabase *db, SearchType type,
+                     const char *name, int maxDistance, FuzzyMatch *matches,
+                     int maxMatches, FuzzyStats *stats) {
+  NameDictionary *dictionary;
+  FuzzyStats local;
+  int buckets[MAX_STRING_LENGTH];
+  int bucketCount, threshold;
+
+  if (stats == NULL) {
+    stats = &local;
+  }
+  stats->dictionarySize = 0;
+  stats->examined = 0;
+
+  if (db == NULL || name == NULL || matches == NULL || maxMatches <= 0 ||
+      !ensureIndex(db)) {
+    return 0;
+  }
+
+  dictionary = (type == SEARCH_BY_DIRECTOR) ? &directorDictionary
+                                            : &actorDictionary;
+  stats->dictionarySize = dictionary->names.count;
+  if (dictionary->names.count == 0) {
+    return 0;
+  }
+
+  bucketCount = collectGrams(name, buckets);
+  threshold = bucketCount - 2 * maxDistance;
+  if (threshold < 1) {
+    return searchTree(dictionary, name, maxDistance, matches, maxMatches,
+                      stats);
+  }
+  return searchGrams(dictionary, name, bucketCount, buckets, threshold,
+                     maxDistance, matches, maxMatches, stats);
+}
+
+/* Movies of the matched names, without duplicates */
+int collectFuzzyMatchMovies(const MovieDatabase *db, SearchType type,
+                            const FuzzyMatch *matches, int matchCount,
+                            int *results, int maxResults) {
+  NameDictionary *dictionary;
+  char *seen;
+  int i, j, position, count = 0;
+
+  if (db == NULL || matches == NULL || results == NULL || !ensureIndex(db) ||
+      db->count == 0) {
+    return 0;
+  }
+
+  dictionary = (type == SEARCH_BY_DIRECTOR) ? &directorDictionary
+                                            : &actorDictionary;
+
+  seen = (char *)calloc(db->count, 1);
+  if (seen == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  for (i = 0; i < matchCount && count < maxResults; i++) {
+    for (j = dictionary->postingStart[matches[i].nameId];
+         j < dictionary->postingStart[matches[i].nameId + 1] &&
+         count < maxResults;
+         j++) {
+      position = dictionary->postings[j];
+      if (!seen[position]) {
+        seen[position] = 1;
+        results[count++] = position;
+      }
+    }
+  }
+
+  free(seen);
+  return count;
+}
+
+/* Name stored for a match */
+const char *getFuzzyMatchName(SearchType type, const FuzzyMatch *match) {
+  const NameDictionary *dictionary = (type == SEARCH_BY_DIRECTOR)
+                                         ? &directorDictionary
+                                         : &actorDictionary;
+
+  if (match == NULL) {
+    return "";
+  }
+  return getNameById(&dictionary->names, match->nameId);
+}
+
+/* Measure one dictionary - every array has one spare entry */
+static long getDictionaryBytes(const NameDictionary *dictionary,
+                               long *used) {
+  long allocated, names, postings, grams;
+
+  allocated = getNameTableBytes(&dictionary->names, used);
+  if (dictionary->gramNames == NULL) {
+    return allocated;
+  }
+
+  names = dictionary->names.count;
+  postings = dictionary->postingStart[names];
+  grams = dictionary->gramStart[GRAM_BUCKETS];
+  allocated += (names + 1) * (long)sizeof(BkNode) +
+               (names + 1 + postings + 1 + GRAM_BUCKETS + 1 + grams + 1) *
+                   (long)sizeof(int);
+  *used += names * (long)sizeof(BkNode) +
+           (names + 1 + postings + GRAM_BUCKETS + 1 + grams) *
+               (long)sizeof(int);
+  return allocated;
+}
+
+/* Measure the cached dictionaries */
+long getFuzzyIndexBytes(long *used) {
+  long allocated, directorUsed;
+
+  allocated = getDictionaryBytes(&actorDictionary, used);
+  allocated += getDictionaryBytes(&directorDictionary, &directorUsed);
+  *used += directorUsed;
+  return allocated;
+}
@@ -0,0 +1,44 @@
+#ifndef FUZZY_H
+#define FUZZY_H
+
+#include "types.h"
+
+#define FUZZY_MATCH_LIMIT 20 /* Closest names reported per lookup */
+
+/* A dictionary name within the edit distance limit */
+typedef struct {
+  int nameId;   /* Id in the actor or director dictionary */
+  int distance; /* Edit distance to the query */
+} FuzzyMatch;
+
+/* Cost counters of the last fuzzy lookup */
+typedef struct {
+  int dictionarySize; /* Distinct names in the dictionary */
+  int examined;       /* Names whose edit distance was computed */
+} FuzzyStats;
+
+/* Default edit distance limit for a query of the given length */
+int getDefaultMaxDistance(const char *name);
+
+/* Typo-tolerant lookup of distinct actor (SEARCH_BY_ACTOR) or director
+   (SEARCH_BY_DIRECTOR) names, closest first */
+int fuzzySearchNames(const MovieDatabase *db, SearchType type,
+                     const char *name, int maxDistance, FuzzyMatch *matches,
+                     int maxMatches, FuzzyStats *stats);
+
+/* Movies of the matched names (indices, without duplicates) */
+int collectFuzzyMatchMovies(const MovieDatabase *db, SearchType type,
+                            const FuzzyMatch *matches, int matchCount,
+                            int *results, int maxResults);
+
+/* Name stored for a match */
+const char *getFuzzyMatchName(SearchType type, const FuzzyMatch *match);
+
+/* Release the cached name dictionaries */
+void freeFuzzyIndex(void);
+
+/* Heap bytes of both dictionaries (names, BK-tree, postings, bigram
+   index), bytes in use in *used */
+long getFuzzyIndexBytes(long *used);
+
+#endif /* FUZZY_H */
@@ -0,0 +1,501 @@
+#include "index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Helper structure for building an index with qsort */
+typedef struct {
+  double value;
+  int position;
+} IndexValuePair;
+
+/* Get display name of an indexed field */
+const char *getIndexFieldName(IndexField field) {
+  switch (field) {
+  case INDEX_YEAR:
+    return "Year";
+  case INDEX_RATING:
+    return "Rating";
+  case INDEX_DURATION:
+    return "Duration";
+  case INDEX_REVENUE:
+    return "Revenue";
+  case INDEX_CODE:
+    return "Code";
+  case INDEX_FIELD_COUNT:
+    break;
+  }
+  return "Unknown";
+}
+
+/* Get the value a movie is indexed by */
+double getIndexValue(const Movie *movie, IndexField field) {
+  switch (field) {
+  case INDEX_YEAR:
+    return movie->year;
+  case INDEX_RATING:
+    return movie->rating;
+  case INDEX_DURATION:
+    return movie->duration;
+  case INDEX_REVENUE:
+    return movie->revenue;
+  case INDEX_CODE:
+    return movie->code;
+  case INDEX_FIELD_COUNT:
+    break;
+  }
+  return 0.0;
+}
+
+/* Clamp a year into the bucket directory range */
+static int yearBucket(int year) {
+  if (year < MIN_YEAR) {
+    return 0;
+  }
+  if (year > MAX_YEAR) {
+    return YEAR_BUCKETS - 1;
+  }
+  return year - MIN_YEAR;
+}
+
+/* Comparison function for sorting by (value, position) */
+static int compareIndexValue(const void *a, const void *b) {
+  const IndexValuePair *pairA = (const IndexValuePair *)a;
+  const IndexValuePair *pairB = (const IndexValuePair *)b;
+
+  if (pairA->value < pairB->value) {
+    return -1;
+  }
+  if (pairA->value > pairB->value) {
+    return 1;
+  }
+  return pairA->position - pairB->position;
+}
+
+/* Order of (value, position) keys, same as compareIndexValue */
+static int compareKey(double valueA, int positionA, double valueB,
+                      int positionB) {
+  if (valueA < valueB) {
+    return -1;
+  }
+  if (valueA > valueB) {
+    return 1;
+  }
+  return positionA - positionB;
+}
+
+/* Binary search for the slot of (value, position) in an index of n entries */
+static int findSlot(const MovieDatabase *db, IndexField field, int n,
+                    double value, int position) {
+  const int *entries = db->indexes.byField[field];
+  int low = 0, high = n, mid;
+
+  while (low < high) {
+    mid = low + (high - low) / 2;
+    if (compareKey(getIndexValue(&db->movies[entries[mid]], field),
+                   entries[mid], value, position) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+
+/* Position of the movie with a code, found through the code index, or -1 */
+int findPositionByCode(const MovieDatabase *db, int code) {
+  const int *entries;
+  int low = 0, high, mid;
+
+  if (db == NULL) {
+    return -1;
+  }
+
+  entries = db->indexes.byField[INDEX_CODE];
+  high = db->count;
+  while (low < high) {
+    mid = low + (high - low) / 2;
+    if (db->movies[entries[mid]].code < code) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  if (low < db->count && db->movies[entries[low]].code == code) {
+    return entries[low];
+  }
+  return -1;
+}
+
+/* Rebuild the year index with a counting sort over the bucket domain */
+static void rebuildYearIndex(MovieDatabase *db) {
+  int *start = db->indexes.yearStart;
+  int *entries = db->indexes.byField[INDEX_YEAR];
+  int fill[YEAR_BUCKETS];
+  int i, bucket;
+
+  for (i = 0; i <= YEAR_BUCKETS; i++) {
+    start[i] = 0;
+  }
+
+  /* Count movies per year, then turn counts into start offsets */
+  for (i = 0; i < db->count; i++) {
+    start[yearBucket(db->movies[i].year) + 1]++;
+  }
+  for (i = 0; i < YEAR_BUCKETS; i++) {
+    start[i + 1] += start[i];
+    fill[i] = start[i];
+  }
+
+  /* Positions are visited in ascending order, so buckets stay sorted */
+  for (i = 0; i < db->count; i++) {
+    bucket = yearBucket(db->movies[i].year);
+    entries[fill[bucket]++] = i;
+  }
+}
+
+/* Add (delta = 1) or remove (delta = -1) a movie from the genre counts */
+static void countGenres(MovieDatabase *db, const Movie *movie, int delta) {
+  unsigned long seen = 0;
+  int i;
+
+  for (i = 0; i < movie->genreCount; i++) {
+    if (movie->genres[i] < GENRE_NONE && !(seen & (1UL << movie->genres[i]))) {
+      seen |= 1UL << movie->genres[i];
+      db->indexes.genreCounts[movie->genres[i]] += delta;
+    }
+  }
+}
+
+/* Recount movies per genre */
+static void rebuildGenreCounts(MovieDatabase *db) {
+  int i;
+
+  for (i = 0; i < GENRE_NONE; i++) {
+    db->indexes.genreCounts[i] = 0;
+  }
+  for (i = 0; i < db->count; i++) {
+    countGenres(db, &db->movies[i], 1);
+  }
+}
+
+/* Rebuild all secondary indexes from scratch */
+void rebuildIndexes(MovieDatabase *db) {
+  IndexValuePair *pairs;
+  int field, i;
+
+  if (db == NULL) {
+    return;
+  }
+
+  rebuildYearIndex(db);
+  rebuildGenreCounts(db);
+
+  if (db->count == 0) {
+    return;
+  }
+
+  pairs = (IndexValuePair *)malloc(db->count * sizeof(IndexValuePair));
+  if (pairs == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return;
+  }
+
+  for (field = INDEX_RATING; field < INDEX_FIELD_COUNT; field++) {
+    for (i = 0; i < db->count; i++) {
+      pairs[i].value = getIndexValue(&db->movies[i], (IndexField)field);
+      pairs[i].position = i;
+    }
+
+    qsort(pairs, db->count, sizeof(IndexValuePair), compareIndexValue);
+
+    for (i = 0; i < db->count; i++) {
+      db->indexes.byField[field][i] = pairs[i].position;
+    }
+  }
+
+  free(pairs);
+}
+
+/* Insert a position into one index holding n entries */
+static void insertEntry(MovieDatabase *db, IndexField field, int n,
+                        int position) {
+  int *entries = db->indexes.byField[field];
+  int slot, i;
+
+  slot = findSlot(db, field, n,
+                  getIndexValue(&db->movies[position], field), position);
+  memmove(&entries[slot + 1], &entries[slot], (n - slot) * sizeof(int));
+  entries[slot] = position;
+
+  if (field == INDEX_YEAR) {
+    for (i = yearBucket(db->movies[position].year) + 1; i <= YEAR_BUCKETS;
+         i++) {
+      db->indexes.yearStart[i]++;
+    }
+  }
+}
+
+/* Remove a position from one index holding n entries (no renumbering) */
+static void removeEntry(MovieDatabase *db, IndexField field, int n,
+                        int position) {
+  int *entries = db->indexes.byField[field];
+  int slot, i;
+
+  slot = findSlot(db, field, n,
+                  getIndexValue(&db->movies[position], field), position);
+  if (slot >= n || entries[slot] != position) {
+    return; /* Not indexed - nothing to remove */
+  }
+
+  memmove(&entries[slot], &entries[slot + 1], (n - slot - 1) * sizeof(int));
+
+  if (field == INDEX_YEAR) {
+    for (i = yearBucket(db->movies[position].year) + 1; i <= YEAR_BUCKETS;
+         i++) {
+      db->indexes.yearStart[i]--;
+    }
+  }
+}
+
+/* Add the movie just appended at position (db->count already includes it) */
+void indexInsertMovie(MovieDatabase *db, int position) {
+  int field;
+
+  if (db == NULL || position < 0 || position >= db->count) {
+    return;
+  }
+
+  for (field = 0; field < INDEX_FIELD_COUNT; field++) {
+    insertEntry(db, (IndexField)field, db->count - 1, position);
+  }
+  countGenres(db, &db->movies[position], 1);
+}
+
+/* Remove the movie at position before it is deleted from the array;
+   positions after it are renumbered to match the shift that follows */
+void indexRemoveMovie(MovieDatabase *db, int position) {
+  int field, i;
+  int *entries;
+
+  if (db == NULL || position < 0 || position >= db->count) {
+    return;
+  }
+
+  countGenres(db, &db->movies[position], -1);
+
+  for (field = 0; field < INDEX_FIELD_COUNT; field++) {
+    removeEntry(db, (IndexField)field, db->count, position);
+
+    entries = db->indexes.byField[field];
+    for (i = 0; i < db->count - 1; i++) {
+      if (entries[i] > position) {
+        entries[i]--;
+      }
+    }
+  }
+}
+
+/* Re-position a movie whose indexed fields may have changed in place */
+void indexUpdateMovie(MovieDatabase *db, int position) {
+  int field, slot, n;
+  int *entries;
+
+  if (db == NULL || position < 0 || position >= db->count) {
+    return;
+  }
+
+  n = db->count;
+
+  /* The bucket directory and genre counts depend on the old values, so
+     they are rebuilt - O(n) */
+  rebuildYearIndex(db);
+  rebuildGenreCounts(db);
+
+  for (field = INDEX_RATING; field < INDEX_FIELD_COUNT; field++) {
+    entries = db->indexes.byField[field];
+
+    /* The stored key is stale, so locate the entry by scanning */
+    slot = 0;
+    while (slot < n && entries[slot] != position) {
+      slot++;
+    }
+    if (slot == n) {
+      rebuildIndexes(db);
+      return;
+    }
+
+    memmove(&entries[slot], &entries[slot + 1], (n - slot - 1) * sizeof(int));
+    insertEntry(db, (IndexField)field, n - 1, position);
+  }
+}
+
+/* Smallest valid year >= value */
+static int yearAtLeast(double value) {
+  int year;
+
+  if (value <= MIN_YEAR) {
+    return MIN_YEAR;
+  }
+  if (value > MAX_YEAR) {
+    return MAX_YEAR + 1;
+  }
+  year = (int)value;
+  return (year < value) ? year + 1 : year;
+}
+
+/* Largest valid year <= value */
+static int yearAtMost(double value) {
+  if (value < MIN_YEAR) {
+    return MIN_YEAR - 1;
+  }
+  if (value >= MAX_YEAR) {
+    return MAX_YEAR;
+  }
+  return (int)value;
+}
+
+/* Find the slice of an index whose values fall within [min, max] */
+void findIndexRange(const MovieDatabase *db, const RangePredicate *predicate,
+                    int *first, int *last) {
+  const int *entries;
+  int low, high, mid;
+  double value;
+
+  *first = 0;
+  *last = 0;
+
+  if (db == NULL || predicate == NULL || predicate->min > predicate->max) {
+    return;
+  }
+
+  if (predicate->field == INDEX_YEAR && db->count == 0) {
+    return;
+  }
+
+  if (predicate->field == INDEX_YEAR) {
+    /* Year ranges resolve directly through the bucket directory */
+    low = yearAtLeast(predicate->min);
+    if (predicate->minOpen && low == predicate->min) {
+      low++;
+    }
+    high = yearAtMost(predicate->max);
+    if (predicate->maxOpen && high == predicate->max) {
+      high--;
+    }
+    if (low > high || low > MAX_YEAR || high < MIN_YEAR) {
+      return;
+    }
+    *first = db->indexes.yearStart[low - MIN_YEAR];
+    *last = db->indexes.yearStart[high - MIN_YEAR + 1];
+    return;
+  }
+
+  entries = db->indexes.byField[predicate->field];
+
+  /* Lower bound: first value >= min (> min when open) */
+  low = 0;
+  high = db->count;
+  while (low < high) {
+    mid = low + (high - low) / 2;
+    value = getIndexValue(&db->movies[entries[mid]], predicate->field);
+    if (value < predicate->min ||
+        (predicate->minOpen && value == predicate->min)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  *first = low;
+
+  /* Upper bound: first value > max (>= max when open) */
+  high = db->count;
+  while (low < high) {
+    mid = low + (high - low) / 2;
+    value = getIndexValue(&db->movies[entries[mid]], predicate->field);
+    if (value < predicate->max ||
+        (!predicate->maxOpen && value == predicate->max)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  *last = low;
+}
+
+/* Count movies matching a range predicate - O(log n) */
+int countInRange(const MovieDatabase *db, const RangePredicate *predicate) {
+  int first, last;
+
+  findIndexRange(db, predicate, &first, &last);
+  return last - first;
+}
+
+/* Initialise an inclusive range predicate */
+void initRangePredicate(RangePredicate *predicate, IndexField field,
+                        double min, double max) {
+  predicate->field = field;
+  predicate->min = min;
+  predicate->max = max;
+  predicate->minOpen = 0;
+  predicate->maxOpen = 0;
+}
+
+/* Check a single movie against a range predicate */
+int matchesRange(const Movie *movie, const RangePredicate *predicate) {
+  double value = getIndexValue(movie, predicate->field);
+
+  if (value < predicate->min ||
+      (predicate->minOpen && value == predicate->min)) {
+    return 0;
+  }
+  if (value > predicate->max ||
+      (predicate->maxOpen && value == predicate->max)) {
+    return 0;
+  }
+  return 1;
+}
+
+/* Search movies matching all range predicates. The most selective
+   predicate is resolved through its index; the others are checked
+   only against the contiguous slice it yields. */
+int searchByRanges(const MovieDatabase *db, const RangePredicate *predicates,
+                   int predicateCount, int *results, int maxResults) {
+  int best = 0, bestCount, rangeCount;
+  int first, last;
+  int i, j, position, count = 0;
+
+  if (db == NULL || predicates == NULL || results == NULL ||
+      predicateCount <= 0) {
+    return 0;
+  }
+
+  bestCount = countInRange(db, &predicates[0]);
+  for (i = 1; i < predicateCount; i++) {
+    rangeCount = countInRange(db, &predicates[i]);
+    if (rangeCount < bestCount) {
+      best = i;
+      bestCount = rangeCount;
+    }
+  }
+
+  findIndexRange(db, &predicates[best], &first, &last);
+
+  for (i = first; i < last && count < maxResults; i++) {
+    position = db->indexes.byField[predicates[best].field][i];
+
+    for (j = 0; j < predicateCount; j++) {
+      if (j != best && !matchesRange(&db->movies[position], &predicates[j])) {
+        break;
+      }
+    }
+
+    if (j == predicateCount) {
+      results[count++] = position;
+    }
+  }
+
+  return count;
+}
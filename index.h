@@ -0,0 +1,33 @@
+#ifndef INDEX_H
+#define INDEX_H
+
+#include "types.h"
+
+/* Index maintenance - called by the movie CRUD operations */
+void rebuildIndexes(MovieDatabase *db);
+void indexInsertMovie(MovieDatabase *db, int position);
+void indexRemoveMovie(MovieDatabase *db, int position);
+void indexUpdateMovie(MovieDatabase *db, int position);
+
+/* Index field helpers */
+const char *getIndexFieldName(IndexField field);
+double getIndexValue(const Movie *movie, IndexField field);
+
+/* Position of the movie with a code (binary search), or -1 */
+int findPositionByCode(const MovieDatabase *db, int code);
+
+/* Initialise an inclusive range predicate */
+void initRangePredicate(RangePredicate *predicate, IndexField field,
+                        double min, double max);
+int matchesRange(const Movie *movie, const RangePredicate *predicate);
+
+/* Range lookups - [*first, *last) slice of db->indexes.byField[field] */
+void findIndexRange(const MovieDatabase *db, const RangePredicate *predicate,
+                    int *first, int *last);
+int countInRange(const MovieDatabase *db, const RangePredicate *predicate);
+
+/* Conjunctive range search - returns array of indices */
+int searchByRanges(const MovieDatabase *db, const RangePredicate *predicates,
+                   int predicateCount, int *results, int maxResults);
+
+#endif /* INDEX_H */
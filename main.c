@@ -1,8 +1,24 @@
+#include "actorgraph.h"
+#include "analytics.h"
+#include "bgimport.h"
+#include "columnar.h"
 #include "display.h"
 #include "fileio.h"
+#include "fuzzy.h"
+#include "index.h"
+#include "memreport.h"
 #include "movie.h"
+#include "ndjson.h"
+#include "query.h"
+#include "querycache.h"
+#include "ranking.h"
+#include "shard.h"
+#include "similar.h"
+#include "textstore.h"
+#include "threadpool.h"
 #include "types.h"
 #include "utils.h"
+#include "watch.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -18,23 +34,67 @@ void handleDeleteMovie(MovieDatabase *db);
 void handleClearMovies(MovieDatabase *db);
 void handleImportMovies(MovieDatabase *db);
 void handleExportMovies(MovieDatabase *db);
+void handleTopMovies(MovieDatabase *db);
+void handleReports(MovieDatabase *db);
+void handleTextStorage(MovieDatabase *db);
+void handleBulkEdit(MovieDatabase *db);
+void handleBulkDelete(MovieDatabase *db);
+void handleActorConnections(MovieDatabase *db);
+void handleBackgroundImport(MovieDatabase *db);
+void handleWatchFile(MovieDatabase *db);
+static int readRangePredicates(RangePredicate *predicates);
+
+static int runSimpleSearch(const MovieDatabase *db, SearchType type,
+                           const char *term, Genre genre, int *results);
+static void showSearchCacheStats(void);
+static int hasExtension(const char *filename, const char *extension);
+static int isJsonLinesFile(const char *filename);
+static int isColumnarFile(const char *filename);
+static int isGzipFile(const char *filename);
+
+/* Partitioning used to fan simple searches out over worker threads */
+static ShardSet searchShardSet;
+
+/* Recent title, genre, director and actor search results */
+static QueryCache searchCache;
+
+/* Posting lists behind "more like this", rebuilt after changes */
+static SimilarityIndex similarIndex;
+
+/* Co-star graph behind the degrees-of-separation queries */
+static ActorGraph actorGraph;
 
 int main(void) {
   static MovieDatabase db; /* Static storage - too large for stack */
   int choice;
   int running = 1;
+  ImportProgress importProgress;
+  WatchStatus watchStatus;
 
   /* Initialise database */
   initDatabase(&db);
+  initShardSet(&searchShardSet, SHARD_BY_RANGE, DEFAULT_SHARDS);
+  initQueryCache(&searchCache);
+  initSimilarityIndex(&similarIndex);
+  initActorGraph(&actorGraph);
 
   /* Main program loop */
   while (running) {
+    reapBackgroundImport();
     clearScreen();
+    getImportProgress(&importProgress);
+    displayImportStatusLine(&importProgress);
+    getWatchStatus(&watchStatus);
+    displayWatchStatusLine(&watchStatus);
     showMainMenu();
 
-    choice = readInteger("\nEnter your choice: ", 0, 9);
+    choice = readInteger("\nEnter your choice: ", 0, 17);
     printf("\n");
 
+    /* Held for the whole action, a background import commits between
+       actions (including while the menu waits for input) */
+    lockDatabase();
+    checkWatchedFile(&db);
     switch (choice) {
     case 1:
       handleListMovies(&db);
@@ -72,6 +132,38 @@ int main(void) {
       handleExportMovies(&db);
       break;
 
+    case 10:
+      handleTopMovies(&db);
+      break;
+
+    case 11:
+      handleReports(&db);
+      break;
+
+    case 12:
+      handleTextStorage(&db);
+      break;
+
+    case 13:
+      handleBulkEdit(&db);
+      break;
+
+    case 14:
+      handleBulkDelete(&db);
+      break;
+
+    case 15:
+      handleActorConnections(&db);
+      break;
+
+    case 16:
+      handleBackgroundImport(&db);
+      break;
+
+    case 17:
+      handleWatchFile(&db);
+      break;
+
     case 0:
       if (readConfirmation("Are you sure you want to exit?")) {
         printf("Thank you for using CineMania!\n");
@@ -84,8 +176,17 @@ int main(void) {
       pauseScreen();
       break;
     }
+    unlockDatabase();
   }
 
+  stopBackgroundImport();
+  stopWatch();
+  freeQueryCache(&searchCache);
+  freeSimilarityIndex(&similarIndex);
+  freeActorGraph(&actorGraph);
+  freeShardSet(&searchShardSet);
+  freeFuzzyIndex();
+  shutdownThreadPool();
   return 0;
 }
 
@@ -99,8 +200,16 @@ void showMainMenu(void) {
   printf("5. Edit movie\n");
   printf("6. Delete movie\n");
   printf("7. Clear all movies\n");
-  printf("8. Import movies from CSV file\n");
-  printf("9. Export movies to CSV file\n");
+  printf("8. Import movies from file (CSV or CSV.gz, NDJSON, columnar)\n");
+  printf("9. Export movies to file (CSV or CSV.gz, NDJSON, columnar)\n");
+  printf("10. Top movies (rating, revenue, favorites, duration)\n");
+  printf("11. Reports (stats by genre, director, decade, year; memory)\n");
+  printf("12. Description storage (compression)\n");
+  printf("13. Apply edit file (bulk edit)\n");
+  printf("14. Bulk delete (genre, year range, director, codes)\n");
+  printf("15. Actor connections (degrees of separation)\n");
+  printf("16. Background import (progress, cancel)\n");
+  printf("17. Watch a CSV file for changes\n");
   printf("0. Exit\n");
   printLine(80);
 }
@@ -127,6 +236,14 @@ void handleSearchMovies(MovieDatabase *db) {
   int resultCount = 0;
   Genre genre;
   int genreChoice;
+  RangePredicate predicates[INDEX_FIELD_COUNT];
+  int predicateCount;
+  static Query query; /* Static storage - holds prepared patterns */
+  char queryText[MAX_DESCRIPTION_LENGTH];
+  FuzzyMatch matches[FUZZY_MATCH_LIMIT];
+  FuzzyStats stats;
+  int matchCount, i;
+  SearchType nameType;
 
   clearScreen();
 
@@ -142,15 +259,26 @@ void handleSearchMovies(MovieDatabase *db) {
   printf("2. Genre\n");
   printf("3. Director\n");
   printf("4. Actor\n");
+  printf("5. Numeric ranges (year, rating, duration, revenue)\n");
+  printf("6. Compound query (AND / OR)\n");
+  printf("7. Director (typo tolerant)\n");
+  printf("8. Actor (typo tolerant)\n");
+  printf("9. Search cache statistics\n");
   printf("0. Cancel\n");
   printLine(50);
 
-  searchType = readInteger("Choice: ", 0, 4);
+  searchType = readInteger("Choice: ", 0, 9);
 
   if (searchType == 0) {
     return;
   }
 
+  if (searchType == 9) {
+    showSearchCacheStats();
+    pauseScreen();
+    return;
+  }
+
   printf("\n");
 
   switch (searchType) {
@@ -161,14 +289,15 @@ void handleSearchMovies(MovieDatabase *db) {
       pauseScreen();
       return;
     }
-    resultCount = searchByTitle(db, searchTerm, results, MAX_MOVIES);
+    resultCount =
+        runSimpleSearch(db, SEARCH_BY_TITLE, searchTerm, GENRE_NONE, results);
     break;
 
   case 2: /* Search by genre */
     printGenreList();
     genreChoice = readInteger("\nSelect genre (1-20): ", 1, 20);
     genre = (Genre)(genreChoice - 1);
-    resultCount = searchByGenre(db, genre, results, MAX_MOVIES);
+    resultCount = runSimpleSearch(db, SEARCH_BY_GENRE, NULL, genre, results);
     break;
 
   case 3: /* Search by director */
@@ -178,7 +307,8 @@ void handleSearchMovies(MovieDatabase *db) {
       pauseScreen();
       return;
     }
-    resultCount = searchByDirector(db, searchTerm, results, MAX_MOVIES);
+    resultCount = runSimpleSearch(db, SEARCH_BY_DIRECTOR, searchTerm,
+                                  GENRE_NONE, results);
     break;
 
   case 4: /* Search by actor */
@@ -188,7 +318,57 @@ void handleSearchMovies(MovieDatabase *db) {
       pauseScreen();
       return;
     }
-    resultCount = searchByActor(db, searchTerm, results, MAX_MOVIES);
+    resultCount =
+        runSimpleSearch(db, SEARCH_BY_ACTOR, searchTerm, GENRE_NONE, results);
+    break;
+
+  case 5: /* Search by numeric ranges */
+    predicateCount = readRangePredicates(predicates);
+    if (predicateCount == 0) {
+      printf("At least one range is required.\n");
+      pauseScreen();
+      return;
+    }
+    resultCount =
+        searchByRanges(db, predicates, predicateCount, results, MAX_MOVIES);
+    break;
+
+  case 6: /* Compound query */
+    printQueryHelp();
+    readString("\nQuery: ", queryText, MAX_DESCRIPTION_LENGTH);
+    if (!parseQuery(queryText, &query)) {
+      printf("Error: %s\n", query.error);
+      pauseScreen();
+      return;
+    }
+    printf("\n");
+    printQueryPlan(db, &query);
+    resultCount = executeQuery(db, &query, results, MAX_MOVIES);
+    break;
+
+  case 7: /* Fuzzy director search */
+  case 8: /* Fuzzy actor search */
+    nameType = (searchType == 7) ? SEARCH_BY_DIRECTOR : SEARCH_BY_ACTOR;
+    readString(nameType == SEARCH_BY_DIRECTOR ? "Enter director name: "
+                                              : "Enter actor name: ",
+               searchTerm, MAX_STRING_LENGTH);
+    if (strlen(searchTerm) == 0) {
+      printf("Name cannot be empty.\n");
+      pauseScreen();
+      return;
+    }
+    matchCount = fuzzySearchNames(db, nameType, searchTerm,
+                                  getDefaultMaxDistance(searchTerm), matches,
+                                  FUZZY_MATCH_LIMIT, &stats);
+
+    printf("\nClosest names (examined %d of %d):\n", stats.examined,
+           stats.dictionarySize);
+    for (i = 0; i < matchCount; i++) {
+      printf("  %-40s (distance %d)\n",
+             getFuzzyMatchName(nameType, &matches[i]), matches[i].distance);
+    }
+    resultCount = collectFuzzyMatchMovies(db, nameType, matches, matchCount,
+                                          results, MAX_MOVIES);
     break;
 
   default:
@@ -201,6 +381,16 @@ void handleSearchMovies(MovieDatabase *db) {
 
   if (resultCount > 0) {
     displaySearchResults(db, results, resultCount);
+
+    if (readConfirmation("\nSave these results to a file?")) {
+      readString("Enter filename (- for standard output): ", searchTerm,
+                 MAX_STRING_LENGTH);
+      if (strlen(searchTerm) == 0) {
+        printf("Filename cannot be empty.\n");
+      } else {
+        saveSearchResults(db, results, resultCount, searchTerm);
+      }
+    }
   } else {
     printf("No movies found.\n");
   }
@@ -208,10 +398,87 @@ void handleSearchMovies(MovieDatabase *db) {
   pauseScreen();
 }
 
+/* Title, genre, director or actor search - served from the cache when
+   the same search already ran against the current database version,
+   otherwise fanned out over the shards. Results are in title order */
+static int runSimpleSearch(const MovieDatabase *db, SearchType type,
+                           const char *term, Genre genre, int *results) {
+  ShardQuery query;
+  const char *key = (type == SEARCH_BY_GENRE) ? getGenreName(genre) : term;
+  int count;
+
+  count = lookupQueryCache(&searchCache, db, type, key, results, MAX_MOVIES);
+  if (count >= 0) {
+    printf("(cached result)\n");
+    return count;
+  }
+
+  prepareShardQuery(&query, type, term, genre);
+  count = searchShards(&searchShardSet, db, &query, results, MAX_MOVIES);
+  storeQueryCache(&searchCache, db, type, key, results, count);
+  return count;
+}
+
+/* Print search cache hit and miss rates */
+static void showSearchCacheStats(void) {
+  long lookups = searchCache.hits + searchCache.misses;
+
+  printHeader("Search Cache");
+  printf("Entries:        %d of %d\n", getQueryCacheEntryCount(&searchCache),
+         QUERY_CACHE_SIZE);
+  printf("Lookups:        %ld\n", lookups);
+  printf("Hits:           %ld (%.1f%%)\n", searchCache.hits,
+         lookups > 0 ? 100.0 * searchCache.hits / lookups : 0.0);
+  printf("Misses:         %ld (%.1f%%)\n", searchCache.misses,
+         lookups > 0 ? 100.0 * searchCache.misses / lookups : 0.0);
+  printf("Invalidations:  %ld (database changed)\n",
+         searchCache.invalidations);
+  printf("Evictions:      %ld (least recently used)\n",
+         searchCache.evictions);
+}
+
+/* Prompt for the numeric range filters, returns number of predicates */
+static int readRangePredicates(RangePredicate *predicates) {
+  int count = 0;
+  int fromYear;
+  double min;
+
+  fromYear = readInteger("Year from (0 to skip): ", 0, MAX_YEAR);
+  if (fromYear != 0) {
+    initRangePredicate(&predicates[count++], INDEX_YEAR, fromYear,
+                       readInteger("Year to: ", fromYear, MAX_YEAR));
+  }
+
+  if (readConfirmation("Filter by rating?")) {
+    min = readFloat("Minimum rating (0-10): ", 0.0f, 10.0f);
+    initRangePredicate(
+        &predicates[count++], INDEX_RATING, min,
+        readFloat("Maximum rating (0-10): ", (float)min, 10.0f));
+  }
+
+  if (readConfirmation("Filter by duration?")) {
+    min = readInteger("Minimum duration (minutes): ", 1, 600);
+    initRangePredicate(
+        &predicates[count++], INDEX_DURATION, min,
+        readInteger("Maximum duration (minutes): ", (int)min, 600));
+  }
+
+  if (readConfirmation("Filter by revenue?")) {
+    min = readFloat("Minimum revenue (millions): ", 0.0f, 999999.0f);
+    initRangePredicate(
+        &predicates[count++], INDEX_REVENUE, min,
+        readFloat("Maximum revenue (millions): ", (float)min, 999999.0f));
+  }
+
+  return count;
+}
+
 /* Menu option 3: View movie details */
 void handleViewMovie(MovieDatabase *db) {
+  SimilarMovie similar[SIMILAR_MOVIES_SHOWN];
   int code;
   int index;
+  int count;
 
   clearScreen();
 
@@ -229,7 +496,18 @@ void handleViewMovie(MovieDatabase *db) {
     printf("\nMovie with code %d not found.\n", code);
   } else {
     printf("\n");
-    displayMovieDetails(&db->movies[index]);
+    displayMovieDetails(db, &db->movies[index]);
+
+    if (db->count > 1 && readConfirmation("\nShow similar movies?")) {
+      count = findSimilarMovies(&similarIndex, db, index, similar,
+                                SIMILAR_MOVIES_SHOWN);
+      if (count < 0) {
+        printf("Error: Memory allocation failed.\n");
+      } else {
+        printf("\n");
+        displaySimilarMovies(db, similar, count);
+      }
+    }
   }
 
   pauseScreen();
@@ -349,7 +627,36 @@ void handleClearMovies(MovieDatabase *db) {
   pauseScreen();
 }
 
-/* Menu option 8: Import movies from CSV */
+/* Check if a filename ends with the given extension (case insensitive) */
+static int hasExtension(const char *filename, const char *extension) {
+  char lowerName[MAX_STRING_LENGTH];
+  size_t nameLength = strlen(filename);
+  size_t extensionLength = strlen(extension);
+
+  if (nameLength < extensionLength) {
+    return 0;
+  }
+  toLowerString(lowerName, filename);
+  return strcmp(lowerName + nameLength - extensionLength, extension) == 0;
+}
+
+/* Files named *.ndjson or *.jsonl hold one JSON movie per line */
+static int isJsonLinesFile(const char *filename) {
+  return hasExtension(filename, ".ndjson") || hasExtension(filename, ".jsonl");
+}
+
+/* Files named *.cmcol hold the columnar binary format */
+static int isColumnarFile(const char *filename) {
+  return hasExtension(filename, ".cmcol");
+}
+
+/* Files named *.gz are written as gzip-compressed CSV */
+static int isGzipFile(const char *filename) {
+  return hasExtension(filename, ".gz");
+}
+
+/* Menu option 8: Import movies from CSV (plain or gzip), NDJSON or columnar
+   files */
 void handleImportMovies(MovieDatabase *db) {
   char filename[MAX_STRING_LENGTH];
 
@@ -359,7 +666,8 @@ void handleImportMovies(MovieDatabase *db) {
   printf("Current number of movies: %d\n", db->count);
   printf("Available space: %d\n\n", MAX_MOVIES - db->count);
 
-  readString("Enter CSV filename (or path): ", filename, MAX_STRING_LENGTH);
+  readString("Enter filename (.csv[.gz], .ndjson/.jsonl or .cmcol): ",
+             filename, MAX_STRING_LENGTH);
 
   if (strlen(filename) == 0) {
     printf("Filename cannot be empty.\n");
@@ -368,12 +676,24 @@ void handleImportMovies(MovieDatabase *db) {
   }
 
   printf("\n");
-  importMoviesFromCSV(db, filename);
+  if (isJsonLinesFile(filename)) {
+    importMoviesFromNDJSON(db, filename);
+  } else if (isColumnarFile(filename)) {
+    importMoviesFromColumnar(db, filename);
+  } else if (isBackgroundImportAvailable() &&
+             readConfirmation("Import in the background?")) {
+    if (startBackgroundImport(db, filename)) {
+      printf("Import started, follow or cancel it with option 16.\n");
+    }
+  } else {
+    importMoviesFromCSV(db, filename);
+  }
 
   pauseScreen();
 }
 
-/* Menu option 9: Export movies to CSV */
+/* Menu option 9: Export movies to CSV (plain or gzip), NDJSON or columnar
+   files */
 void handleExportMovies(MovieDatabase *db) {
   char filename[MAX_STRING_LENGTH];
 
@@ -388,7 +708,8 @@ void handleExportMovies(MovieDatabase *db) {
 
   printf("Number of movies to export: %d\n\n", db->count);
 
-  readString("Enter CSV filename (or path): ", filename, MAX_STRING_LENGTH);
+  readString("Enter filename (.csv[.gz], .ndjson/.jsonl or .cmcol): ",
+             filename, MAX_STRING_LENGTH);
 
   if (strlen(filename) == 0) {
     printf("Filename cannot be empty.\n");
@@ -397,7 +718,413 @@ void handleExportMovies(MovieDatabase *db) {
   }
 
   printf("\n");
-  exportMoviesToCSV(db, filename);
+  if (isJsonLinesFile(filename)) {
+    exportMoviesToNDJSON(db, filename);
+  } else if (isColumnarFile(filename)) {
+    exportMoviesToColumnar(db, filename);
+  } else if (isGzipFile(filename)) {
+    exportMoviesToGzipCSV(db, filename);
+  } else {
+    exportMoviesToCSV(db, filename);
+  }
+
+  pauseScreen();
+}
+
+/* Menu option 10: Top-K movies by a numeric field */
+void handleTopMovies(MovieDatabase *db) {
+  int results[MAX_MOVIES];
+  int resultCount;
+  int fieldChoice;
+  int genreChoice;
+  int k;
+  RankField field;
+  RankFilter filter;
+  char title[MAX_STRING_LENGTH];
+
+  clearScreen();
+
+  if (db->count == 0) {
+    printf("No movies in database.\n");
+    pauseScreen();
+    return;
+  }
+
+  printHeader("Top Movies");
+  printf("Rank by:\n");
+  printf("1. Rating\n");
+  printf("2. Revenue\n");
+  printf("3. Favorites\n");
+  printf("4. Duration\n");
+  printf("0. Cancel\n");
+  printLine(50);
+
+  fieldChoice = readInteger("Choice: ", 0, 4);
+  if (fieldChoice == 0) {
+    return;
+  }
+  field = (RankField)(fieldChoice - 1);
+
+  k = readInteger("How many movies (K): ", 1, MAX_MOVIES);
+
+  /* Optional filters */
+  printGenreList();
+  genreChoice = readInteger("\nFilter by genre (1-20, 0 for any): ", 0, 20);
+  filter.genre = (genreChoice == 0) ? GENRE_NONE : (Genre)(genreChoice - 1);
+
+  filter.year = readInteger("Filter by year (0 for any): ", 0, MAX_YEAR);
+  if (filter.year != 0 && !isValidYear(filter.year)) {
+    printf("Error: Invalid year.\n");
+    pauseScreen();
+    return;
+  }
+
+  resultCount = topMovies(db, field, &filter, k, results);
+
+  printf("\n");
+
+  if (resultCount > 0) {
+    sprintf(title, "Top %d by %s", resultCount, getRankFieldName(field));
+    printHeader(title);
+    displayMoviesTable(db, results, resultCount, 0);
+  } else {
+    printf("No movies found.\n");
+  }
+
+  pauseScreen();
+}
+
+/* Menu option 11: Grouped statistics reports */
+void handleReports(MovieDatabase *db) {
+  AnalyticsReport report;
+  MemoryReport memory;
+  SearchStructures search;
+  int choice;
+  char title[MAX_STRING_LENGTH];
+
+  clearScreen();
+
+  printHeader("Reports");
+  printf("Group statistics by:\n");
+  printf("1. Genre\n");
+  printf("2. Director\n");
+  printf("3. Decade\n");
+  printf("4. Year\n");
+  printf("5. Memory usage (struct layout, slack, indexes, RSS)\n");
+  printf("0. Cancel\n");
+  printLine(50);
+
+  choice = readInteger("Choice: ", 0, 5);
+  if (choice == 0) {
+    return;
+  }
+
+  if (choice == 5) {
+    search.shards = &searchShardSet;
+    search.cache = &searchCache;
+    search.similar = &similarIndex;
+    search.graph = &actorGraph;
+    computeMemoryReport(db, &search, &memory);
+    printHeader("Memory Usage");
+    displayMemoryReport(&memory, db->count);
+    pauseScreen();
+    return;
+  }
+
+  if (db->count == 0) {
+    printf("No movies in database.\n");
+    pauseScreen();
+    return;
+  }
+
+  if (!computeAnalytics(db, (GroupBy)(choice - 1), &report)) {
+    pauseScreen();
+    return;
+  }
+
+  sprintf(title, "Statistics by %s", getGroupByName(report.groupBy));
+  printHeader(title);
+  displayAnalyticsReport(&report);
+  freeAnalyticsReport(&report);
 
   pauseScreen();
 }
+
+/* Menu option 12: Description storage mode and statistics */
+void handleTextStorage(MovieDatabase *db) {
+  TextStoreStats stats;
+  int choice;
+
+  clearScreen();
+  printHeader("Description Storage");
+
+  measureTextStore(db, &stats);
+  displayTextStoreStats(db, &stats);
+
+  printf("\nStore descriptions:\n");
+  printf("1. In memory, %s\n", getTextStoreModeName(TEXT_STORE_PLAIN));
+  printf("2. In memory, %s\n", getTextStoreModeName(TEXT_STORE_COMPRESSED));
+  printf("3. In a side file, %s\n", getTextStoreModeName(TEXT_STORE_DISK));
+  printf("0. Keep current mode\n");
+  printLine(50);
+
+  choice = readInteger("Choice: ", 0, 3);
+  if (choice != 0 && rebuildTextStore(db, (TextStoreMode)(choice - 1))) {
+    printf("\n");
+    measureTextStore(db, &stats);
+    displayTextStoreStats(db, &stats);
+  }
+
+  pauseScreen();
+}
+
+/* Menu option 13: Apply a file of code;field;value edits */
+void handleBulkEdit(MovieDatabase *db) {
+  char filename[MAX_STRING_LENGTH];
+
+  clearScreen();
+  printHeader("Bulk Edit");
+
+  if (db->count == 0) {
+    printf("No movies in database.\n");
+    pauseScreen();
+    return;
+  }
+
+  printf("Each line: code;field;value (e.g. 12;rating;8,1)\n");
+  printf("Editable fields: title, genres, year, duration, rating, favorite, "
+         "revenue\n\n");
+
+  readString("Enter edit filename (or path): ", filename, MAX_STRING_LENGTH);
+
+  if (strlen(filename) == 0) {
+    printf("Filename cannot be empty.\n");
+    pauseScreen();
+    return;
+  }
+
+  printf("\n");
+  applyEditFile(db, filename);
+
+  pauseScreen();
+}
+
+/* Menu option 14: Delete every movie matching a predicate */
+void handleBulkDelete(MovieDatabase *db) {
+  DeletePredicate predicate;
+  char input[MAX_STRING_LENGTH];
+  int codes[MAX_MOVIES];
+  char *token;
+  int choice, matchCount;
+
+  clearScreen();
+  printHeader("Bulk Delete");
+
+  if (db->count == 0) {
+    printf("No movies in database.\n");
+    pauseScreen();
+    return;
+  }
+
+  printf("Delete all movies:\n");
+  printf("1. Of a genre\n");
+  printf("2. Released in a year range\n");
+  printf("3. By a director\n");
+  printf("4. With the listed codes\n");
+  printf("0. Cancel\n");
+  printLine(50);
+
+  choice = readInteger("Choice: ", 0, 4);
+  if (choice == 0) {
+    return;
+  }
+
+  predicate.criterion = (DeleteCriterion)(choice - 1);
+  predicate.genre = GENRE_NONE;
+  predicate.minYear = MIN_YEAR;
+  predicate.maxYear = MAX_YEAR;
+  predicate.director = NULL;
+  predicate.codes = codes;
+  predicate.codeCount = 0;
+
+  switch (predicate.criterion) {
+  case DELETE_BY_GENRE:
+    printGenreList();
+    predicate.genre = (Genre)(readInteger("\nSelect genre (1-20): ", 1, 20) -
+                              1);
+    break;
+
+  case DELETE_BY_YEAR_RANGE:
+    predicate.minYear = readInteger("From year: ", MIN_YEAR, MAX_YEAR);
+    predicate.maxYear = readInteger("To year: ", predicate.minYear, MAX_YEAR);
+    break;
+
+  case DELETE_BY_DIRECTOR:
+    readString("Enter director name: ", input, MAX_STRING_LENGTH);
+    if (strlen(input) == 0) {
+      printf("Director name cannot be empty.\n");
+      pauseScreen();
+      return;
+    }
+    predicate.director = input;
+    break;
+
+  case DELETE_BY_CODES:
+    readString("Enter codes separated by commas: ", input, MAX_STRING_LENGTH);
+    token = strtok(input, ", ");
+    while (token != NULL && predicate.codeCount < MAX_MOVIES) {
+      codes[predicate.codeCount++] = atoi(token);
+      token = strtok(NULL, ", ");
+    }
+    break;
+  }
+
+  matchCount = countMatchingMovies(db, &predicate);
+  if (matchCount == 0) {
+    printf("\nNo movies match.\n");
+    pauseScreen();
+    return;
+  }
+
+  printf("\n%d movie(s) match.\n", matchCount);
+  if (readConfirmation("Are you sure you want to delete them?")) {
+    printf("%d movie(s) deleted successfully.\n",
+           deleteMatchingMovies(db, &predicate));
+  } else {
+    printf("Deletion cancelled.\n");
+  }
+
+  pauseScreen();
+}
+
+/* Menu option 15: Shortest co-star chain between two actors */
+void handleActorConnections(MovieDatabase *db) {
+  int actors[MAX_PATH_ACTORS];
+  int movies[MAX_PATH_ACTORS];
+  char first[MAX_STRING_LENGTH];
+  char second[MAX_STRING_LENGTH];
+  int firstId, secondId, count;
+
+  clearScreen();
+  printHeader("Actor Connections");
+
+  if (db->count == 0) {
+    printf("No movies in database.\n");
+    pauseScreen();
+    return;
+  }
+
+  if (!prepareActorGraph(&actorGraph, db)) {
+    printf("Error: Memory allocation failed.\n");
+    pauseScreen();
+    return;
+  }
+
+  readString("Enter first actor: ", first, MAX_STRING_LENGTH);
+  readString("Enter second actor: ", second, MAX_STRING_LENGTH);
+
+  firstId = findNameId(&actorGraph.actors, first);
+  secondId = findNameId(&actorGraph.actors, second);
+  printf("\n");
+  if (firstId == -1 || secondId == -1) {
+    printf("Actor '%s' not found.\n", firstId == -1 ? first : second);
+    pauseScreen();
+    return;
+  }
+
+  count = findActorPath(&actorGraph, firstId, secondId, actors, movies,
+                        MAX_PATH_ACTORS);
+  if (count == 0) {
+    printf("%s and %s are not connected.\n", first, second);
+  } else if (count < 0) {
+    printf("The connection is longer than %d actors.\n", MAX_PATH_ACTORS);
+  } else {
+    displayActorPath(db, &actorGraph, actors, movies, count);
+  }
+
+  pauseScreen();
+}
+
+/* Menu option 16: Follow or cancel the background import */
+void handleBackgroundImport(MovieDatabase *db) {
+  ImportProgress progress;
+  int choice;
+
+  do {
+    clearScreen();
+    getImportProgress(&progress);
+    displayImportProgress(&progress);
+
+    if (progress.state != IMPORT_RUNNING) {
+      pauseScreen();
+      return;
+    }
+
+    printf("\n1. Refresh\n");
+    printf("2. Cancel, keep the movies added so far\n");
+    printf("3. Cancel and roll back the movies added so far\n");
+    printf("0. Back\n");
+    /* Let batches land while waiting, like the main menu does */
+    unlockDatabase();
+    choice = readInteger("Choice: ", 0, 3);
+    lockDatabase();
+
+    if (choice == 2 || choice == 3) {
+      if (cancelBackgroundImport(db, choice == 3)) {
+        printf("\nImport cancelled%s.\n",
+               choice == 3 ? ", added movies removed" : "");
+      } else {
+        printf("\nThe import had already ended.\n");
+      }
+      pauseScreen();
+      return;
+    }
+  } while (choice == 1);
+}
+
+/* Menu option 17: Keep the database in step with a CSV file */
+void handleWatchFile(MovieDatabase *db) {
+  char filename[MAX_STRING_LENGTH];
+  WatchStatus status;
+  int choice;
+
+  clearScreen();
+  getWatchStatus(&status);
+
+  if (!status.active) {
+    printHeader("Watch CSV File");
+    readString("Enter filename (.csv or .csv.gz): ", filename,
+               MAX_STRING_LENGTH);
+
+    if (strlen(filename) == 0) {
+      printf("Filename cannot be empty.\n");
+      pauseScreen();
+      return;
+    }
+
+    printf("\n");
+    if (startWatch(db, filename)) {
+      getWatchStatus(&status);
+      printf("Watching '%s' (%s).\n", filename,
+             status.usingInotify ? "inotify" : "polling");
+      printf("Initial sync: %ld movies added, %ld rows rejected.\n",
+             status.added, status.rejected);
+    }
+    pauseScreen();
+    return;
+  }
+
+  displayWatchStatus(&status);
+  printf("\n1. Stop watching\n");
+  printf("0. Back\n");
+  choice = readInteger("Choice: ", 0, 1);
+
+  if (choice == 1) {
+    /* The watcher thread may be waiting for the database lock */
+    unlockDatabase();
+    stopWatch();
+    lockDatabase();
+    printf("\nStopped watching '%s'.\n", status.filename);
+    pauseScreen();
+  }
+}
@@ -0,0 +1,186 @@
+#include "memreport.h"
+#include "fuzzy.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Field name, offset and size */
+#define MOVIE_FIELD(field)                                                    \
+  {#field, (long)offsetof(Movie, field),                                      \
+   (long)sizeof(((Movie *)0)->field), 0}
+
+/* Movie fields in declaration order */
+static const FieldLayout movieFields[MOVIE_FIELD_COUNT] = {
+    MOVIE_FIELD(code),       MOVIE_FIELD(title),    MOVIE_FIELD(genres),
+    MOVIE_FIELD(genreCount), MOVIE_FIELD(description),
+    MOVIE_FIELD(director),   MOVIE_FIELD(actors),   MOVIE_FIELD(actorCount),
+    MOVIE_FIELD(year),       MOVIE_FIELD(duration), MOVIE_FIELD(rating),
+    MOVIE_FIELD(favorite),   MOVIE_FIELD(revenue)};
+
+/* Read a "Name:   123 kB" line of /proc/self/status, -1 elsewhere */
+static long readStatusKb(const char *name) {
+  char line[MAX_STRING_LENGTH];
+  FILE *file;
+  long value = -1;
+  size_t length = strlen(name);
+
+  file = fopen("/proc/self/status", "r");
+  if (file == NULL) {
+    return -1;
+  }
+
+  while (fgets(line, sizeof(line), file) != NULL) {
+    if (strncmp(line, name, length) == 0 && line[length] == ':') {
+      if (sscanf(line + length + 1, "%ld", &value) != 1) {
+        value = -1;
+      }
+      break;
+    }
+  }
+
+  fclose(file);
+  return value;
+}
+
+/* Append a component */
+static void addComponent(MemoryReport *report, const char *name,
+                         long allocated, long used) {
+  MemoryComponent *component;
+
+  if (report->componentCount >= MAX_MEMORY_COMPONENTS) {
+    return;
+  }
+
+  component = &report->components[report->componentCount++];
+  component->name = name;
+  component->allocated = allocated;
+  component->used = used;
+  report->allocatedBytes += allocated;
+  report->usedBytes += used;
+}
+
+/* Lay out the Movie fields and total their padding */
+static void measureMovieLayout(MemoryReport *report) {
+  long end;
+  int i;
+
+  report->movieSize = (long)sizeof(Movie);
+  report->paddingBytes = 0;
+
+  for (i = 0; i < MOVIE_FIELD_COUNT; i++) {
+    report->fields[i] = movieFields[i];
+    end = (i + 1 < MOVIE_FIELD_COUNT) ? movieFields[i + 1].offset
+                                      : report->movieSize;
+    report->fields[i].padding =
+        end - movieFields[i].offset - movieFields[i].size;
+    report->paddingBytes += report->fields[i].padding;
+  }
+}
+
+/* Measure the search structures built on demand from the database */
+static void measureSearchStructures(const SearchStructures *search,
+                                    MemoryReport *report) {
+  long allocated, used;
+
+  if (search->shards != NULL) {
+    allocated = getShardSetBytes(search->shards, &used);
+    addComponent(report, "Search shards", allocated, used);
+  }
+  if (search->cache != NULL) {
+    allocated = getQueryCacheBytes(search->cache, &used);
+    addComponent(report, "Query cache", allocated, used);
+  }
+
+  allocated = getFuzzyIndexBytes(&used);
+  addComponent(report, "Fuzzy name index", allocated, used);
+
+  if (search->similar != NULL) {
+    allocated = getSimilarityPostingBytes(search->similar, &used);
+    addComponent(report, "Similarity postings", allocated, used);
+    allocated = getSimilarityMovieTableBytes(search->similar, &used);
+    addComponent(report, "Similarity per movie", allocated, used);
+  }
+  if (search->graph != NULL) {
+    allocated = getActorGraphBytes(search->graph, &used);
+    addComponent(report, "Actor graph", allocated, used);
+  }
+}
+
+/* Measure the database, its search structures and the process */
+void computeMemoryReport(const MovieDatabase *db,
+                         const SearchStructures *search,
+                         MemoryReport *report) {
+  const Movie *movie;
+  const TextStore *text;
+  long titleBytes = 0, directorBytes = 0, actorBytes = 0, genreBytes = 0;
+  long scalarBytes, indexBytes, textUsed;
+  int i, j;
+
+  if (db == NULL || search == NULL || report == NULL) {
+    return;
+  }
+
+  report->componentCount = 0;
+  report->allocatedBytes = 0;
+  report->usedBytes = 0;
+  measureMovieLayout(report);
+
+  /* Bytes holding characters, terminators included */
+  for (i = 0; i < db->count; i++) {
+    movie = &db->movies[i];
+    titleBytes += (long)strlen(movie->title) + 1;
+    directorBytes += (long)strlen(movie->director) + 1;
+    for (j = 0; j < movie->actorCount; j++) {
+      actorBytes += (long)strlen(movie->actors[j]) + 1;
+    }
+    genreBytes += (long)movie->genreCount * (long)sizeof(Genre);
+  }
+
+  scalarBytes = report->movieSize - report->paddingBytes -
+                (long)sizeof(db->movies[0].title) -
+                (long)sizeof(db->movies[0].director) -
+                (long)sizeof(db->movies[0].actors) -
+                (long)sizeof(db->movies[0].genres);
+
+  addComponent(report, "Titles", (long)db->count * MAX_STRING_LENGTH,
+               titleBytes);
+  addComponent(report, "Directors", (long)db->count * MAX_STRING_LENGTH,
+               directorBytes);
+  addComponent(report, "Actors",
+               (long)db->count * (long)sizeof(db->movies[0].actors),
+               actorBytes);
+  addComponent(report, "Genres",
+               (long)db->count * (long)sizeof(db->movies[0].genres),
+               genreBytes);
+  addComponent(report, "Scalar fields", (long)db->count * scalarBytes,
+               (long)db->count * scalarBytes);
+  addComponent(report, "Struct padding",
+               (long)db->count * report->paddingBytes, 0);
+  addComponent(report, "Empty movie slots",
+               (long)(MAX_MOVIES - db->count) * report->movieSize, 0);
+
+  /* Description arena (memory modes) and its dictionary */
+  text = &db->text;
+  textUsed =
+      (text->mode == TEXT_STORE_DISK) ? 0 : text->used - text->deadBytes;
+  addComponent(report, "Description text", text->capacity, textUsed);
+  addComponent(report, "Text dictionary",
+               (long)(sizeof(text->entries) + sizeof(text->entryStart) +
+                      sizeof(text->slots)),
+               (text->entryCount > 0)
+                   ? text->entryStart[text->entryCount] +
+                         (long)(text->entryCount + 1) * (long)sizeof(int)
+                   : 0);
+
+  /* Index columns hold one entry per movie */
+  indexBytes = (long)db->count * INDEX_FIELD_COUNT * (long)sizeof(int) +
+               (long)sizeof(db->indexes.yearStart) +
+               (long)sizeof(db->indexes.genreCounts);
+  addComponent(report, "Secondary indexes", (long)sizeof(MovieIndexes),
+               (db->count > 0) ? indexBytes : 0);
+  measureSearchStructures(search, report);
+
+  report->databaseBytes = (long)sizeof(MovieDatabase);
+  report->currentRssKb = readStatusKb("VmRSS");
+  report->peakRssKb = readStatusKb("VmHWM");
+}
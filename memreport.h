@@ -0,0 +1,55 @@
+#ifndef MEMREPORT_H
+#define MEMREPORT_H
+
+#include "actorgraph.h"
+#include "querycache.h"
+#include "shard.h"
+#include "similar.h"
+#include "types.h"
+
+#define MOVIE_FIELD_COUNT 13
+#define MAX_MEMORY_COMPONENTS 18
+
+/* Placement of one Movie field */
+typedef struct {
+  const char *name;
+  long offset;  /* Byte offset in Movie */
+  long size;    /* sizeof the field */
+  long padding; /* Unused bytes before the next field (or the end) */
+} FieldLayout;
+
+/* Bytes reserved for one component against the bytes holding data */
+typedef struct {
+  const char *name;
+  long allocated;
+  long used;
+} MemoryComponent;
+
+/* Memory breakdown of a database */
+typedef struct {
+  FieldLayout fields[MOVIE_FIELD_COUNT];
+  long movieSize;    /* sizeof(Movie) */
+  long paddingBytes; /* Padding per Movie */
+  MemoryComponent components[MAX_MEMORY_COMPONENTS];
+  int componentCount;
+  long allocatedBytes; /* Sum over the components */
+  long usedBytes;
+  long databaseBytes; /* sizeof(MovieDatabase) */
+  long currentRssKb;  /* Resident set size, -1 if unknown */
+  long peakRssKb;     /* Peak resident set size, -1 if unknown */
+} MemoryReport;
+
+/* Search structures kept beside the database (NULL ones are skipped) */
+typedef struct {
+  const ShardSet *shards;
+  const QueryCache *cache;
+  const SimilarityIndex *similar;
+  const ActorGraph *graph;
+} SearchStructures;
+
+/* Measure the database, its search structures and the process */
+void computeMemoryReport(const MovieDatabase *db,
+                         const SearchStructures *search,
+                         MemoryReport *report);
+
+#endif /* MEMREPORT_H */
@@ -1,5 +1,9 @@
 #include "movie.h"
+#include "index.h"
+#include "textstore.h"
+#include "threadpool.h"
 #include "utils.h"
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,12 +18,15 @@ void initDatabase(MovieDatabase *db) {
 
   db->count = 0;
   db->nextCode = 1;
+  db->version = 0;
 
   /* Initialise all movies to safe defaults */
   for (i = 0; i < MAX_MOVIES; i++) {
     db->movies[i].code = 0;
     db->movies[i].title[0] = '\0';
-    db->movies[i].description[0] = '\0';
+    db->movies[i].description.offset = 0;
+    db->movies[i].description.length = 0;
+    db->movies[i].description.rawLength = 0;
     db->movies[i].director[0] = '\0';
     db->movies[i].year = 0;
     db->movies[i].duration = 0;
@@ -39,33 +46,38 @@ void initDatabase(MovieDatabase *db) {
       db->movies[i].actors[j][0] = '\0';
     }
   }
+
+  initTextStore(&db->text, TEXT_STORE_PLAIN);
+  rebuildIndexes(db);
 }
 
 /* Clear all movies from database */
 void clearAllMovies(MovieDatabase *db) {
+  unsigned long version;
+  TextStoreMode mode;
+
   if (db == NULL) {
     return;
   }
 
+  /* Keep the version increasing so caches of the old data stay stale */
+  version = db->version;
+  mode = db->text.mode;
+  freeTextStore(&db->text);
   initDatabase(db);
+  db->version = version + 1;
+  db->text.mode = mode;
   printf("All movies cleared successfully.\n");
 }
 
 /* Find movie index by code, returns -1 if not found */
 int findMovieByCode(const MovieDatabase *db, int code) {
-  int i;
-
   if (db == NULL) {
     return -1;
   }
 
-  for (i = 0; i < db->count; i++) {
-    if (db->movies[i].code == code) {
-      return i;
-    }
-  }
-
-  return -1;
+  /* The code index is kept in step with every change */
+  return findPositionByCode(db, code);
 }
 
 /* Check if a movie code already exists */
@@ -103,8 +115,7 @@ void copyMovie(Movie *dest, const Movie *src) {
   strncpy(dest->title, src->title, MAX_STRING_LENGTH - 1);
   dest->title[MAX_STRING_LENGTH - 1] = '\0';
 
-  strncpy(dest->description, src->description, MAX_DESCRIPTION_LENGTH - 1);
-  dest->description[MAX_DESCRIPTION_LENGTH - 1] = '\0';
+  dest->description = src->description;
 
   strncpy(dest->director, src->director, MAX_STRING_LENGTH - 1);
   dest->director[MAX_STRING_LENGTH - 1] = '\0';
@@ -129,44 +140,67 @@ void copyMovie(Movie *dest, const Movie *src) {
   }
 }
 
-/* Validate movie data */
-int validateMovieData(const Movie *movie) {
+/* Check if a movie is listed under the given genre */
+int movieHasGenre(const Movie *movie, Genre genre) {
+  int i;
+
   if (movie == NULL) {
     return 0;
   }
 
+  for (i = 0; i < movie->genreCount; i++) {
+    if (movie->genres[i] == genre) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/* Check movie data, returns NULL if valid or the reason it is not */
+const char *checkMovieData(const Movie *movie) {
   if (strlen(movie->title) == 0) {
-    printf("Error: Movie title cannot be empty.\n");
-    return 0;
+    return "Movie title cannot be empty.";
   }
 
   if (movie->genreCount <= 0 || movie->genreCount > MAX_GENRES_PER_MOVIE) {
-    printf("Error: Movie must have at least one valid genre.\n");
-    return 0;
+    return "Movie must have at least one valid genre.";
   }
 
   if (strlen(movie->director) == 0) {
-    printf("Error: Director name cannot be empty.\n");
-    return 0;
+    return "Director name cannot be empty.";
   }
 
   if (!isValidYear(movie->year)) {
-    printf("Error: Invalid year.\n");
-    return 0;
+    return "Invalid year.";
   }
 
   if (!isValidDuration(movie->duration)) {
-    printf("Error: Invalid duration.\n");
-    return 0;
+    return "Invalid duration.";
   }
 
   if (!isValidRating(movie->rating)) {
-    printf("Error: Invalid rating (must be between 0 and 10).\n");
-    return 0;
+    return "Invalid rating (must be between 0 and 10).";
   }
 
   if (!isValidRevenue(movie->revenue)) {
-    printf("Error: Invalid revenue (must be non-negative).\n");
+    return "Invalid revenue (must be non-negative).";
+  }
+
+  return NULL;
+}
+
+/* Validate movie data, printing the reason when it is invalid */
+int validateMovieData(const Movie *movie) {
+  const char *reason;
+
+  if (movie == NULL) {
+    return 0;
+  }
+
+  reason = checkMovieData(movie);
+  if (reason != NULL) {
+    printf("Error: %s\n", reason);
     return 0;
   }
 
@@ -174,7 +208,7 @@ int validateMovieData(const Movie *movie) {
 }
 
 /* Add movie to database */
-int addMovie(MovieDatabase *db, const Movie *movie) {
+int addMovie(MovieDatabase *db, const Movie *movie, const char *description) {
   if (db == NULL || movie == NULL) {
     printf("Error: Invalid database or movie.\n");
     return 0;
@@ -194,9 +228,15 @@ int addMovie(MovieDatabase *db, const Movie *movie) {
     return 0;
   }
 
-  /* Copy movie to database */
+  /* Copy movie to database, the description goes to the text store */
   copyMovie(&db->movies[db->count], movie);
+  if (!storeText(&db->text, description == NULL ? "" : description,
+                 &db->movies[db->count].description)) {
+    return 0;
+  }
   db->count++;
+  db->version++;
+  indexInsertMovie(db, db->count - 1);
 
   /* Update nextCode if necessary */
   if (movie->code >= db->nextCode) {
@@ -210,6 +250,7 @@ int addMovie(MovieDatabase *db, const Movie *movie) {
 int addMovieInteractive(MovieDatabase *db) {
   Movie newMovie;
   char buffer[MAX_DESCRIPTION_LENGTH];
+  char description[MAX_DESCRIPTION_LENGTH];
   char genreInput[MAX_STRING_LENGTH];
   char *token;
   Genre genre;
@@ -274,7 +315,7 @@ int addMovieInteractive(MovieDatabase *db) {
 
   /* Description */
   printf("\n");
-  readString("Description: ", newMovie.description, MAX_DESCRIPTION_LENGTH);
+  readString("Description: ", description, MAX_DESCRIPTION_LENGTH);
 
   /* Director */
   readString("Director: ", newMovie.director, MAX_STRING_LENGTH);
@@ -309,7 +350,7 @@ int addMovieInteractive(MovieDatabase *db) {
 
   /* Year */
   printf("\n");
-  newMovie.year = readInteger("Year: ", 1888, 2100);
+  newMovie.year = readInteger("Year: ", MIN_YEAR, MAX_YEAR);
 
   /* Duration */
   newMovie.duration = readInteger("Duration (minutes): ", 1, 600);
@@ -324,7 +365,7 @@ int addMovieInteractive(MovieDatabase *db) {
   newMovie.revenue = readFloat("Revenue (millions): ", 0.0f, 999999.0f);
 
   /* Add movie to database */
-  if (addMovie(db, &newMovie)) {
+  if (addMovie(db, &newMovie, description)) {
     printf("\nMovie added successfully with code %d!\n", newMovie.code);
     return 1;
   }
@@ -334,7 +375,7 @@ int addMovieInteractive(MovieDatabase *db) {
 
 /* Delete movie by code */
 int deleteMovie(MovieDatabase *db, int code) {
-  int index, i;
+  int index, i, compact;
 
   if (db == NULL) {
     printf("Error: Invalid database.\n");
@@ -348,12 +389,21 @@ int deleteMovie(MovieDatabase *db, int code) {
     return 0;
   }
 
+  indexRemoveMovie(db, index);
+  compact = releaseText(&db->text, &db->movies[index].description);
+
   /* Shift all movies after the deleted one */
   for (i = index; i < db->count - 1; i++) {
     copyMovie(&db->movies[i], &db->movies[i + 1]);
   }
 
   db->count--;
+  db->version++;
+
+  /* Drop deleted descriptions once they make up most of the arena */
+  if (compact) {
+    rebuildTextStore(db, db->text.mode);
+  }
 
   printf("Movie with code %d deleted successfully.\n", code);
   return 1;
@@ -408,8 +458,7 @@ int editMovie(MovieDatabase *db, int code) {
   case 1: /* Title */
     readString("New title: ", buffer, MAX_STRING_LENGTH);
     if (strlen(buffer) > 0) {
-      strncpy(movie->title, buffer, MAX_STRING_LENGTH - 1);
-      movie->title[MAX_STRING_LENGTH - 1] = '\0';
+      strcpy(movie->title, buffer);
       printf("Title updated successfully.\n");
     }
     break;
@@ -451,7 +500,7 @@ int editMovie(MovieDatabase *db, int code) {
     break;
 
   case 3: /* Year */
-    movie->year = readInteger("New year: ", 1888, 2100);
+    movie->year = readInteger("New year: ", MIN_YEAR, MAX_YEAR);
     printf("Year updated successfully.\n");
     break;
 
@@ -484,90 +533,226 @@ int editMovie(MovieDatabase *db, int code) {
     return 0;
   }
 
+  db->version++;
+  indexUpdateMovie(db, index);
   return 1;
 }
 
-/* Search movies by title substring (case insensitive) */
-int searchByTitle(const MovieDatabase *db, const char *searchTerm, int *results,
-                  int maxResults) {
+/* Movies per morsel when a scan is split across the thread pool */
+#define SCAN_MORSEL_SIZE 256
+
+/* Movie predicate used by the parallel scan */
+typedef int (*MovieMatcher)(const Movie *movie, const void *argument);
+
+/* Shared state of one parallel scan - morsel k writes its matches to
+   hits[k * SCAN_MORSEL_SIZE ...] and their number to hitCounts[k] */
+typedef struct {
+  const MovieDatabase *db;
+  MovieMatcher matches;
+  const void *argument;
+  int *hits;
+  int *hitCounts;
+} ScanContext;
+
+/* Scan one morsel of the movie array */
+static void scanMorsel(void *context, int begin, int end, int worker) {
+  ScanContext *scan = (ScanContext *)context;
   int i, count = 0;
 
-  if (db == NULL || searchTerm == NULL || results == NULL) {
+  (void)worker;
+  for (i = begin; i < end; i++) {
+    if (scan->matches(&scan->db->movies[i], scan->argument)) {
+      scan->hits[begin + count++] = i;
+    }
+  }
+  scan->hitCounts[begin / SCAN_MORSEL_SIZE] = count;
+}
+
+/* Test every movie on the thread pool, then concatenate the per-morsel
+   matches in morsel order - the result is in index order, exactly as a
+   sequential scan would produce it */
+static int scanMovies(const MovieDatabase *db, MovieMatcher matches,
+                      const void *argument, int *results, int maxResults) {
+  ScanContext scan;
+  int morsel, morselCount, i, count = 0;
+
+  if (db->count == 0) {
+    return 0;
+  }
+
+  morselCount = (db->count + SCAN_MORSEL_SIZE - 1) / SCAN_MORSEL_SIZE;
+  scan.db = db;
+  scan.matches = matches;
+  scan.argument = argument;
+  scan.hits = (int *)malloc(db->count * sizeof(int));
+  scan.hitCounts = (int *)malloc(morselCount * sizeof(int));
+  if (scan.hits == NULL || scan.hitCounts == NULL) {
+    free(scan.hits);
+    free(scan.hitCounts);
+    printf("Error: Memory allocation failed.\n");
     return 0;
   }
 
-  for (i = 0; i < db->count && count < maxResults; i++) {
-    if (containsSubstring(db->movies[i].title, searchTerm)) {
-      results[count++] = i;
+  parallelFor(db->count, SCAN_MORSEL_SIZE, scanMorsel, &scan);
+
+  for (morsel = 0; morsel < morselCount && count < maxResults; morsel++) {
+    for (i = 0; i < scan.hitCounts[morsel] && count < maxResults; i++) {
+      results[count++] = scan.hits[morsel * SCAN_MORSEL_SIZE + i];
     }
   }
 
+  free(scan.hits);
+  free(scan.hitCounts);
   return count;
 }
 
-/* Search movies by genre */
-int searchByGenre(const MovieDatabase *db, Genre genre, int *results,
-                  int maxResults) {
-  int i, j, count = 0;
+/* Movie is listed under the genre */
+static int genreMatches(const Movie *movie, const void *argument) {
+  return movieHasGenre(movie, *(const Genre *)argument);
+}
+
+/* Director equals the lowercased name */
+static int directorMatches(const Movie *movie, const void *argument) {
+  char lowerDirector[MAX_STRING_LENGTH];
+
+  toLowerString(lowerDirector, movie->director);
+  return strcmp(lowerDirector, (const char *)argument) == 0;
+}
+
+/* Release year within the predicate's range */
+static int yearMatches(const Movie *movie, const void *argument) {
+  const DeletePredicate *predicate = (const DeletePredicate *)argument;
 
-  if (db == NULL || results == NULL || genre == GENRE_NONE) {
+  return movie->year >= predicate->minYear &&
+         movie->year <= predicate->maxYear;
+}
+
+/* Mark the positions matched by a delete predicate, returns their number */
+static int markMatchingMovies(const MovieDatabase *db,
+                              const DeletePredicate *predicate,
+                              unsigned char *marked) {
+  char lowerDirector[MAX_STRING_LENGTH];
+  int *hits;
+  int i, position, hitCount = 0, markedCount = 0;
+
+  if (predicate->criterion == DELETE_BY_CODES) {
+    for (i = 0; i < predicate->codeCount; i++) {
+      position = findMovieByCode(db, predicate->codes[i]);
+      if (position != -1 && !marked[position]) {
+        marked[position] = 1;
+        markedCount++;
+      }
+    }
+    return markedCount;
+  }
+
+  hits = (int *)malloc((db->count + 1) * sizeof(int));
+  if (hits == NULL) {
+    printf("Error: Memory allocation failed.\n");
     return 0;
   }
 
-  for (i = 0; i < db->count && count < maxResults; i++) {
-    for (j = 0; j < db->movies[i].genreCount; j++) {
-      if (db->movies[i].genres[j] == genre) {
-        results[count++] = i;
-        break;
-      }
+  switch (predicate->criterion) {
+  case DELETE_BY_GENRE:
+    if (predicate->genre != GENRE_NONE) {
+      hitCount = scanMovies(db, genreMatches, &predicate->genre, hits,
+                            db->count);
+    }
+    break;
+  case DELETE_BY_YEAR_RANGE:
+    hitCount = scanMovies(db, yearMatches, predicate, hits, db->count);
+    break;
+  case DELETE_BY_DIRECTOR:
+    if (predicate->director != NULL) {
+      toLowerString(lowerDirector, predicate->director);
+      hitCount =
+          scanMovies(db, directorMatches, lowerDirector, hits, db->count);
     }
+    break;
+  default:
+    break;
   }
 
-  return count;
+  for (i = 0; i < hitCount; i++) {
+    marked[hits[i]] = 1;
+  }
+
+  free(hits);
+  return hitCount;
 }
 
-/* Search movies by director (case insensitive) */
-int searchByDirector(const MovieDatabase *db, const char *director,
-                     int *results, int maxResults) {
-  int i, count = 0;
-  char lowerDirector[MAX_STRING_LENGTH];
-  char lowerSearchDirector[MAX_STRING_LENGTH];
+/* Number of movies a bulk delete would remove */
+int countMatchingMovies(const MovieDatabase *db,
+                        const DeletePredicate *predicate) {
+  unsigned char *marked;
+  int count;
 
-  if (db == NULL || director == NULL || results == NULL) {
+  if (db == NULL || predicate == NULL || db->count == 0) {
     return 0;
   }
 
-  toLowerString(lowerSearchDirector, director);
-
-  for (i = 0; i < db->count && count < maxResults; i++) {
-    toLowerString(lowerDirector, db->movies[i].director);
-    if (strcmp(lowerDirector, lowerSearchDirector) == 0) {
-      results[count++] = i;
-    }
+  marked = (unsigned char *)calloc(db->count, 1);
+  if (marked == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
   }
 
+  count = markMatchingMovies(db, predicate, marked);
+  free(marked);
   return count;
 }
 
-/* Search movies by actor (case insensitive) */
-int searchByActor(const MovieDatabase *db, const char *actor, int *results,
-                  int maxResults) {
-  int i, j, count = 0;
+/* Delete every movie matching the predicate: mark, then compact the array
+   in one stable pass and rebuild the indexes once */
+int deleteMatchingMovies(MovieDatabase *db,
+                         const DeletePredicate *predicate) {
+  unsigned char *marked;
+  int read, write = 0, deleted, compact = 0;
+
+  if (db == NULL || predicate == NULL) {
+    printf("Error: Invalid parameters.\n");
+    return 0;
+  }
+
+  if (db->count == 0) {
+    return 0;
+  }
+
+  marked = (unsigned char *)calloc(db->count, 1);
+  if (marked == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
 
-  if (db == NULL || actor == NULL || results == NULL) {
+  deleted = markMatchingMovies(db, predicate, marked);
+  if (deleted == 0) {
+    free(marked);
     return 0;
   }
 
-  for (i = 0; i < db->count && count < maxResults; i++) {
-    for (j = 0; j < db->movies[i].actorCount; j++) {
-      if (containsSubstring(db->movies[i].actors[j], actor)) {
-        results[count++] = i;
-        break;
+  /* Survivors keep their relative order */
+  for (read = 0; read < db->count; read++) {
+    if (marked[read]) {
+      compact |= releaseText(&db->text, &db->movies[read].description);
+    } else {
+      if (write != read) {
+        copyMovie(&db->movies[write], &db->movies[read]);
       }
+      write++;
     }
   }
 
-  return count;
+  free(marked);
+  db->count = write;
+  db->version++;
+  rebuildIndexes(db);
+
+  /* Drop deleted descriptions once they make up most of the arena */
+  if (compact) {
+    rebuildTextStore(db, db->text.mode);
+  }
+
+  return deleted;
 }
 
 /* Comparison function for qsort - ascending order */
@@ -595,6 +780,10 @@ void sortMoviesByCode(MovieDatabase *db, SortOrder order) {
   } else {
     qsort(db->movies, db->count, sizeof(Movie), compareMoviesByCodeDesc);
   }
+
+  /* Positions changed - secondary indexes must be rebuilt */
+  db->version++;
+  rebuildIndexes(db);
 }
 
 /* Helper structure for sorting indices by title */
@@ -603,28 +792,120 @@ typedef struct {
   const char *title;
 } IndexTitlePair;
 
+/* Case-insensitive title order, ties broken by position so the order is
+   fully determined (qsort is not stable) */
+static int compareTitleText(const char *titleA, int indexA,
+                            const char *titleB, int indexB) {
+  int a, b;
+
+  do {
+    a = tolower((unsigned char)*titleA++);
+    b = tolower((unsigned char)*titleB++);
+  } while (a == b && a != '\0');
+
+  if (a != b) {
+    return a - b;
+  }
+  return (indexA > indexB) - (indexA < indexB);
+}
+
 /* Comparison function for sorting by title */
 static int compareByTitle(const void *a, const void *b) {
   const IndexTitlePair *pairA = (const IndexTitlePair *)a;
   const IndexTitlePair *pairB = (const IndexTitlePair *)b;
-  char lowerA[MAX_STRING_LENGTH];
-  char lowerB[MAX_STRING_LENGTH];
 
-  toLowerString(lowerA, pairA->title);
-  toLowerString(lowerB, pairB->title);
+  return compareTitleText(pairA->title, pairA->index, pairB->title,
+                          pairB->index);
+}
 
-  return strcmp(lowerA, lowerB);
+/* Compare two movies in the order sortMoviesByTitle produces */
+int compareMovieTitles(const MovieDatabase *db, int indexA, int indexB) {
+  return compareTitleText(db->movies[indexA].title, indexA,
+                          db->movies[indexB].title, indexB);
+}
+
+/* Below this many entries a single qsort beats splitting the work */
+#define PARALLEL_SORT_MIN 1024
+
+/* Shared state of a parallel merge sort - run r spans
+   [runStart[r], runStart[r + 1]) of source */
+typedef struct {
+  IndexTitlePair *source;
+  IndexTitlePair *target;
+  int runStart[MAX_POOL_THREADS + 1];
+  int runCount;
+} MergeSortContext;
+
+/* Start of run r, or the end of the data past the last run */
+static int runBoundary(const MergeSortContext *sort, int run) {
+  return sort->runStart[run < sort->runCount ? run : sort->runCount];
+}
+
+/* Sort individual runs in place */
+static void sortRuns(void *context, int begin, int end, int worker) {
+  MergeSortContext *sort = (MergeSortContext *)context;
+  int run;
+
+  (void)worker;
+  for (run = begin; run < end; run++) {
+    qsort(sort->source + sort->runStart[run],
+          sort->runStart[run + 1] - sort->runStart[run],
+          sizeof(IndexTitlePair), compareByTitle);
+  }
+}
+
+/* Merge runs 2p and 2p + 1 from source into target (a lone last run is
+   copied) */
+static void mergeRunPairs(void *context, int begin, int end, int worker) {
+  MergeSortContext *sort = (MergeSortContext *)context;
+  int pair, left, middle, right, i, j, k;
+
+  (void)worker;
+  for (pair = begin; pair < end; pair++) {
+    left = runBoundary(sort, 2 * pair);
+    middle = runBoundary(sort, 2 * pair + 1);
+    right = runBoundary(sort, 2 * pair + 2);
+    i = left;
+    j = middle;
+    k = left;
+    while (i < middle && j < right) {
+      if (compareByTitle(&sort->source[j], &sort->source[i]) < 0) {
+        sort->target[k++] = sort->source[j++];
+      } else {
+        sort->target[k++] = sort->source[i++];
+      }
+    }
+    while (i < middle) {
+      sort->target[k++] = sort->source[i++];
+    }
+    while (j < right) {
+      sort->target[k++] = sort->source[j++];
+    }
+  }
 }
 
 /* Sort array of indices by movie title (alphabetically) */
 void sortMoviesByTitle(int *indices, int count, const MovieDatabase *db) {
   IndexTitlePair *pairs;
-  int i;
+  IndexTitlePair *scratch;
+  IndexTitlePair *swap;
+  MergeSortContext sort;
+  int i, runs, pairCount;
 
   if (indices == NULL || db == NULL || count <= 0) {
     return;
   }
 
+  /* Cached and merged results usually arrive in order already */
+  for (i = 1; i < count; i++) {
+    if (compareMovieTitles(db, indices[i - 1], indices[i]) > 0) {
+      break;
+    }
+  }
+  if (i >= count) {
+    return;
+  }
+
   pairs = (IndexTitlePair *)malloc(count * sizeof(IndexTitlePair));
   if (pairs == NULL) {
     printf("Error: Memory allocation failed.\n");
@@ -637,8 +918,48 @@ void sortMoviesByTitle(int *indices, int count, const MovieDatabase *db) {
     pairs[i].title = db->movies[indices[i]].title;
   }
 
-  /* Sort pairs by title */
-  qsort(pairs, count, sizeof(IndexTitlePair), compareByTitle);
+  runs = getPoolWorkerCount();
+  scratch = NULL;
+  if (runs > 1 && count >= PARALLEL_SORT_MIN) {
+    scratch = (IndexTitlePair *)malloc(count * sizeof(IndexTitlePair));
+  }
+
+  if (scratch == NULL) {
+    /* Sort pairs by title */
+    qsort(pairs, count, sizeof(IndexTitlePair), compareByTitle);
+  } else {
+    /* Parallel merge sort: one run per worker, then pairwise merges. The
+       comparison is a total order, so the result matches the qsort path */
+    sort.source = pairs;
+    sort.target = scratch;
+    for (i = 0; i <= runs; i++) {
+      sort.runStart[i] = (int)((long)count * i / runs);
+    }
+    sort.runCount = runs;
+    parallelFor(runs, 1, sortRuns, &sort);
+
+    while (runs > 1) {
+      pairCount = (runs + 1) / 2;
+      parallelFor(pairCount, 1, mergeRunPairs, &sort);
+
+      /* Merged run p spans the old runs 2p and 2p + 1 */
+      for (i = 0; i < pairCount; i++) {
+        sort.runStart[i] = sort.runStart[2 * i];
+      }
+      sort.runStart[pairCount] = count;
+      sort.runCount = pairCount;
+      runs = pairCount;
+
+      swap = sort.source;
+      sort.source = sort.target;
+      sort.target = swap;
+    }
+
+    if (sort.source != pairs) {
+      memcpy(pairs, sort.source, count * sizeof(IndexTitlePair));
+    }
+    free(scratch);
+  }
 
   /* Copy sorted indices back */
   for (i = 0; i < count; i++) {
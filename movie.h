@@ -12,30 +12,28 @@ int findMovieByCode(const MovieDatabase *db, int code);
 int movieCodeExists(const MovieDatabase *db, int code);
 
 /* Movie CRUD operations */
-int addMovie(MovieDatabase *db, const Movie *movie);
+int addMovie(MovieDatabase *db, const Movie *movie, const char *description);
 int addMovieInteractive(MovieDatabase *db);
 int deleteMovie(MovieDatabase *db, int code);
+
+/* Bulk delete - returns the number of movies (that would be) removed */
+int countMatchingMovies(const MovieDatabase *db,
+                        const DeletePredicate *predicate);
+int deleteMatchingMovies(MovieDatabase *db, const DeletePredicate *predicate);
 int editMovie(MovieDatabase *db, int code);
 
 /* Movie data manipulation */
+int movieHasGenre(const Movie *movie, Genre genre);
 void copyMovie(Movie *dest, const Movie *src);
 int getNextAvailableCode(const MovieDatabase *db);
 
-/* Search functions - returns array of indices */
-int searchByTitle(const MovieDatabase *db, const char *searchTerm, int *results,
-                  int maxResults);
-int searchByGenre(const MovieDatabase *db, Genre genre, int *results,
-                  int maxResults);
-int searchByDirector(const MovieDatabase *db, const char *director,
-                     int *results, int maxResults);
-int searchByActor(const MovieDatabase *db, const char *actor, int *results,
-                  int maxResults);
-
 /* Sorting helpers */
 void sortMoviesByCode(MovieDatabase *db, SortOrder order);
 void sortMoviesByTitle(int *indices, int count, const MovieDatabase *db);
+int compareMovieTitles(const MovieDatabase *db, int indexA, int indexB);
 
 /* Validation helpers */
 int validateMovieData(const Movie *movie);
+const char *checkMovieData(const Movie *movie); /* Silent, NULL if valid */
 
 #endif /* MOVIE_H */
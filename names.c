@@ -0,0 +1,177 @@
+#include "names.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_NAME_SLOTS 64
+
+/* Case-insensitive FNV-1a hash */
+static unsigned long hashName(const char *name) {
+  unsigned long hash = 2166136261UL;
+
+  while (*name != '\0') {
+    hash ^= (unsigned long)tolower((unsigned char)*name);
+    hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+    name++;
+  }
+
+  return hash;
+}
+
+/* Case-insensitive string equality */
+static int namesEqual(const char *a, const char *b) {
+  while (*a != '\0' &&
+         tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+    a++;
+    b++;
+  }
+  return tolower((unsigned char)*a) == tolower((unsigned char)*b);
+}
+
+/* Find the hash slot holding name, or the empty slot where it belongs */
+static int findSlot(const NameTable *table, const char *name) {
+  unsigned long mask = (unsigned long)table->slotCount - 1;
+  unsigned long slot = hashName(name) & mask;
+  int id;
+
+  while ((id = table->slots[slot]) != 0) {
+    if (namesEqual(table->names[id - 1], name)) {
+      break;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  return (int)slot;
+}
+
+/* Double the hash table and reinsert all ids */
+static int growSlots(NameTable *table) {
+  int *oldSlots = table->slots;
+  int oldCount = table->slotCount;
+  int newCount = (oldCount == 0) ? INITIAL_NAME_SLOTS : oldCount * 2;
+  int i;
+
+  table->slots = (int *)calloc(newCount, sizeof(int));
+  if (table->slots == NULL) {
+    table->slots = oldSlots;
+    return 0;
+  }
+  table->slotCount = newCount;
+
+  for (i = 0; i < table->count; i++) {
+    table->slots[findSlot(table, table->names[i])] = i + 1;
+  }
+
+  free(oldSlots);
+  return 1;
+}
+
+/* Initialise an empty name table */
+void initNameTable(NameTable *table) {
+  if (table == NULL) {
+    return;
+  }
+
+  table->names = NULL;
+  table->count = 0;
+  table->capacity = 0;
+  table->slots = NULL;
+  table->slotCount = 0;
+}
+
+/* Release all memory owned by a name table */
+void freeNameTable(NameTable *table) {
+  int i;
+
+  if (table == NULL) {
+    return;
+  }
+
+  for (i = 0; i < table->count; i++) {
+    free(table->names[i]);
+  }
+  free(table->names);
+  free(table->slots);
+  initNameTable(table);
+}
+
+/* Get the id of a name, interning it on first sight */
+int internName(NameTable *table, const char *name) {
+  char **newNames;
+  char *copy;
+  int slot;
+
+  if (table == NULL || name == NULL) {
+    return -1;
+  }
+
+  /* Keep the load factor below one half */
+  if ((table->count + 1) * 2 > table->slotCount && !growSlots(table)) {
+    printf("Error: Memory allocation failed.\n");
+    return -1;
+  }
+
+  slot = findSlot(table, name);
+  if (table->slots[slot] != 0) {
+    return table->slots[slot] - 1;
+  }
+
+  if (table->count == table->capacity) {
+    newNames = (char **)realloc(table->names, (table->capacity * 2 + 16) *
+                                                  sizeof(char *));
+    if (newNames == NULL) {
+      printf("Error: Memory allocation failed.\n");
+      return -1;
+    }
+    table->names = newNames;
+    table->capacity = table->capacity * 2 + 16;
+  }
+
+  copy = (char *)malloc(strlen(name) + 1);
+  if (copy == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return -1;
+  }
+  strcpy(copy, name);
+
+  table->names[table->count] = copy;
+  table->slots[slot] = table->count + 1;
+  return table->count++;
+}
+
+/* Look up the id of a name without interning it */
+int findNameId(const NameTable *table, const char *name) {
+  int slot;
+
+  if (table == NULL || name == NULL || table->slotCount == 0) {
+    return -1;
+  }
+
+  slot = findSlot(table, name);
+  return table->slots[slot] - 1;
+}
+
+/* Get the stored spelling of an interned name */
+const char *getNameById(const NameTable *table, int id) {
+  if (table == NULL || id < 0 || id >= table->count) {
+    return "";
+  }
+  return table->names[id];
+}
+
+/* Measure the id array, the hash slots and the stored names */
+long getNameTableBytes(const NameTable *table, long *used) {
+  long allocated, textBytes = 0;
+  int i;
+
+  for (i = 0; i < table->count; i++) {
+    textBytes += (long)strlen(table->names[i]) + 1;
+  }
+
+  allocated = (long)table->capacity * (long)sizeof(char *) +
+              (long)table->slotCount * (long)sizeof(int) + textBytes;
+  *used = (long)table->count * (long)(sizeof(char *) + sizeof(int)) +
+          textBytes;
+  return allocated;
+}
@@ -0,0 +1,28 @@
+#ifndef NAMES_H
+#define NAMES_H
+
+/* Interned name table - maps distinct names (case insensitive) to dense
+   integer ids, keeping the first spelling seen for each name */
+typedef struct {
+  char **names;  /* id -> name */
+  int count;     /* Number of distinct names */
+  int capacity;  /* Allocated entries in names */
+  int *slots;    /* Open-addressing hash table of id + 1 (0 = empty) */
+  int slotCount; /* Number of hash slots (power of two) */
+} NameTable;
+
+void initNameTable(NameTable *table);
+void freeNameTable(NameTable *table);
+
+/* Returns the id of name, adding it if needed (-1 on allocation failure) */
+int internName(NameTable *table, const char *name);
+
+/* Returns the id of name, or -1 if it was never interned */
+int findNameId(const NameTable *table, const char *name);
+
+const char *getNameById(const NameTable *table, int id);
+
+/* Heap bytes of the table, with the bytes in use stored in *used */
+long getNameTableBytes(const NameTable *table, long *used);
+
+#endif /* NAMES_H */
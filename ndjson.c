@@ -0,0 +1,642 @@
+#include "ndjson.h"
+#include "fileio.h"
+#include "movie.h"
+#include "outbuf.h"
+#include "textstore.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Deepest nesting skipped inside an unknown member */
+#define MAX_SKIP_DEPTH 16
+
+/* Longest number token accepted */
+#define MAX_NUMBER_LENGTH 64
+
+/* Write a JSON string as pure ASCII - the catalog is ISO-8859-1, so
+   bytes above 0x7F are escaped as the code points they stand for (\u00XX),
+   which keeps the file valid UTF-8 and reads back byte for byte */
+static void outputJsonString(OutputBuffer *out, const char *text) {
+  static const char hexDigits[] = "0123456789abcdef";
+  const char *start = text;
+  unsigned char c;
+
+  outputChar(out, '"');
+  for (; *text != '\0'; text++) {
+    c = (unsigned char)*text;
+    if (c != '"' && c != '\\' && c >= 0x20 && c < 0x80) {
+      continue;
+    }
+
+    /* Flush the plain run before the escape */
+    outputChars(out, start, (size_t)(text - start));
+    start = text + 1;
+
+    outputChar(out, '\\');
+    switch (c) {
+    case '"':
+    case '\\':
+      outputChar(out, (char)c);
+      break;
+    case '\n':
+      outputChar(out, 'n');
+      break;
+    case '\r':
+      outputChar(out, 'r');
+      break;
+    case '\t':
+      outputChar(out, 't');
+      break;
+    default:
+      outputString(out, "u00");
+      outputChar(out, hexDigits[c >> 4]);
+      outputChar(out, hexDigits[c & 0x0F]);
+      break;
+    }
+  }
+  outputChars(out, start, (size_t)(text - start));
+  outputChar(out, '"');
+}
+
+/* Write "key": */
+static void outputJsonKey(OutputBuffer *out, const char *key, int first) {
+  if (!first) {
+    outputChar(out, ',');
+  }
+  outputChar(out, '"');
+  outputString(out, key);
+  outputString(out, "\":");
+}
+
+/* Write one movie as a single line */
+static void outputMovieRecord(OutputBuffer *out, const MovieDatabase *db,
+                              const Movie *movie) {
+  char description[MAX_DESCRIPTION_LENGTH];
+  int j;
+
+  outputChar(out, '{');
+  outputJsonKey(out, "code", 1);
+  outputInt(out, movie->code, 0, 0);
+
+  outputJsonKey(out, "title", 0);
+  outputJsonString(out, movie->title);
+
+  outputJsonKey(out, "genres", 0);
+  outputChar(out, '[');
+  for (j = 0; j < movie->genreCount; j++) {
+    if (j > 0) {
+      outputChar(out, ',');
+    }
+    outputJsonString(out, getGenreName(movie->genres[j]));
+  }
+  outputChar(out, ']');
+
+  outputJsonKey(out, "description", 0);
+  outputJsonString(out, loadText(&db->text, &movie->description, description));
+
+  outputJsonKey(out, "director", 0);
+  outputJsonString(out, movie->director);
+
+  outputJsonKey(out, "actors", 0);
+  outputChar(out, '[');
+  for (j = 0; j < movie->actorCount; j++) {
+    if (j > 0) {
+      outputChar(out, ',');
+    }
+    outputJsonString(out, movie->actors[j]);
+  }
+  outputChar(out, ']');
+
+  /* Same precision as the CSV export */
+  outputJsonKey(out, "year", 0);
+  outputInt(out, movie->year, 0, 0);
+  outputJsonKey(out, "duration", 0);
+  outputInt(out, movie->duration, 0, 0);
+  outputJsonKey(out, "rating", 0);
+  outputFixed(out, movie->rating, 1, 0);
+  outputJsonKey(out, "favorite", 0);
+  outputInt(out, movie->favorite, 0, 0);
+  outputJsonKey(out, "revenue", 0);
+  outputFixed(out, movie->revenue, 2, 0);
+  outputString(out, "}\n");
+}
+
+/* Export movies to an NDJSON file */
+int exportMoviesToNDJSON(const MovieDatabase *db, const char *filename) {
+  OutputBuffer out;
+  FILE *file;
+  FILE *testFile;
+  int i, ok;
+
+  if (db == NULL || filename == NULL) {
+    printf("Error: Invalid parameters.\n");
+    return 0;
+  }
+
+  if (db->count == 0) {
+    printf("Error: No movies to export.\n");
+    return 0;
+  }
+
+  /* Never overwrite an existing file */
+  testFile = fopen(filename, "r");
+  if (testFile != NULL) {
+    fclose(testFile);
+    printf("Error: File '%s' already exists. Export cancelled.\n", filename);
+    return 0;
+  }
+
+  file = fopen(filename, "w");
+  if (file == NULL) {
+    printf("Error: Could not create file '%s'.\n", filename);
+    return 0;
+  }
+
+  if (!openOutputBuffer(&out, file)) {
+    fclose(file);
+    return 0;
+  }
+
+  printf("Exporting %d movies to '%s'...\n", db->count, filename);
+
+  for (i = 0; i < db->count; i++) {
+    outputMovieRecord(&out, db, &db->movies[i]);
+  }
+
+  ok = closeOutputBuffer(&out);
+  if (fclose(file) != 0) {
+    ok = 0;
+  }
+
+  if (!ok) {
+    printf("Error: Could not write file '%s'.\n", filename);
+    return 0;
+  }
+
+  printf("Export complete: %d movies exported to '%s'.\n", db->count, filename);
+  return 1;
+}
+
+/* Incremental reader - one character of lookahead, no line buffer */
+typedef struct {
+  FILE *file;
+  int c;    /* Lookahead character, EOF at the end */
+  int line; /* Line of the lookahead character */
+} JsonReader;
+
+/* Move to the next character */
+static void advanceReader(JsonReader *reader) {
+  if (reader->c == '\n') {
+    reader->line++;
+  }
+  reader->c = getc(reader->file);
+}
+
+/* Skip blanks inside a record (records end at a newline) */
+static void skipBlanks(JsonReader *reader) {
+  while (reader->c == ' ' || reader->c == '\t' || reader->c == '\r') {
+    advanceReader(reader);
+  }
+}
+
+/* Consume an expected character */
+static int expectChar(JsonReader *reader, int c) {
+  skipBlanks(reader);
+  if (reader->c != c) {
+    return 0;
+  }
+  advanceReader(reader);
+  return 1;
+}
+
+/* The catalog byte for a code point - ISO-8859-1 stops at U+00FF, so
+   anything above is replaced */
+static char toCatalogByte(unsigned long code) {
+  return (code < 0x100) ? (char)code : '?';
+}
+
+/* Read the four hex digits after \u, leaving the last one as lookahead */
+static int readHexQuad(JsonReader *reader, unsigned long *code) {
+  int i, digit;
+
+  *code = 0;
+  for (i = 0; i < 4; i++) {
+    advanceReader(reader);
+    if (reader->c >= '0' && reader->c <= '9') {
+      digit = reader->c - '0';
+    } else if (reader->c >= 'a' && reader->c <= 'f') {
+      digit = reader->c - 'a' + 10;
+    } else if (reader->c >= 'A' && reader->c <= 'F') {
+      digit = reader->c - 'A' + 10;
+    } else {
+      return 0;
+    }
+    *code = *code * 16 + (unsigned long)digit;
+  }
+  return 1;
+}
+
+/* Read a \u escape, combining a surrogate pair into one code point.
+   Returns 0 on bad hex digits or an unpaired surrogate */
+static int readUnicodeEscape(JsonReader *reader, unsigned long *code) {
+  unsigned long low;
+
+  if (!readHexQuad(reader, code)) {
+    return 0;
+  }
+  if (*code >= 0xDC00 && *code <= 0xDFFF) {
+    return 0;
+  }
+  if (*code < 0xD800 || *code > 0xDBFF) {
+    return 1;
+  }
+
+  advanceReader(reader);
+  if (reader->c != '\\') {
+    return 0;
+  }
+  advanceReader(reader);
+  if (reader->c != 'u' || !readHexQuad(reader, &low) || low < 0xDC00 ||
+      low > 0xDFFF) {
+    return 0;
+  }
+  *code = 0x10000 + ((*code - 0xD800) << 10) + (low - 0xDC00);
+  return 1;
+}
+
+/* Decode a raw UTF-8 sequence starting at the current (lead) byte,
+   rejecting overlong forms, surrogates and stray continuation bytes */
+static int readUtf8Sequence(JsonReader *reader, unsigned long *code) {
+  int extra, i;
+
+  if (reader->c >= 0xC2 && reader->c <= 0xDF) {
+    extra = 1;
+    *code = (unsigned long)reader->c & 0x1F;
+  } else if (reader->c >= 0xE0 && reader->c <= 0xEF) {
+    extra = 2;
+    *code = (unsigned long)reader->c & 0x0F;
+  } else if (reader->c >= 0xF0 && reader->c <= 0xF4) {
+    extra = 3;
+    *code = (unsigned long)reader->c & 0x07;
+  } else {
+    return 0;
+  }
+
+  for (i = 0; i < extra; i++) {
+    advanceReader(reader);
+    if (reader->c < 0x80 || reader->c > 0xBF) {
+      return 0;
+    }
+    *code = (*code << 6) | ((unsigned long)reader->c & 0x3F);
+  }
+
+  if ((extra == 2 && *code < 0x800) || (extra == 3 && *code < 0x10000) ||
+      (*code >= 0xD800 && *code <= 0xDFFF) || *code > 0x10FFFF) {
+    return 0;
+  }
+  return 1;
+}
+
+/* Read a string into buffer (truncated to bufferSize - 1 bytes, like a
+   CSV field), or skip it when buffer is NULL. The UTF-8 text is stored as
+   the catalog's ISO-8859-1, so import undoes what export escaped */
+static int readJsonString(JsonReader *reader, char *buffer, int bufferSize) {
+  unsigned long code;
+  int length = 0;
+  char byte;
+
+  if (!expectChar(reader, '"')) {
+    return 0;
+  }
+
+  while (reader->c != '"') {
+    if (reader->c == EOF || reader->c == '\n') {
+      return 0;
+    }
+
+    byte = (char)reader->c;
+    if (reader->c >= 0x80) {
+      if (!readUtf8Sequence(reader, &code)) {
+        return 0;
+      }
+      byte = toCatalogByte(code);
+    } else if (reader->c == '\\') {
+      advanceReader(reader);
+      switch (reader->c) {
+      case '"':
+      case '\\':
+      case '/':
+        byte = (char)reader->c;
+        break;
+      case 'b':
+        byte = '\b';
+        break;
+      case 'f':
+        byte = '\f';
+        break;
+      case 'n':
+        byte = '\n';
+        break;
+      case 'r':
+        byte = '\r';
+        break;
+      case 't':
+        byte = '\t';
+        break;
+      case 'u':
+        if (!readUnicodeEscape(reader, &code)) {
+          return 0;
+        }
+        byte = toCatalogByte(code);
+        break;
+      default:
+        return 0;
+      }
+    }
+    advanceReader(reader);
+
+    if (buffer != NULL && length < bufferSize - 1) {
+      buffer[length++] = byte;
+    }
+  }
+  advanceReader(reader);
+
+  if (buffer != NULL) {
+    buffer[length] = '\0';
+  }
+  return 1;
+}
+
+/* Read a number token */
+static int readJsonNumber(JsonReader *reader, double *value) {
+  char token[MAX_NUMBER_LENGTH];
+  char *end;
+  int length = 0;
+
+  skipBlanks(reader);
+  while ((reader->c >= '0' && reader->c <= '9') || reader->c == '-' ||
+         reader->c == '+' || reader->c == '.' || reader->c == 'e' ||
+         reader->c == 'E') {
+    if (length == MAX_NUMBER_LENGTH - 1) {
+      return 0;
+    }
+    token[length++] = (char)reader->c;
+    advanceReader(reader);
+  }
+  token[length] = '\0';
+
+  *value = strtod(token, &end);
+  return length > 0 && *end == '\0';
+}
+
+/* Read a number that must be a whole int */
+static int readJsonInteger(JsonReader *reader, int *value) {
+  double number;
+
+  if (!readJsonNumber(reader, &number) || number < -2147483647.0 ||
+      number > 2147483647.0 || number != (double)(long)number) {
+    return 0;
+  }
+  *value = (int)number;
+  return 1;
+}
+
+/* Skip a value of any type */
+static int skipJsonValue(JsonReader *reader, int depth) {
+  double number;
+  int closing;
+
+  skipBlanks(reader);
+  if (depth > MAX_SKIP_DEPTH) {
+    return 0;
+  }
+
+  if (reader->c == '"') {
+    return readJsonString(reader, NULL, 0);
+  }
+
+  if (reader->c == '[' || reader->c == '{') {
+    closing = (reader->c == '[') ? ']' : '}';
+    advanceReader(reader);
+    if (expectChar(reader, closing)) {
+      return 1;
+    }
+    do {
+      if (closing == '}' &&
+          (!readJsonString(reader, NULL, 0) || !expectChar(reader, ':'))) {
+        return 0;
+      }
+      if (!skipJsonValue(reader, depth + 1)) {
+        return 0;
+      }
+    } while (expectChar(reader, ','));
+    return expectChar(reader, closing);
+  }
+
+  if (reader->c >= 'a' && reader->c <= 'z') {
+    while (reader->c >= 'a' && reader->c <= 'z') {
+      advanceReader(reader); /* true, false, null */
+    }
+    return 1;
+  }
+
+  return readJsonNumber(reader, &number);
+}
+
+/* Read an array of strings, handing each to the movie */
+static int readStringArray(JsonReader *reader, Movie *movie, int isGenres) {
+  char item[MAX_STRING_LENGTH];
+  Genre genre;
+
+  if (!expectChar(reader, '[')) {
+    return 0;
+  }
+  if (expectChar(reader, ']')) {
+    return 1;
+  }
+
+  do {
+    if (!readJsonString(reader, item, sizeof(item))) {
+      return 0;
+    }
+    trimString(item);
+
+    /* Same rules as the CSV import - unknown genres and empty actor
+       names are dropped */
+    if (isGenres) {
+      genre = getGenreFromString(item);
+      if (genre != GENRE_NONE && movie->genreCount < MAX_GENRES_PER_MOVIE) {
+        movie->genres[movie->genreCount++] = genre;
+      }
+    } else if (strlen(item) > 0 && movie->actorCount < MAX_ACTORS_PER_MOVIE) {
+      item[MAX_ACTOR_NAME_LENGTH - 1] = '\0';
+      strcpy(movie->actors[movie->actorCount++], item);
+    }
+  } while (expectChar(reader, ','));
+
+  return expectChar(reader, ']');
+}
+
+/* Read one member into the movie */
+static int readMember(JsonReader *reader, const char *key, Movie *movie,
+                      char *description) {
+  double number;
+
+  if (strcmp(key, "code") == 0) {
+    return readJsonInteger(reader, &movie->code);
+  }
+  if (strcmp(key, "title") == 0) {
+    if (!readJsonString(reader, movie->title, MAX_STRING_LENGTH)) {
+      return 0;
+    }
+    trimString(movie->title);
+    return 1;
+  }
+  if (strcmp(key, "genres") == 0) {
+    return readStringArray(reader, movie, 1);
+  }
+  if (strcmp(key, "description") == 0) {
+    if (!readJsonString(reader, description, MAX_DESCRIPTION_LENGTH)) {
+      return 0;
+    }
+    trimString(description);
+    return 1;
+  }
+  if (strcmp(key, "director") == 0) {
+    if (!readJsonString(reader, movie->director, MAX_STRING_LENGTH)) {
+      return 0;
+    }
+    trimString(movie->director);
+    return 1;
+  }
+  if (strcmp(key, "actors") == 0) {
+    return readStringArray(reader, movie, 0);
+  }
+  if (strcmp(key, "year") == 0) {
+    return readJsonInteger(reader, &movie->year);
+  }
+  if (strcmp(key, "duration") == 0) {
+    return readJsonInteger(reader, &movie->duration);
+  }
+  if (strcmp(key, "favorite") == 0) {
+    return readJsonInteger(reader, &movie->favorite);
+  }
+  if (strcmp(key, "rating") == 0) {
+    if (!readJsonNumber(reader, &number)) {
+      return 0;
+    }
+    movie->rating = (float)number;
+    return 1;
+  }
+  if (strcmp(key, "revenue") == 0) {
+    if (!readJsonNumber(reader, &number)) {
+      return 0;
+    }
+    movie->revenue = (float)number;
+    return 1;
+  }
+
+  return skipJsonValue(reader, 0);
+}
+
+/* Read one record - the movie and its description are the only state
+   carried, so a file of any size streams through */
+static int readMovieRecord(JsonReader *reader, Movie *movie,
+                           char *description) {
+  char key[MAX_STRING_LENGTH];
+  int i;
+
+  memset(movie, 0, sizeof(Movie));
+  for (i = 0; i < MAX_GENRES_PER_MOVIE; i++) {
+    movie->genres[i] = GENRE_NONE;
+  }
+  movie->code = 0; /* Missing code - rejected by the import */
+  description[0] = '\0';
+
+  if (!expectChar(reader, '{')) {
+    return 0;
+  }
+  if (!expectChar(reader, '}')) {
+    do {
+      if (!readJsonString(reader, key, sizeof(key)) ||
+          !expectChar(reader, ':') ||
+          !readMember(reader, key, movie, description)) {
+        return 0;
+      }
+    } while (expectChar(reader, ','));
+
+    if (!expectChar(reader, '}')) {
+      return 0;
+    }
+  }
+
+  /* Nothing but blanks may follow on the line */
+  skipBlanks(reader);
+  return reader->c == '\n' || reader->c == EOF;
+}
+
+/* Import movies from an NDJSON file */
+int importMoviesFromNDJSON(MovieDatabase *db, const char *filename) {
+  JsonReader reader;
+  Movie movie;
+  char description[MAX_DESCRIPTION_LENGTH];
+  int importedCount = 0;
+  int duplicateCount = 0;
+  int lineNumber;
+
+  if (db == NULL || filename == NULL) {
+    printf("Error: Invalid parameters.\n");
+    return 0;
+  }
+
+  reader.file = fopen(filename, "r");
+  if (reader.file == NULL) {
+    printf("Error: Could not open file '%s'.\n", filename);
+    return 0;
+  }
+
+  printf("Importing movies from '%s'...\n", filename);
+
+  reader.line = 1;
+  reader.c = getc(reader.file);
+
+  while (1) {
+    /* Skip blank lines between records */
+    while (reader.c == '\n' || reader.c == ' ' || reader.c == '\t' ||
+           reader.c == '\r') {
+      advanceReader(&reader);
+    }
+    if (reader.c == EOF) {
+      break;
+    }
+
+    lineNumber = reader.line;
+    if (!readMovieRecord(&reader, &movie, description)) {
+      printf("Warning: Malformed JSON on line %d, skipped.\n", lineNumber);
+      while (reader.c != '\n' && reader.c != EOF) {
+        advanceReader(&reader);
+      }
+      continue;
+    }
+
+    /* Same duplicate and validation rules as the CSV import */
+    if (movieCodeExists(db, movie.code)) {
+      duplicateCount++;
+      continue;
+    }
+
+    if (movie.code > 0 && validateMovieData(&movie)) {
+      if (addMovie(db, &movie, description)) {
+        importedCount++;
+      }
+    } else {
+      printf("Warning: Invalid data on line %d, skipped.\n", lineNumber);
+    }
+  }
+
+  fclose(reader.file);
+
+  finishImport(db, importedCount, duplicateCount);
+  return importedCount;
+}
@@ -0,0 +1,11 @@
+#ifndef NDJSON_H
+#define NDJSON_H
+
+#include "types.h"
+
+/* Newline-delimited JSON - one movie object per line, with the CSV
+   column names as keys and genres/actors as string arrays */
+int exportMoviesToNDJSON(const MovieDatabase *db, const char *filename);
+int importMoviesFromNDJSON(MovieDatabase *db, const char *filename);
+
+#endif /* NDJSON_H */
@@ -0,0 +1,197 @@
+#include "outbuf.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Open a buffered writer on an already open stream */
+int openOutputBuffer(OutputBuffer *out, FILE *file) {
+  if (out == NULL || file == NULL) {
+    return 0;
+  }
+
+  out->data = (char *)malloc(OUTPUT_BUFFER_SIZE);
+  if (out->data == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  out->file = file;
+  out->sink = NULL;
+  out->sinkContext = NULL;
+  out->capacity = OUTPUT_BUFFER_SIZE;
+  out->length = 0;
+  out->owned = 1;
+  out->failed = 0;
+  return 1;
+}
+
+/* Set up a writer over caller-provided storage (e.g. a stack array) */
+void attachOutputBuffer(OutputBuffer *out, FILE *file, char *storage,
+                        size_t capacity) {
+  if (out == NULL) {
+    return;
+  }
+
+  out->file = file;
+  out->sink = NULL;
+  out->sinkContext = NULL;
+  out->data = storage;
+  out->capacity = capacity;
+  out->length = 0;
+  out->owned = 0;
+  out->failed = 0;
+}
+
+/* Write buffered bytes to the stream */
+int flushOutputBuffer(OutputBuffer *out) {
+  if (out == NULL || out->data == NULL) {
+    return 0;
+  }
+
+  if (out->length == 0) {
+    return !out->failed;
+  }
+
+  if (out->sink != NULL) {
+    if (!out->sink(out->sinkContext, out->data, out->length)) {
+      out->failed = 1;
+    }
+  } else if (fwrite(out->data, 1, out->length, out->file) != out->length) {
+    out->failed = 1;
+  }
+  out->length = 0;
+
+  return !out->failed;
+}
+
+/* Route flushed blocks to sink instead of the stream */
+void setOutputSink(OutputBuffer *out, OutputSink sink, void *context) {
+  out->sink = sink;
+  out->sinkContext = context;
+}
+
+/* Flush and release the buffer, returns 0 if any write failed */
+int closeOutputBuffer(OutputBuffer *out) {
+  int ok;
+
+  if (out == NULL || out->data == NULL) {
+    return 0;
+  }
+
+  ok = flushOutputBuffer(out);
+  if (fflush(out->file) != 0) {
+    ok = 0;
+  }
+
+  if (out->owned) {
+    free(out->data);
+  }
+  out->data = NULL;
+  return ok;
+}
+
+/* Append raw bytes, flushing when the buffer fills up */
+void outputChars(OutputBuffer *out, const char *text, size_t length) {
+  size_t chunk;
+
+  while (length > 0) {
+    if (out->length == out->capacity) {
+      flushOutputBuffer(out);
+    }
+
+    chunk = out->capacity - out->length;
+    if (chunk > length) {
+      chunk = length;
+    }
+
+    memcpy(out->data + out->length, text, chunk);
+    out->length += chunk;
+    text += chunk;
+    length -= chunk;
+  }
+}
+
+/* Append a NUL-terminated string */
+void outputString(OutputBuffer *out, const char *text) {
+  outputChars(out, text, strlen(text));
+}
+
+/* Append a single character */
+void outputChar(OutputBuffer *out, char c) {
+  if (out->length == out->capacity) {
+    flushOutputBuffer(out);
+  }
+  out->data[out->length++] = c;
+}
+
+/* Append a character repeated count times */
+void outputRepeat(OutputBuffer *out, char c, int count) {
+  size_t chunk;
+
+  while (count > 0) {
+    if (out->length == out->capacity) {
+      flushOutputBuffer(out);
+    }
+
+    chunk = out->capacity - out->length;
+    if (chunk > (size_t)count) {
+      chunk = (size_t)count;
+    }
+
+    memset(out->data + out->length, c, chunk);
+    out->length += chunk;
+    count -= (int)chunk;
+  }
+}
+
+/* Append text left-aligned in a column of at least width characters
+   (same as printf "%-*s" - longer text is not truncated) */
+void outputPadded(OutputBuffer *out, const char *text, int width) {
+  size_t length = strlen(text);
+
+  outputChars(out, text, length);
+  if ((int)length < width) {
+    outputRepeat(out, ' ', width - (int)length);
+  }
+}
+
+/* Append an integer padded to width (printf "%*ld" or "%-*ld") */
+void outputInt(OutputBuffer *out, long value, int width, int leftAlign) {
+  char digits[24];
+  int length = 0;
+  int negative = value < 0;
+  unsigned long magnitude;
+  char text[24];
+  int i;
+
+  magnitude = negative ? 0UL - (unsigned long)value : (unsigned long)value;
+
+  do {
+    digits[length++] = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+
+  i = 0;
+  if (negative) {
+    text[i++] = '-';
+  }
+  while (length > 0) {
+    text[i++] = digits[--length];
+  }
+
+  if (!leftAlign && i < width) {
+    outputRepeat(out, ' ', width - i);
+  }
+  outputChars(out, text, i);
+  if (leftAlign && i < width) {
+    outputRepeat(out, ' ', width - i);
+  }
+}
+
+/* Append a fixed-point number right-aligned (printf "%*.*f") */
+void outputFixed(OutputBuffer *out, double value, int decimals, int width) {
+  char text[64];
+
+  /* Delegated to sprintf so rounding matches the printf-based output */
+  sprintf(text, "%*.*f", width, decimals, value);
+  outputString(out, text);
+}
@@ -0,0 +1,46 @@
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Size of the output buffer - flushed with one fwrite when full */
+#define OUTPUT_BUFFER_SIZE 65536
+
+/* Alternative destination for flushed blocks (e.g. a compressor),
+   returns 0 on failure */
+typedef int (*OutputSink)(void *context, const char *data, size_t length);
+
+/* Buffered writer - text is formatted into memory and written in large
+   blocks instead of one stdio call per field */
+typedef struct {
+  FILE *file;      /* Destination stream */
+  OutputSink sink; /* Receives the blocks instead of file when set */
+  void *sinkContext;
+  char *data;      /* Buffer storage */
+  size_t capacity; /* Size of data */
+  size_t length;   /* Bytes currently buffered */
+  int owned;       /* Non-zero if data was allocated by openOutputBuffer */
+  int failed;      /* Non-zero after a write error */
+} OutputBuffer;
+
+/* Open/close - closing flushes but does not fclose the stream */
+int openOutputBuffer(OutputBuffer *out, FILE *file);
+void attachOutputBuffer(OutputBuffer *out, FILE *file, char *storage,
+                        size_t capacity);
+int closeOutputBuffer(OutputBuffer *out);
+int flushOutputBuffer(OutputBuffer *out);
+void setOutputSink(OutputBuffer *out, OutputSink sink, void *context);
+
+/* Append raw text */
+void outputChars(OutputBuffer *out, const char *text, size_t length);
+void outputString(OutputBuffer *out, const char *text);
+void outputChar(OutputBuffer *out, char c);
+void outputRepeat(OutputBuffer *out, char c, int count);
+
+/* Append formatted values */
+void outputPadded(OutputBuffer *out, const char *text, int width);
+void outputInt(OutputBuffer *out, long value, int width, int leftAlign);
+void outputFixed(OutputBuffer *out, double value, int decimals, int width);
+
+#endif /* OUTBUF_H */
@@ -0,0 +1,536 @@
+#include "query.h"
+#include "index.h"
+#include "movie.h"
+#include "utils.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Default selectivities (1 in N movies) for terms without an index,
+   in the spirit of classic cost-based planners */
+#define TITLE_CONTAINS_SELECTIVITY 10
+#define TITLE_EXACT_SELECTIVITY 1000
+#define DIRECTOR_CONTAINS_SELECTIVITY 50
+#define DIRECTOR_EXACT_SELECTIVITY 200
+#define ACTOR_CONTAINS_SELECTIVITY 20
+#define ACTOR_EXACT_SELECTIVITY 100
+
+/* Open-ended bound for one-sided numeric comparisons */
+#define UNBOUNDED 1e30
+
+/* Execution plan of one OR group */
+typedef struct {
+  int driver;                   /* Term resolved through an index, or -1 */
+  int filters[MAX_QUERY_TERMS]; /* Remaining terms, most selective first */
+  int filterCount;
+} GroupPlan;
+
+/* Case-insensitive keyword comparison */
+static int isKeyword(const char *word, const char *keyword) {
+  while (*word != '\0' &&
+         tolower((unsigned char)*word) == (unsigned char)*keyword) {
+    word++;
+    keyword++;
+  }
+  return *word == '\0' && *keyword == '\0';
+}
+
+/* Case-insensitive equality against an already lowercased needle */
+static int equalsFolded(const char *value, const char *lowerNeedle) {
+  while (*value != '\0' &&
+         tolower((unsigned char)*value) == (unsigned char)*lowerNeedle) {
+    value++;
+    lowerNeedle++;
+  }
+  return *value == '\0' && *lowerNeedle == '\0';
+}
+
+/* Parse a numeric comparison into a range predicate */
+static int parseRangeTerm(QueryPredicate *term, IndexField field,
+                          const char *op, const char *valueText,
+                          Query *query) {
+  char number[MAX_STRING_LENGTH];
+  char *end;
+  double value;
+
+  strncpy(number, valueText, MAX_STRING_LENGTH - 1);
+  number[MAX_STRING_LENGTH - 1] = '\0';
+  for (end = number; *end != '\0'; end++) {
+    if (*end == ',') {
+      *end = '.'; /* Accept the CSV decimal comma too */
+    }
+  }
+
+  value = strtod(number, &end);
+  if (end == number || *end != '\0') {
+    sprintf(query->error, "Invalid number '%.200s'.", valueText);
+    return 0;
+  }
+
+  /* Stored ratings and revenue are floats - compare at that precision */
+  if (field == INDEX_RATING || field == INDEX_REVENUE) {
+    value = (float)value;
+  }
+
+  term->type = PREDICATE_RANGE;
+  initRangePredicate(&term->range, field, -UNBOUNDED, UNBOUNDED);
+
+  if (strcmp(op, ">=") == 0) {
+    term->range.min = value;
+  } else if (strcmp(op, ">") == 0) {
+    term->range.min = value;
+    term->range.minOpen = 1;
+  } else if (strcmp(op, "<=") == 0) {
+    term->range.max = value;
+  } else if (strcmp(op, "<") == 0) {
+    term->range.max = value;
+    term->range.maxOpen = 1;
+  } else if (strcmp(op, "=") == 0) {
+    term->range.min = value;
+    term->range.max = value;
+  } else {
+    sprintf(query->error, "Operator '%s' is not valid for %s.", op,
+            getIndexFieldName(field));
+    return 0;
+  }
+
+  return 1;
+}
+
+/* Parse one term ("Drama", "actor~Hanks", "year>=2000", ...) */
+static int parseTerm(char *text, QueryPredicate *term, Query *query) {
+  char field[MAX_STRING_LENGTH];
+  char op[3];
+  char *value;
+  size_t fieldLength, length;
+
+  trimString(text);
+  fieldLength = strcspn(text, "~<>=");
+
+  /* A bare word is a genre name */
+  if (text[fieldLength] == '\0') {
+    term->type = PREDICATE_GENRE;
+    term->genre = getGenreFromString(text);
+    if (term->genre == GENRE_NONE) {
+      sprintf(query->error, "Unknown genre or term '%.200s'.", text);
+      return 0;
+    }
+    return 1;
+  }
+
+  /* Split into field, operator and value */
+  strncpy(field, text, fieldLength);
+  field[fieldLength] = '\0';
+  trimString(field);
+  toLowerString(field, field);
+
+  op[0] = text[fieldLength];
+  op[1] = '\0';
+  op[2] = '\0';
+  value = text + fieldLength + 1;
+  if ((op[0] == '<' || op[0] == '>') && *value == '=') {
+    op[1] = '=';
+    value++;
+  }
+
+  trimString(value);
+  length = strlen(value);
+  if (length >= 2 && value[0] == '"' && value[length - 1] == '"') {
+    value[length - 1] = '\0';
+    value++;
+  }
+
+  if (*value == '\0') {
+    sprintf(query->error, "Missing value for '%.200s'.", field);
+    return 0;
+  }
+
+  if (strcmp(field, "year") == 0) {
+    return parseRangeTerm(term, INDEX_YEAR, op, value, query);
+  }
+  if (strcmp(field, "rating") == 0) {
+    return parseRangeTerm(term, INDEX_RATING, op, value, query);
+  }
+  if (strcmp(field, "duration") == 0) {
+    return parseRangeTerm(term, INDEX_DURATION, op, value, query);
+  }
+  if (strcmp(field, "revenue") == 0) {
+    return parseRangeTerm(term, INDEX_REVENUE, op, value, query);
+  }
+
+  if (strcmp(field, "genre") == 0) {
+    term->type = PREDICATE_GENRE;
+    term->genre = getGenreFromString(value);
+    if (strcmp(op, "=") != 0 || term->genre == GENRE_NONE) {
+      sprintf(query->error, "Use genre=<name> with a valid genre.");
+      return 0;
+    }
+    return 1;
+  }
+
+  if (strcmp(field, "title") == 0) {
+    term->type = PREDICATE_TITLE;
+  } else if (strcmp(field, "director") == 0) {
+    term->type = PREDICATE_DIRECTOR;
+  } else if (strcmp(field, "actor") == 0) {
+    term->type = PREDICATE_ACTOR;
+  } else {
+    sprintf(query->error, "Unknown field '%.200s'.", field);
+    return 0;
+  }
+
+  if (strcmp(op, "~") != 0 && strcmp(op, "=") != 0) {
+    sprintf(query->error, "Use ~ (contains) or = (equals) with %.200s.",
+            field);
+    return 0;
+  }
+
+  term->exact = (op[0] == '=');
+  prepareSubstringPattern(&term->pattern, value);
+  return 1;
+}
+
+/* Parse a query into OR groups of AND terms */
+int parseQuery(const char *text, Query *query) {
+  char buffer[MAX_DESCRIPTION_LENGTH];
+  char termText[MAX_DESCRIPTION_LENGTH];
+  char *word;
+  const char *c;
+  int group = 0, inQuotes = 0;
+  int isAnd, isOr;
+
+  if (query == NULL) {
+    return 0;
+  }
+
+  query->termCount = 0;
+  query->groupCount = 0;
+  query->error[0] = '\0';
+
+  if (text == NULL) {
+    strcpy(query->error, "Empty query.");
+    return 0;
+  }
+
+  strncpy(buffer, text, sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = '\0';
+  termText[0] = '\0';
+
+  /* A term runs until the next AND/OR keyword outside double quotes, so
+     values may hold spaces, and quoted ones the keywords too */
+  word = strtok(buffer, " \t\n");
+  while (1) {
+    if (word == NULL && inQuotes) {
+      strcpy(query->error, "Missing closing quote.");
+      return 0;
+    }
+    isAnd = (word != NULL && !inQuotes && isKeyword(word, "and"));
+    isOr = (word != NULL && !inQuotes && isKeyword(word, "or"));
+
+    if (word == NULL || isAnd || isOr) {
+      if (termText[0] == '\0') {
+        strcpy(query->error, (word == NULL && query->termCount == 0)
+                                 ? "Empty query."
+                                 : "Missing term around AND/OR.");
+        return 0;
+      }
+      if (query->termCount == MAX_QUERY_TERMS) {
+        sprintf(query->error, "Too many terms (maximum %d).",
+                MAX_QUERY_TERMS);
+        return 0;
+      }
+      if (group >= MAX_QUERY_GROUPS) {
+        sprintf(query->error, "Too many OR groups (maximum %d).",
+                MAX_QUERY_GROUPS);
+        return 0;
+      }
+
+      query->terms[query->termCount].group = group;
+      query->terms[query->termCount].exact = 0;
+      if (!parseTerm(termText, &query->terms[query->termCount], query)) {
+        return 0;
+      }
+      query->termCount++;
+      query->groupCount = group + 1;
+      termText[0] = '\0';
+
+      if (word == NULL) {
+        break;
+      }
+      if (isOr) {
+        group++;
+      }
+    } else {
+      if (strlen(termText) + strlen(word) + 2 > sizeof(termText)) {
+        strcpy(query->error, "Query is too long.");
+        return 0;
+      }
+      if (termText[0] != '\0') {
+        strcat(termText, " ");
+      }
+      strcat(termText, word);
+      for (c = word; *c != '\0'; c++) {
+        inQuotes ^= (*c == '"');
+      }
+    }
+
+    word = strtok(NULL, " \t\n");
+  }
+
+  return 1;
+}
+
+/* Check a text term against one string */
+static int matchesText(const QueryPredicate *term, const char *value) {
+  if (term->exact) {
+    return equalsFolded(value, term->pattern.needle);
+  }
+  return matchSubstringPattern(&term->pattern, value);
+}
+
+/* Check a movie against a single term */
+static int matchesTerm(const Movie *movie, const QueryPredicate *term) {
+  int i;
+
+  switch (term->type) {
+  case PREDICATE_RANGE:
+    return matchesRange(movie, &term->range);
+  case PREDICATE_GENRE:
+    return movieHasGenre(movie, term->genre);
+  case PREDICATE_TITLE:
+    return matchesText(term, movie->title);
+  case PREDICATE_DIRECTOR:
+    return matchesText(term, movie->director);
+  case PREDICATE_ACTOR:
+    for (i = 0; i < movie->actorCount; i++) {
+      if (matchesText(term, movie->actors[i])) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+  return 0;
+}
+
+/* Estimate how many movies a term matches */
+static int estimateTerm(const MovieDatabase *db, const QueryPredicate *term) {
+  int divisor;
+
+  switch (term->type) {
+  case PREDICATE_RANGE:
+    return countInRange(db, &term->range); /* Exact, O(log n) */
+  case PREDICATE_GENRE:
+    return db->indexes.genreCounts[term->genre]; /* Exact, O(1) */
+  case PREDICATE_TITLE:
+    divisor = term->exact ? TITLE_EXACT_SELECTIVITY
+                          : TITLE_CONTAINS_SELECTIVITY;
+    break;
+  case PREDICATE_DIRECTOR:
+    divisor = term->exact ? DIRECTOR_EXACT_SELECTIVITY
+                          : DIRECTOR_CONTAINS_SELECTIVITY;
+    break;
+  default:
+    divisor = term->exact ? ACTOR_EXACT_SELECTIVITY
+                          : ACTOR_CONTAINS_SELECTIVITY;
+    break;
+  }
+
+  return db->count / divisor + 1;
+}
+
+/* Plan one OR group: the range term with the smallest index slice
+   drives the scan, the other terms filter in order of selectivity */
+static void planGroup(const MovieDatabase *db, Query *query, int group,
+                      GroupPlan *plan) {
+  int i, j;
+
+  plan->driver = -1;
+  plan->filterCount = 0;
+
+  for (i = 0; i < query->termCount; i++) {
+    if (query->terms[i].group != group) {
+      continue;
+    }
+
+    query->terms[i].estimate = estimateTerm(db, &query->terms[i]);
+
+    if (query->terms[i].type == PREDICATE_RANGE &&
+        query->terms[i].estimate < db->count &&
+        (plan->driver == -1 ||
+         query->terms[i].estimate < query->terms[plan->driver].estimate)) {
+      plan->driver = i;
+    }
+  }
+
+  /* Insertion sort of the remaining terms by estimate */
+  for (i = 0; i < query->termCount; i++) {
+    if (query->terms[i].group != group || i == plan->driver) {
+      continue;
+    }
+
+    j = plan->filterCount++;
+    while (j > 0 && query->terms[plan->filters[j - 1]].estimate >
+                        query->terms[i].estimate) {
+      plan->filters[j] = plan->filters[j - 1];
+      j--;
+    }
+    plan->filters[j] = i;
+  }
+}
+
+/* Run a query - each OR group runs its own plan, results are merged
+   without duplicates and sorted by title */
+int executeQuery(const MovieDatabase *db, Query *query, int *results,
+                 int maxResults) {
+  GroupPlan plan;
+  char *seen;
+  int group, i, j, position, first, last;
+  int count = 0;
+
+  if (db == NULL || query == NULL || results == NULL || db->count == 0) {
+    return 0;
+  }
+
+  seen = (char *)calloc(db->count, 1);
+  if (seen == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  for (group = 0; group < query->groupCount && count < maxResults; group++) {
+    planGroup(db, query, group, &plan);
+
+    /* Candidates: an index slice, or every movie */
+    if (plan.driver != -1) {
+      findIndexRange(db, &query->terms[plan.driver].range, &first, &last);
+    } else {
+      first = 0;
+      last = db->count;
+    }
+
+    for (i = first; i < last && count < maxResults; i++) {
+      position = (plan.driver != -1)
+                     ? db->indexes.byField[query->terms[plan.driver]
+                                               .range.field][i]
+                     : i;
+
+      if (seen[position]) {
+        continue;
+      }
+
+      for (j = 0; j < plan.filterCount; j++) {
+        if (!matchesTerm(&db->movies[position],
+                         &query->terms[plan.filters[j]])) {
+          break;
+        }
+      }
+
+      if (j == plan.filterCount) {
+        seen[position] = 1;
+        results[count++] = position;
+      }
+    }
+  }
+
+  free(seen);
+
+  sortMoviesByTitle(results, count, db);
+  return count;
+}
+
+/* Describe a term for the plan printout */
+static void describeTerm(const QueryPredicate *term, char *buffer) {
+  const char *op = term->exact ? "=" : "~";
+
+  switch (term->type) {
+  case PREDICATE_RANGE:
+    if (term->range.min == term->range.max) {
+      sprintf(buffer, "%s = %g", getIndexFieldName(term->range.field),
+              term->range.min);
+    } else if (term->range.max == UNBOUNDED) {
+      sprintf(buffer, "%s %s %g", getIndexFieldName(term->range.field),
+              term->range.minOpen ? ">" : ">=", term->range.min);
+    } else {
+      sprintf(buffer, "%s %s %g", getIndexFieldName(term->range.field),
+              term->range.maxOpen ? "<" : "<=", term->range.max);
+    }
+    break;
+  case PREDICATE_GENRE:
+    sprintf(buffer, "genre=%s", getGenreName(term->genre));
+    break;
+  case PREDICATE_TITLE:
+    sprintf(buffer, "title%s%.200s", op, term->pattern.needle);
+    break;
+  case PREDICATE_DIRECTOR:
+    sprintf(buffer, "director%s%.200s", op, term->pattern.needle);
+    break;
+  case PREDICATE_ACTOR:
+    sprintf(buffer, "actor%s%.200s", op, term->pattern.needle);
+    break;
+  }
+}
+
+/* Whether an OR group has a genre term */
+static int groupHasGenre(const Query *query, int group) {
+  int i;
+
+  for (i = 0; i < query->termCount; i++) {
+    if (query->terms[i].group == group &&
+        query->terms[i].type == PREDICATE_GENRE) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Print the plan chosen for each OR group */
+void printQueryPlan(const MovieDatabase *db, Query *query) {
+  GroupPlan plan;
+  char description[MAX_STRING_LENGTH + 64];
+  int group, i;
+
+  if (db == NULL || query == NULL) {
+    return;
+  }
+
+  printf("Query plan:\n");
+  for (group = 0; group < query->groupCount; group++) {
+    planGroup(db, query, group, &plan);
+
+    if (query->groupCount > 1) {
+      printf("  OR group %d:\n", group + 1);
+    }
+
+    if (plan.driver != -1) {
+      describeTerm(&query->terms[plan.driver], description);
+      printf("    index range scan: %s (%d rows)\n", description,
+             query->terms[plan.driver].estimate);
+    } else if (groupHasGenre(query, group)) {
+      /* Genres only keep counts, there is no list of their movies */
+      printf("    full scan (%d rows, genre terms have no index to drive "
+             "it)\n",
+             db->count);
+    } else {
+      printf("    full scan (%d rows)\n", db->count);
+    }
+
+    for (i = 0; i < plan.filterCount; i++) {
+      describeTerm(&query->terms[plan.filters[i]], description);
+      printf("    filter: %s (~%d rows)\n", description,
+             query->terms[plan.filters[i]].estimate);
+    }
+  }
+}
+
+/* Print the query syntax summary */
+void printQueryHelp(void) {
+  printf("Combine terms with AND / OR (AND binds tighter):\n");
+  printf("  <Genre> or genre=<Genre>      e.g. Drama\n");
+  printf("  title~<text>, title=<text>    contains / equals\n");
+  printf("  director~<text>, director=<name>\n");
+  printf("  actor~<text>, actor=<name>\n");
+  printf("  year, rating, duration, revenue with >=, <=, >, <, =\n");
+  printf("Quote values holding AND/OR: title~\"Pride and Prejudice\"\n");
+  printf("Example: Drama AND actor~Hanks AND year>=2000\n");
+}
@@ -0,0 +1,53 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "textsearch.h"
+#include "types.h"
+
+/* Query capacity */
+#define MAX_QUERY_TERMS 16
+#define MAX_QUERY_GROUPS 8
+
+/* Kinds of query predicate */
+typedef enum {
+  PREDICATE_RANGE,    /* year/rating/duration/revenue comparison */
+  PREDICATE_GENRE,    /* Drama, genre=Drama */
+  PREDICATE_TITLE,    /* title~text, title=text */
+  PREDICATE_DIRECTOR, /* director~text, director=name */
+  PREDICATE_ACTOR     /* actor~text, actor=name */
+} PredicateType;
+
+/* A single query term */
+typedef struct {
+  PredicateType type;
+  int group;                /* OR group this term belongs to */
+  int exact;                /* Text terms: '=' (whole value) or '~' */
+  RangePredicate range;     /* PREDICATE_RANGE */
+  Genre genre;              /* PREDICATE_GENRE */
+  SubstringPattern pattern; /* Text terms (needle is lowercased) */
+  int estimate;             /* Planner estimate of matching movies */
+} QueryPredicate;
+
+/* Parsed query - OR of AND groups ("a AND b OR c" is (a AND b) OR c) */
+typedef struct {
+  QueryPredicate terms[MAX_QUERY_TERMS];
+  int termCount;
+  int groupCount;
+  char error[MAX_STRING_LENGTH]; /* Parse error message */
+} Query;
+
+/* Parse a query such as "Drama AND actor~Hanks AND year>=2000",
+   returns 1 on success or 0 with query->error set */
+int parseQuery(const char *text, Query *query);
+
+/* Run a query - results are sorted by title */
+int executeQuery(const MovieDatabase *db, Query *query, int *results,
+                 int maxResults);
+
+/* Print the plan chosen for each OR group */
+void printQueryPlan(const MovieDatabase *db, Query *query);
+
+/* Print the query syntax summary */
+void printQueryHelp(void);
+
+#endif /* QUERY_H */
@@ -0,0 +1,230 @@
+#include "querycache.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Initialise an empty cache */
+void initQueryCache(QueryCache *cache) {
+  int i;
+
+  if (cache == NULL) {
+    return;
+  }
+
+  for (i = 0; i < QUERY_CACHE_SIZE; i++) {
+    cache->entries[i].used = 0;
+    cache->entries[i].results = NULL;
+    cache->entries[i].count = 0;
+    cache->entries[i].newer = -1;
+    cache->entries[i].older = -1;
+  }
+  cache->newest = -1;
+  cache->oldest = -1;
+  cache->db = NULL;
+  cache->hits = 0;
+  cache->misses = 0;
+  cache->invalidations = 0;
+  cache->evictions = 0;
+}
+
+/* Release all cached results */
+void freeQueryCache(QueryCache *cache) {
+  int i;
+
+  if (cache == NULL) {
+    return;
+  }
+
+  for (i = 0; i < QUERY_CACHE_SIZE; i++) {
+    free(cache->entries[i].results);
+  }
+  initQueryCache(cache);
+}
+
+/* Take an entry out of the recency list */
+static void unlinkEntry(QueryCache *cache, int slot) {
+  QueryCacheEntry *entry = &cache->entries[slot];
+
+  if (entry->newer != -1) {
+    cache->entries[entry->newer].older = entry->older;
+  } else {
+    cache->newest = entry->older;
+  }
+  if (entry->older != -1) {
+    cache->entries[entry->older].newer = entry->newer;
+  } else {
+    cache->oldest = entry->newer;
+  }
+  entry->newer = -1;
+  entry->older = -1;
+}
+
+/* Put an entry at the most recent end of the list */
+static void linkNewest(QueryCache *cache, int slot) {
+  QueryCacheEntry *entry = &cache->entries[slot];
+
+  entry->newer = -1;
+  entry->older = cache->newest;
+  if (cache->newest != -1) {
+    cache->entries[cache->newest].newer = slot;
+  }
+  cache->newest = slot;
+  if (cache->oldest == -1) {
+    cache->oldest = slot;
+  }
+}
+
+/* Drop an entry */
+static void dropEntry(QueryCache *cache, int slot) {
+  unlinkEntry(cache, slot);
+  free(cache->entries[slot].results);
+  cache->entries[slot].results = NULL;
+  cache->entries[slot].count = 0;
+  cache->entries[slot].used = 0;
+}
+
+/* Searches fold case, so terms differing only in case share an entry */
+static void normaliseTerm(char *dest, const char *term) {
+  strncpy(dest, term, MAX_STRING_LENGTH - 1);
+  dest[MAX_STRING_LENGTH - 1] = '\0';
+  toLowerString(dest, dest);
+}
+
+/* Slot holding (type, normalised term), or -1 */
+static int findEntry(const QueryCache *cache, SearchType type,
+                     const char *term) {
+  int i;
+
+  for (i = 0; i < QUERY_CACHE_SIZE; i++) {
+    if (cache->entries[i].used && cache->entries[i].type == type &&
+        strcmp(cache->entries[i].term, term) == 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+/* Look up cached results */
+int lookupQueryCache(QueryCache *cache, const MovieDatabase *db,
+                     SearchType type, const char *term, int *results,
+                     int maxResults) {
+  char key[MAX_STRING_LENGTH];
+  QueryCacheEntry *entry;
+  int slot, count;
+
+  if (cache == NULL || db == NULL || term == NULL || results == NULL) {
+    return -1;
+  }
+
+  normaliseTerm(key, term);
+  slot = findEntry(cache, type, key);
+  if (slot == -1) {
+    cache->misses++;
+    return -1;
+  }
+
+  entry = &cache->entries[slot];
+  if (cache->db != db || entry->version != db->version) {
+    dropEntry(cache, slot);
+    cache->invalidations++;
+    cache->misses++;
+    return -1;
+  }
+
+  count = (entry->count < maxResults) ? entry->count : maxResults;
+  memcpy(results, entry->results, count * sizeof(int));
+
+  unlinkEntry(cache, slot);
+  linkNewest(cache, slot);
+  cache->hits++;
+  return count;
+}
+
+/* Store results, evicting the least recently used entry when full */
+void storeQueryCache(QueryCache *cache, const MovieDatabase *db,
+                     SearchType type, const char *term, const int *results,
+                     int count) {
+  char key[MAX_STRING_LENGTH];
+  QueryCacheEntry *entry;
+  int *copy;
+  int slot, i;
+
+  if (cache == NULL || db == NULL || term == NULL || results == NULL ||
+      count < 0) {
+    return;
+  }
+
+  copy = (int *)malloc((count + 1) * sizeof(int));
+  if (copy == NULL) {
+    return; /* Caching is optional */
+  }
+  memcpy(copy, results, count * sizeof(int));
+
+  /* Entries of another database can never be served again */
+  if (cache->db != db) {
+    for (i = 0; i < QUERY_CACHE_SIZE; i++) {
+      if (cache->entries[i].used) {
+        dropEntry(cache, i);
+      }
+    }
+    cache->db = db;
+  }
+
+  normaliseTerm(key, term);
+  slot = findEntry(cache, type, key);
+  if (slot != -1) {
+    dropEntry(cache, slot);
+  } else {
+    for (i = 0; i < QUERY_CACHE_SIZE && slot == -1; i++) {
+      if (!cache->entries[i].used) {
+        slot = i;
+      }
+    }
+    if (slot == -1) {
+      slot = cache->oldest;
+      dropEntry(cache, slot);
+      cache->evictions++;
+    }
+  }
+
+  entry = &cache->entries[slot];
+  entry->used = 1;
+  entry->type = type;
+  strcpy(entry->term, key);
+  entry->version = db->version;
+  entry->results = copy;
+  entry->count = count;
+  linkNewest(cache, slot);
+}
+
+/* Number of cached searches */
+int getQueryCacheEntryCount(const QueryCache *cache) {
+  int i, count = 0;
+
+  if (cache == NULL) {
+    return 0;
+  }
+
+  for (i = 0; i < QUERY_CACHE_SIZE; i++) {
+    count += cache->entries[i].used;
+  }
+
+  return count;
+}
+
+/* Each result list has one spare slot so empty results still allocate */
+long getQueryCacheBytes(const QueryCache *cache, long *used) {
+  long allocated = 0;
+  int i;
+
+  *used = 0;
+  for (i = 0; i < QUERY_CACHE_SIZE; i++) {
+    if (cache->entries[i].used) {
+      allocated += (long)(cache->entries[i].count + 1) * (long)sizeof(int);
+      *used += (long)cache->entries[i].count * (long)sizeof(int);
+    }
+  }
+  return allocated;
+}
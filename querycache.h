@@ -0,0 +1,51 @@
+#ifndef QUERYCACHE_H
+#define QUERYCACHE_H
+
+#include "types.h"
+
+#define QUERY_CACHE_SIZE 32
+
+/* Title-sorted results of one search */
+typedef struct {
+  int used;
+  SearchType type;
+  char term[MAX_STRING_LENGTH]; /* Normalised search term */
+  unsigned long version;        /* Database version the results belong to */
+  int *results;
+  int count;
+  int newer; /* Neighbours in the recency list (-1 = none) */
+  int older;
+} QueryCacheEntry;
+
+/* Bounded LRU cache of search results */
+typedef struct {
+  QueryCacheEntry entries[QUERY_CACHE_SIZE];
+  int newest; /* Most recently used entry (-1 = empty) */
+  int oldest; /* Least recently used entry */
+  const MovieDatabase *db;
+  long hits;
+  long misses;
+  long invalidations; /* Entries dropped because the database changed */
+  long evictions;     /* Entries dropped to make room */
+} QueryCache;
+
+void initQueryCache(QueryCache *cache);
+void freeQueryCache(QueryCache *cache);
+
+/* Copy cached results for (type, term) into results, returns their count,
+   or -1 on a miss (entries from an older database version are dropped) */
+int lookupQueryCache(QueryCache *cache, const MovieDatabase *db,
+                     SearchType type, const char *term, int *results,
+                     int maxResults);
+
+/* Remember the title-sorted results of (type, term) */
+void storeQueryCache(QueryCache *cache, const MovieDatabase *db,
+                     SearchType type, const char *term, const int *results,
+                     int count);
+
+int getQueryCacheEntryCount(const QueryCache *cache);
+
+/* Heap bytes of the cached result lists, bytes in use in *used */
+long getQueryCacheBytes(const QueryCache *cache, long *used);
+
+#endif /* QUERYCACHE_H */
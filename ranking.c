@@ -0,0 +1,158 @@
+#include "ranking.h"
+#include "movie.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Heap entry - ranking key cached next to the movie index */
+typedef struct {
+  double value;
+  int code;
+  int index;
+} RankEntry;
+
+/* Get display name of a ranking field */
+const char *getRankFieldName(RankField field) {
+  switch (field) {
+  case RANK_BY_RATING:
+    return "Rating";
+  case RANK_BY_REVENUE:
+    return "Revenue";
+  case RANK_BY_FAVORITE:
+    return "Favorites";
+  case RANK_BY_DURATION:
+    return "Duration";
+  }
+  return "Unknown";
+}
+
+/* Get the numeric value a movie is ranked by */
+double getRankValue(const Movie *movie, RankField field) {
+  switch (field) {
+  case RANK_BY_RATING:
+    return movie->rating;
+  case RANK_BY_REVENUE:
+    return movie->revenue;
+  case RANK_BY_FAVORITE:
+    return movie->favorite;
+  case RANK_BY_DURATION:
+    return movie->duration;
+  }
+  return 0.0;
+}
+
+/* Returns non-zero if entry a ranks below entry b (ties: higher code loses) */
+static int ranksBelow(const RankEntry *a, const RankEntry *b) {
+  if (a->value != b->value) {
+    return a->value < b->value;
+  }
+  return a->code > b->code;
+}
+
+/* Restore min-heap order from position i downwards */
+static void siftDown(RankEntry *heap, int size, int i) {
+  RankEntry tmp;
+  int child;
+
+  while ((child = 2 * i + 1) < size) {
+    if (child + 1 < size && ranksBelow(&heap[child + 1], &heap[child])) {
+      child++;
+    }
+    if (!ranksBelow(&heap[child], &heap[i])) {
+      break;
+    }
+    tmp = heap[i];
+    heap[i] = heap[child];
+    heap[child] = tmp;
+    i = child;
+  }
+}
+
+/* Restore min-heap order from position i upwards */
+static void siftUp(RankEntry *heap, int i) {
+  RankEntry tmp;
+  int parent;
+
+  while (i > 0) {
+    parent = (i - 1) / 2;
+    if (!ranksBelow(&heap[i], &heap[parent])) {
+      break;
+    }
+    tmp = heap[i];
+    heap[i] = heap[parent];
+    heap[parent] = tmp;
+    i = parent;
+  }
+}
+
+/* Check if a movie passes the optional genre/year filter */
+static int matchesFilter(const Movie *movie, const RankFilter *filter) {
+  if (filter == NULL) {
+    return 1;
+  }
+  if (filter->year != 0 && movie->year != filter->year) {
+    return 0;
+  }
+  if (filter->genre != GENRE_NONE && !movieHasGenre(movie, filter->genre)) {
+    return 0;
+  }
+  return 1;
+}
+
+/* Select the k best movies using a bounded min-heap - O(n log k).
+   The heap root is always the weakest of the current top k, so each
+   candidate only needs one comparison unless it displaces the root. */
+int topMovies(const MovieDatabase *db, RankField field,
+              const RankFilter *filter, int k, int *results) {
+  RankEntry *heap;
+  RankEntry candidate;
+  int size = 0;
+  int i;
+
+  if (db == NULL || results == NULL || k <= 0) {
+    return 0;
+  }
+
+  if (k > db->count) {
+    k = db->count;
+  }
+  if (k == 0) {
+    return 0;
+  }
+
+  heap = (RankEntry *)malloc(k * sizeof(RankEntry));
+  if (heap == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  for (i = 0; i < db->count; i++) {
+    const Movie *movie = &db->movies[i];
+
+    if (!matchesFilter(movie, filter)) {
+      continue;
+    }
+
+    candidate.value = getRankValue(movie, field);
+    candidate.code = movie->code;
+    candidate.index = i;
+
+    if (size < k) {
+      heap[size] = candidate;
+      siftUp(heap, size);
+      size++;
+    } else if (ranksBelow(&heap[0], &candidate)) {
+      heap[0] = candidate;
+      siftDown(heap, size, 0);
+    }
+  }
+
+  /* Pop weakest first, filling results from the back */
+  for (i = size - 1; i >= 0; i--) {
+    results[i] = heap[0].index;
+    heap[0] = heap[i];
+    siftDown(heap, i, 0);
+  }
+
+  free(heap);
+  return size;
+}
@@ -0,0 +1,14 @@
+#ifndef RANKING_H
+#define RANKING_H
+
+#include "types.h"
+
+/* Top-K queries - fills results with up to k indices, best first */
+int topMovies(const MovieDatabase *db, RankField field,
+              const RankFilter *filter, int k, int *results);
+
+/* Ranking field helpers */
+const char *getRankFieldName(RankField field);
+double getRankValue(const Movie *movie, RankField field);
+
+#endif /* RANKING_H */
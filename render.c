@@ -0,0 +1,115 @@
+#include "render.h"
+#include "utils.h"
+#include <string.h>
+
+/* Column widths of the movie table */
+#define CODE_WIDTH 6
+#define TITLE_WIDTH 40
+#define GENRES_WIDTH 25
+#define DIRECTOR_WIDTH 25
+#define YEAR_WIDTH 6
+#define DURATION_WIDTH 4
+#define RATING_WIDTH 6
+#define FAVORITE_WIDTH 8
+#define REVENUE_WIDTH 8
+
+/* Genres shown per row before the list is elided */
+#define GENRES_SHOWN 3
+
+/* Column separator */
+static void renderSeparator(OutputBuffer *out) { outputChars(out, " | ", 3); }
+
+/* Print a full-width dashed line */
+void renderTableLine(OutputBuffer *out) {
+  outputRepeat(out, '-', TABLE_WIDTH);
+  outputChar(out, '\n');
+}
+
+/* Print table header for movie list */
+void renderTableHeader(OutputBuffer *out) {
+  renderTableLine(out);
+  outputPadded(out, "Code", CODE_WIDTH);
+  renderSeparator(out);
+  outputPadded(out, "Title", TITLE_WIDTH);
+  renderSeparator(out);
+  outputPadded(out, "Genres", GENRES_WIDTH);
+  renderSeparator(out);
+  outputPadded(out, "Director", DIRECTOR_WIDTH);
+  renderSeparator(out);
+  outputPadded(out, "Year", YEAR_WIDTH);
+  renderSeparator(out);
+  outputPadded(out, "Dur", DURATION_WIDTH);
+  renderSeparator(out);
+  outputPadded(out, "Rating", RATING_WIDTH);
+  renderSeparator(out);
+  outputPadded(out, "Favorite", FAVORITE_WIDTH);
+  renderSeparator(out);
+  outputPadded(out, "Revenue", REVENUE_WIDTH);
+  outputChar(out, '\n');
+  renderTableLine(out);
+}
+
+/* Print the genres column directly into the buffer (no temporary string) */
+static void renderGenres(OutputBuffer *out, const Movie *movie) {
+  const char *name;
+  int width = 0;
+  int length;
+  int i;
+
+  for (i = 0; i < movie->genreCount && i < GENRES_SHOWN; i++) {
+    if (i > 0) {
+      outputChars(out, ", ", 2);
+      width += 2;
+    }
+    name = getGenreName(movie->genres[i]);
+    length = (int)strlen(name);
+    outputChars(out, name, length);
+    width += length;
+  }
+  if (movie->genreCount > GENRES_SHOWN) {
+    outputChars(out, "...", 3);
+    width += 3;
+  }
+
+  if (width < GENRES_WIDTH) {
+    outputRepeat(out, ' ', GENRES_WIDTH - width);
+  }
+}
+
+/* Print a single movie as table row */
+void renderMovieRow(OutputBuffer *out, const Movie *movie) {
+  int titleLength;
+
+  if (movie == NULL) {
+    return;
+  }
+
+  outputInt(out, movie->code, CODE_WIDTH, 1);
+  renderSeparator(out);
+
+  /* Truncate title if too long */
+  titleLength = (int)strlen(movie->title);
+  if (titleLength > TITLE_WIDTH) {
+    outputChars(out, movie->title, TITLE_WIDTH - 3);
+    outputChars(out, "...", 3);
+  } else {
+    outputChars(out, movie->title, titleLength);
+    outputRepeat(out, ' ', TITLE_WIDTH - titleLength);
+  }
+  renderSeparator(out);
+
+  renderGenres(out, movie);
+  renderSeparator(out);
+  outputPadded(out, movie->director, DIRECTOR_WIDTH);
+  renderSeparator(out);
+  outputInt(out, movie->year, YEAR_WIDTH, 1);
+  renderSeparator(out);
+  outputInt(out, movie->duration, DURATION_WIDTH, 1);
+  renderSeparator(out);
+  outputFixed(out, movie->rating, 1, RATING_WIDTH);
+  renderSeparator(out);
+  outputInt(out, movie->favorite, FAVORITE_WIDTH, 0);
+  renderSeparator(out);
+  outputFixed(out, movie->revenue, 2, REVENUE_WIDTH);
+  outputChar(out, '\n');
+}
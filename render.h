@@ -0,0 +1,15 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "outbuf.h"
+#include "types.h"
+
+/* Width of the movie table, including column separators */
+#define TABLE_WIDTH 150
+
+/* Movie table rendering into a buffered writer */
+void renderTableLine(OutputBuffer *out);
+void renderTableHeader(OutputBuffer *out);
+void renderMovieRow(OutputBuffer *out, const Movie *movie);
+
+#endif /* RENDER_H */
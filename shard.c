@@ -0,0 +1,356 @@
+#include "shard.h"
+#include "movie.h"
+#include "threadpool.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Title-ordered movies per morsel when a shard is scanned on the pool */
+#define SHARD_MORSEL_SIZE 256
+
+/* One slice of a shard's title order during a fanned-out search */
+typedef struct {
+  const MovieDatabase *db;
+  const Shard *shard;
+  const ShardQuery *query;
+  int begin;    /* First slot of shard->byTitle */
+  int end;      /* One past the last slot */
+  int *results; /* Matches in title order (room for end - begin) */
+  int count;    /* Matches found */
+} ShardTask;
+
+/* Matches of a whole shard, in title order */
+typedef struct {
+  int *results;
+  int count;
+} ShardRun;
+
+/* Initialise an empty shard set */
+void initShardSet(ShardSet *set, ShardScheme scheme, int shardCount) {
+  int i;
+
+  if (set == NULL) {
+    return;
+  }
+
+  if (shardCount < 1) {
+    shardCount = 1;
+  }
+  if (shardCount > MAX_SHARDS) {
+    shardCount = MAX_SHARDS;
+  }
+
+  set->db = NULL;
+  set->version = 0;
+  set->scheme = scheme;
+  set->shardCount = shardCount;
+  for (i = 0; i < MAX_SHARDS; i++) {
+    set->shards[i].byTitle = NULL;
+    set->shards[i].count = 0;
+    set->shards[i].minCode = 0;
+    set->shards[i].maxCode = 0;
+  }
+}
+
+/* Release the per-shard indexes */
+void freeShardSet(ShardSet *set) {
+  int i;
+
+  if (set == NULL) {
+    return;
+  }
+
+  for (i = 0; i < MAX_SHARDS; i++) {
+    free(set->shards[i].byTitle);
+  }
+  initShardSet(set, set->scheme, set->shardCount);
+}
+
+/* Shard owning a code under the hash scheme */
+static int hashShard(int code, int shardCount) {
+  return (int)((((unsigned long)code * 2654435761UL) & 0xFFFFFFFFUL) %
+               (unsigned long)shardCount);
+}
+
+/* Partition the movies and sort each shard by title */
+int buildShards(ShardSet *set, const MovieDatabase *db) {
+  const int *byCode;
+  Shard *shard;
+  int i, s, position, code;
+
+  if (set == NULL || db == NULL) {
+    return 0;
+  }
+
+  if (set->db == db && set->version == db->version) {
+    return 1;
+  }
+
+  for (s = 0; s < set->shardCount; s++) {
+    free(set->shards[s].byTitle);
+    set->shards[s].byTitle = (int *)malloc((db->count + 1) * sizeof(int));
+    set->shards[s].count = 0;
+    set->shards[s].minCode = 0;
+    set->shards[s].maxCode = 0;
+    if (set->shards[s].byTitle == NULL) {
+      printf("Error: Memory allocation failed.\n");
+      freeShardSet(set);
+      return 0;
+    }
+  }
+
+  /* Walk the code index so each shard fills in code order */
+  byCode = db->indexes.byField[INDEX_CODE];
+  for (i = 0; i < db->count; i++) {
+    position = byCode[i];
+    code = db->movies[position].code;
+
+    if (set->scheme == SHARD_BY_HASH) {
+      s = hashShard(code, set->shardCount);
+    } else {
+      s = (int)((long)i * set->shardCount / db->count);
+    }
+
+    shard = &set->shards[s];
+    if (shard->count == 0 || code < shard->minCode) {
+      shard->minCode = code;
+    }
+    if (shard->count == 0 || code > shard->maxCode) {
+      shard->maxCode = code;
+    }
+    shard->byTitle[shard->count++] = position;
+  }
+
+  for (s = 0; s < set->shardCount; s++) {
+    sortMoviesByTitle(set->shards[s].byTitle, set->shards[s].count, db);
+  }
+
+  set->db = db;
+  set->version = db->version;
+  return 1;
+}
+
+/* Prepare the search term once for all shards */
+void prepareShardQuery(ShardQuery *query, SearchType type, const char *term,
+                       Genre genre) {
+  if (query == NULL) {
+    return;
+  }
+
+  query->type = type;
+  query->genre = genre;
+  query->term[0] = '\0';
+  if (term != NULL) {
+    strncpy(query->term, term, MAX_STRING_LENGTH - 1);
+    query->term[MAX_STRING_LENGTH - 1] = '\0';
+  }
+  prepareSubstringPattern(&query->pattern, query->term);
+}
+
+/* Case-insensitive string equality */
+static int equalsIgnoreCase(const char *a, const char *b) {
+  while (*a != '\0' &&
+         tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+    a++;
+    b++;
+  }
+  return tolower((unsigned char)*a) == tolower((unsigned char)*b);
+}
+
+/* Title and actor match substrings, director the whole name, all
+   ignoring case */
+static int matchesShardQuery(const Movie *movie, const ShardQuery *query) {
+  int i;
+
+  switch (query->type) {
+  case SEARCH_BY_TITLE:
+    return matchSubstringPattern(&query->pattern, movie->title);
+
+  case SEARCH_BY_GENRE:
+    return movieHasGenre(movie, query->genre);
+
+  case SEARCH_BY_DIRECTOR:
+    return equalsIgnoreCase(movie->director, query->term);
+
+  case SEARCH_BY_ACTOR:
+    for (i = 0; i < movie->actorCount; i++) {
+      if (matchSubstringPattern(&query->pattern, movie->actors[i])) {
+        return 1;
+      }
+    }
+    return 0;
+
+  default:
+    return 0;
+  }
+}
+
+/* Scan one slice in title order - its matches come out already sorted */
+static void runShardTask(ShardTask *task) {
+  int i, position;
+
+  task->count = 0;
+  for (i = task->begin; i < task->end; i++) {
+    position = task->shard->byTitle[i];
+    if (matchesShardQuery(&task->db->movies[position], task->query)) {
+      task->results[task->count++] = position;
+    }
+  }
+}
+
+/* Pool callback - one slice per morsel */
+static void runShardMorsel(void *context, int begin, int end, int worker) {
+  ShardTask *tasks = (ShardTask *)context;
+  int i;
+
+  (void)worker;
+  for (i = begin; i < end; i++) {
+    runShardTask(&tasks[i]);
+  }
+}
+
+/* Next unmerged result of a shard */
+static int headResult(const ShardRun *runs, const int *next, int shard) {
+  return runs[shard].results[next[shard]];
+}
+
+/* Restore the heap property below slot (heap of shard numbers keyed by
+   their next unmerged result) */
+static void siftDown(const MovieDatabase *db, const ShardRun *runs,
+                     const int *next, int *heap, int heapSize, int slot) {
+  int child, smallest, swap;
+
+  while (1) {
+    smallest = slot;
+    for (child = 2 * slot + 1; child <= 2 * slot + 2; child++) {
+      if (child < heapSize &&
+          compareMovieTitles(db, headResult(runs, next, heap[child]),
+                             headResult(runs, next, heap[smallest])) < 0) {
+        smallest = child;
+      }
+    }
+    if (smallest == slot) {
+      return;
+    }
+    swap = heap[slot];
+    heap[slot] = heap[smallest];
+    heap[smallest] = swap;
+    slot = smallest;
+  }
+}
+
+/* Fan the query out to the shards and merge their sorted results. Each
+   shard is cut into morsels, so the scan uses every pool worker however
+   few shards there are */
+int searchShards(ShardSet *set, const MovieDatabase *db,
+                 const ShardQuery *query, int *results, int maxResults) {
+  ShardRun runs[MAX_SHARDS];
+  ShardTask *tasks;
+  int heap[MAX_SHARDS];
+  int next[MAX_SHARDS];
+  int *buffer;
+  int heapSize = 0, count = 0, offset = 0, taskCount = 0;
+  int i, s, begin, top;
+
+  if (set == NULL || db == NULL || query == NULL || results == NULL ||
+      db->count == 0 || !buildShards(set, db)) {
+    return 0;
+  }
+
+  buffer = (int *)malloc(db->count * sizeof(int));
+  tasks = (ShardTask *)malloc(
+      (db->count / SHARD_MORSEL_SIZE + set->shardCount) * sizeof(ShardTask));
+  if (buffer == NULL || tasks == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    free(buffer);
+    free(tasks);
+    return 0;
+  }
+
+  /* Pick the substring kernel before the workers race to do it */
+  getSubstringKernelName();
+
+  for (s = 0; s < set->shardCount; s++) {
+    for (begin = 0; begin < set->shards[s].count;
+         begin += SHARD_MORSEL_SIZE) {
+      tasks[taskCount].db = db;
+      tasks[taskCount].shard = &set->shards[s];
+      tasks[taskCount].query = query;
+      tasks[taskCount].begin = begin;
+      tasks[taskCount].end = begin + SHARD_MORSEL_SIZE;
+      if (tasks[taskCount].end > set->shards[s].count) {
+        tasks[taskCount].end = set->shards[s].count;
+      }
+      tasks[taskCount].results = buffer + offset + begin;
+      tasks[taskCount].count = 0;
+      taskCount++;
+    }
+    runs[s].results = buffer + offset;
+    runs[s].count = 0;
+    offset += set->shards[s].count;
+  }
+
+  parallelFor(taskCount, 1, runShardMorsel, tasks);
+
+  /* Close the gaps between the slices of each shard - slices follow
+     each other in title order, so the run stays sorted */
+  for (i = 0; i < taskCount; i++) {
+    s = (int)(tasks[i].shard - set->shards);
+    memmove(runs[s].results + runs[s].count, tasks[i].results,
+            tasks[i].count * sizeof(int));
+    runs[s].count += tasks[i].count;
+  }
+  free(tasks);
+
+  /* k-way merge: heap of the shards that still have results */
+  for (s = 0; s < set->shardCount; s++) {
+    next[s] = 0;
+    if (runs[s].count > 0) {
+      heap[heapSize++] = s;
+    }
+  }
+  for (i = heapSize / 2 - 1; i >= 0; i--) {
+    siftDown(db, runs, next, heap, heapSize, i);
+  }
+
+  while (heapSize > 0 && count < maxResults) {
+    top = heap[0];
+    results[count++] = runs[top].results[next[top]++];
+    if (next[top] == runs[top].count) {
+      heap[0] = heap[--heapSize];
+    }
+    siftDown(db, runs, next, heap, heapSize, 0);
+  }
+
+  free(buffer);
+  return count;
+}
+
+/* Get the display name of a sharding scheme */
+const char *getShardSchemeName(ShardScheme scheme) {
+  switch (scheme) {
+  case SHARD_BY_RANGE:
+    return "code range";
+  case SHARD_BY_HASH:
+    return "code hash";
+  default:
+    return "unknown";
+  }
+}
+
+/* Every shard reserves room for the whole catalogue it was built from */
+long getShardSetBytes(const ShardSet *set, long *used) {
+  long movies = 0;
+  int s, built = 0;
+
+  for (s = 0; s < set->shardCount; s++) {
+    if (set->shards[s].byTitle != NULL) {
+      movies += set->shards[s].count;
+      built++;
+    }
+  }
+
+  *used = movies * (long)sizeof(int);
+  return (long)built * (movies + 1) * (long)sizeof(int);
+}
@@ -0,0 +1,60 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "textsearch.h"
+#include "types.h"
+
+#define MAX_SHARDS 16
+#define DEFAULT_SHARDS 4
+
+/* How movies are assigned to shards */
+typedef enum {
+  SHARD_BY_RANGE, /* Contiguous code ranges of equal size */
+  SHARD_BY_HASH   /* Multiplicative hash of the code */
+} ShardScheme;
+
+/* One partition of the catalogue with its own title-ordered index */
+typedef struct {
+  int *byTitle; /* Positions owned by the shard, in title order */
+  int count;    /* Movies in the shard */
+  int minCode;  /* Smallest code in the shard */
+  int maxCode;  /* Largest code in the shard */
+} Shard;
+
+/* Partitioning of a database, rebuilt when the database version changes */
+typedef struct {
+  const MovieDatabase *db;
+  unsigned long version;
+  ShardScheme scheme;
+  int shardCount;
+  Shard shards[MAX_SHARDS];
+} ShardSet;
+
+/* A search evaluated independently on every shard */
+typedef struct {
+  SearchType type;
+  Genre genre;                  /* SEARCH_BY_GENRE */
+  char term[MAX_STRING_LENGTH]; /* SEARCH_BY_DIRECTOR (exact match) */
+  SubstringPattern pattern;     /* SEARCH_BY_TITLE and SEARCH_BY_ACTOR */
+} ShardQuery;
+
+void initShardSet(ShardSet *set, ShardScheme scheme, int shardCount);
+void freeShardSet(ShardSet *set);
+
+/* Partition db, unless the shards already describe its current version */
+int buildShards(ShardSet *set, const MovieDatabase *db);
+
+void prepareShardQuery(ShardQuery *query, SearchType type, const char *term,
+                       Genre genre);
+
+/* Scan the shards on the thread pool and k-way merge the per-shard
+   results, returning indices in the order sortMoviesByTitle produces */
+int searchShards(ShardSet *set, const MovieDatabase *db,
+                 const ShardQuery *query, int *results, int maxResults);
+
+const char *getShardSchemeName(ShardScheme scheme);
+
+/* Heap bytes of the per-shard title indexes, bytes in use in *used */
+long getShardSetBytes(const ShardSet *set, long *used);
+
+#endif /* SHARD_H */
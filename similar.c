@@ -0,0 +1,405 @@
+#include "similar.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Score weights - each term is at most its weight, except shared actors
+   which add ACTOR_WEIGHT per actor up to MAX_SCORED_ACTORS */
+#define GENRE_WEIGHT 3.0 /* Times the Jaccard overlap of the genre sets */
+#define ACTOR_WEIGHT 1.5
+#define MAX_SCORED_ACTORS 4
+#define DIRECTOR_WEIGHT 2.0
+#define YEAR_WEIGHT 1.0   /* Falls to 0 at YEAR_SCALE years apart */
+#define YEAR_SCALE 20.0
+#define RATING_WEIGHT 1.0 /* Falls to 0 at RATING_SCALE points apart */
+#define RATING_SCALE 3.0
+
+/* Movies taken from a genre posting list when actors and directors give
+   fewer than k candidates */
+#define MAX_GENRE_CANDIDATES 4096
+
+void initSimilarityIndex(SimilarityIndex *index) {
+  memset(index, 0, sizeof(*index));
+  initNameTable(&index->actors);
+  initNameTable(&index->directors);
+}
+
+void freeSimilarityIndex(SimilarityIndex *index) {
+  freeNameTable(&index->actors);
+  freeNameTable(&index->directors);
+  free(index->actorStart);
+  free(index->actorPostings);
+  free(index->directorStart);
+  free(index->directorPostings);
+  free(index->genrePostings);
+  free(index->movieActors);
+  free(index->movieActorCounts);
+  free(index->movieDirectors);
+  free(index->sharedActors);
+  free(index->isCandidate);
+  free(index->touched);
+  initSimilarityIndex(index);
+}
+
+/* Build CSR posting lists: movie p contributes keys[p * stride] onwards,
+   counts[p] of them. start needs keyCount + 1 entries */
+static int buildPostingLists(const int *keys, int stride, const int *counts,
+                             int movieCount, int keyCount, int *start,
+                             int **postings) {
+  int *next;
+  int p, j, key;
+
+  memset(start, 0, (size_t)(keyCount + 1) * sizeof(int));
+  for (p = 0; p < movieCount; p++) {
+    for (j = 0; j < counts[p]; j++) {
+      start[keys[p * stride + j] + 1]++;
+    }
+  }
+  for (key = 0; key < keyCount; key++) {
+    start[key + 1] += start[key];
+  }
+
+  *postings = (int *)malloc((size_t)(start[keyCount] + 1) * sizeof(int));
+  next = (int *)malloc((size_t)(keyCount + 1) * sizeof(int));
+  if (*postings == NULL || next == NULL) {
+    free(next);
+    return 0;
+  }
+
+  /* Positions are visited in order, so every list is sorted */
+  memcpy(next, start, (size_t)keyCount * sizeof(int));
+  for (p = 0; p < movieCount; p++) {
+    for (j = 0; j < counts[p]; j++) {
+      (*postings)[next[keys[p * stride + j]]++] = p;
+    }
+  }
+
+  free(next);
+  return 1;
+}
+
+/* Intern every name and build the actor, director and genre lists */
+static int buildSimilarityIndex(SimilarityIndex *index,
+                                const MovieDatabase *db) {
+  int *genreKeys, *genreCounts, *directorCounts;
+  int n = db->count;
+  int p, j, k, id, ok;
+  const Movie *movie;
+
+  freeSimilarityIndex(index);
+
+  index->movieActors =
+      (int *)malloc((size_t)(n + 1) * MAX_ACTORS_PER_MOVIE * sizeof(int));
+  index->movieActorCounts = (int *)malloc((size_t)(n + 1) * sizeof(int));
+  index->movieDirectors = (int *)malloc((size_t)(n + 1) * sizeof(int));
+  index->sharedActors = (int *)calloc((size_t)n + 1, sizeof(int));
+  index->isCandidate = (char *)calloc((size_t)n + 1, 1);
+  index->touched = (int *)malloc((size_t)(n + 1) * sizeof(int));
+  genreKeys =
+      (int *)malloc((size_t)(n + 1) * MAX_GENRES_PER_MOVIE * sizeof(int));
+  genreCounts = (int *)malloc((size_t)(n + 1) * sizeof(int));
+  directorCounts = (int *)malloc((size_t)(n + 1) * sizeof(int));
+
+  ok = index->movieActors != NULL && index->movieActorCounts != NULL &&
+       index->movieDirectors != NULL && index->sharedActors != NULL &&
+       index->isCandidate != NULL && index->touched != NULL &&
+       genreKeys != NULL && genreCounts != NULL && directorCounts != NULL;
+
+  for (p = 0; ok && p < n; p++) {
+    movie = &db->movies[p];
+
+    index->movieDirectors[p] = internName(&index->directors, movie->director);
+    directorCounts[p] = 1;
+    ok = index->movieDirectors[p] >= 0;
+
+    /* Distinct actors only, so a repeated name is not counted twice */
+    index->movieActorCounts[p] = 0;
+    for (j = 0; ok && j < movie->actorCount; j++) {
+      id = internName(&index->actors, movie->actors[j]);
+      ok = id >= 0;
+      for (k = 0; k < index->movieActorCounts[p]; k++) {
+        if (index->movieActors[p * MAX_ACTORS_PER_MOVIE + k] == id) {
+          break;
+        }
+      }
+      if (ok && k == index->movieActorCounts[p]) {
+        index->movieActors[p * MAX_ACTORS_PER_MOVIE + k] = id;
+        index->movieActorCounts[p]++;
+      }
+    }
+
+    genreCounts[p] = movie->genreCount;
+    for (j = 0; j < movie->genreCount; j++) {
+      genreKeys[p * MAX_GENRES_PER_MOVIE + j] = (int)movie->genres[j];
+    }
+  }
+
+  if (ok) {
+    index->actorStart =
+        (int *)malloc((size_t)(index->actors.count + 1) * sizeof(int));
+    index->directorStart =
+        (int *)malloc((size_t)(index->directors.count + 1) * sizeof(int));
+    ok = index->actorStart != NULL && index->directorStart != NULL &&
+         buildPostingLists(index->movieActors, MAX_ACTORS_PER_MOVIE,
+                           index->movieActorCounts, n, index->actors.count,
+                           index->actorStart, &index->actorPostings) &&
+         buildPostingLists(index->movieDirectors, 1, directorCounts, n,
+                           index->directors.count, index->directorStart,
+                           &index->directorPostings) &&
+         buildPostingLists(genreKeys, MAX_GENRES_PER_MOVIE, genreCounts, n,
+                           GENRE_NONE, index->genreStart,
+                           &index->genrePostings);
+  }
+
+  free(genreKeys);
+  free(genreCounts);
+  free(directorCounts);
+
+  if (!ok) {
+    freeSimilarityIndex(index);
+    return 0;
+  }
+
+  index->built = 1;
+  index->version = db->version;
+  index->movieCount = n;
+  return 1;
+}
+
+/* Add position to the candidate set */
+static void addCandidate(SimilarityIndex *index, int position,
+                         int *touchedCount) {
+  if (!index->isCandidate[position]) {
+    index->isCandidate[position] = 1;
+    index->touched[(*touchedCount)++] = position;
+  }
+}
+
+/* Weighted similarity of a candidate to the query movie */
+static double scoreCandidate(const SimilarityIndex *index,
+                             const MovieDatabase *db, int query,
+                             int candidate) {
+  const Movie *a = &db->movies[query];
+  const Movie *b = &db->movies[candidate];
+  int i, j, sharedGenres = 0, sharedActors;
+  double score = 0.0, closeness;
+
+  for (i = 0; i < a->genreCount; i++) {
+    for (j = 0; j < b->genreCount; j++) {
+      if (a->genres[i] == b->genres[j]) {
+        sharedGenres++;
+        break;
+      }
+    }
+  }
+  if (a->genreCount + b->genreCount > sharedGenres) {
+    score += GENRE_WEIGHT * sharedGenres /
+             (a->genreCount + b->genreCount - sharedGenres);
+  }
+
+  sharedActors = index->sharedActors[candidate];
+  if (sharedActors > MAX_SCORED_ACTORS) {
+    sharedActors = MAX_SCORED_ACTORS;
+  }
+  score += ACTOR_WEIGHT * sharedActors;
+
+  if (index->movieDirectors[query] == index->movieDirectors[candidate]) {
+    score += DIRECTOR_WEIGHT;
+  }
+
+  closeness = 1.0 - abs(a->year - b->year) / YEAR_SCALE;
+  if (closeness > 0.0) {
+    score += YEAR_WEIGHT * closeness;
+  }
+
+  closeness = 1.0 - (a->rating > b->rating ? a->rating - b->rating
+                                           : b->rating - a->rating) /
+                        RATING_SCALE;
+  if (closeness > 0.0) {
+    score += RATING_WEIGHT * closeness;
+  }
+
+  return score;
+}
+
+/* Ranking order - higher score first, then lower position */
+static int isBetter(const SimilarMovie *a, const SimilarMovie *b) {
+  if (a->score != b->score) {
+    return a->score > b->score;
+  }
+  return a->position < b->position;
+}
+
+/* Restore the heap below slot (worst result at the root) */
+static void siftDown(SimilarMovie *heap, int count, int slot) {
+  SimilarMovie item = heap[slot];
+  int child;
+
+  while ((child = 2 * slot + 1) < count) {
+    if (child + 1 < count && isBetter(&heap[child], &heap[child + 1])) {
+      child++;
+    }
+    if (!isBetter(&item, &heap[child])) {
+      break;
+    }
+    heap[slot] = heap[child];
+    slot = child;
+  }
+  heap[slot] = item;
+}
+
+/* Restore the heap above slot */
+static void siftUp(SimilarMovie *heap, int slot) {
+  SimilarMovie item = heap[slot];
+  int parent;
+
+  while (slot > 0) {
+    parent = (slot - 1) / 2;
+    if (!isBetter(&heap[parent], &item)) {
+      break;
+    }
+    heap[slot] = heap[parent];
+    slot = parent;
+  }
+  heap[slot] = item;
+}
+
+/* Keep the k best candidates in a bounded heap */
+static void offerResult(SimilarMovie *heap, int *count, int k,
+                        const SimilarMovie *item) {
+  if (*count < k) {
+    heap[*count] = *item;
+    siftUp(heap, (*count)++);
+  } else if (isBetter(item, &heap[0])) {
+    heap[0] = *item;
+    siftDown(heap, k, 0);
+  }
+}
+
+/* Candidates come from the posting lists of the query's actors and
+   director, topped up from its rarest genre when that gives fewer than k.
+   Only candidates are scored, and a k-entry heap keeps the best, so the
+   cost follows the size of those lists rather than the catalogue. */
+int findSimilarMovies(SimilarityIndex *index, const MovieDatabase *db,
+                      int position, SimilarMovie *results, int k) {
+  const int *actorIds;
+  const Movie *movie;
+  int touchedCount = 0, found = 0;
+  int i, j, id, first, last, genre, rarest;
+  SimilarMovie item;
+
+  if (k > db->count - 1) {
+    k = db->count - 1;
+  }
+  if (position < 0 || position >= db->count || k <= 0) {
+    return 0;
+  }
+
+  if (!index->built || index->version != db->version ||
+      index->movieCount != db->count) {
+    if (!buildSimilarityIndex(index, db)) {
+      return -1;
+    }
+  }
+
+  movie = &db->movies[position];
+  actorIds = &index->movieActors[position * MAX_ACTORS_PER_MOVIE];
+
+  for (i = 0; i < index->movieActorCounts[position]; i++) {
+    id = actorIds[i];
+    for (j = index->actorStart[id]; j < index->actorStart[id + 1]; j++) {
+      index->sharedActors[index->actorPostings[j]]++;
+      addCandidate(index, index->actorPostings[j], &touchedCount);
+    }
+  }
+
+  id = index->movieDirectors[position];
+  for (j = index->directorStart[id]; j < index->directorStart[id + 1];
+       j++) {
+    addCandidate(index, index->directorPostings[j], &touchedCount);
+  }
+
+  /* The query itself is in all of its own lists */
+  if (touchedCount - 1 < k && movie->genreCount > 0) {
+    rarest = movie->genres[0];
+    for (i = 1; i < movie->genreCount; i++) {
+      genre = movie->genres[i];
+      if (index->genreStart[genre + 1] - index->genreStart[genre] <
+          index->genreStart[rarest + 1] - index->genreStart[rarest]) {
+        rarest = genre;
+      }
+    }
+    first = index->genreStart[rarest];
+    last = index->genreStart[rarest + 1];
+    if (last - first > MAX_GENRE_CANDIDATES) {
+      last = first + MAX_GENRE_CANDIDATES;
+    }
+    for (j = first; j < last; j++) {
+      addCandidate(index, index->genrePostings[j], &touchedCount);
+    }
+  }
+
+  for (i = 0; i < touchedCount; i++) {
+    item.position = index->touched[i];
+    if (item.position != position) {
+      item.score = scoreCandidate(index, db, position, item.position);
+      offerResult(results, &found, k, &item);
+    }
+    index->sharedActors[item.position] = 0;
+    index->isCandidate[item.position] = 0;
+  }
+
+  /* Pop the worst to the back until the array is sorted best first */
+  for (i = found - 1; i > 0; i--) {
+    item = results[0];
+    results[0] = results[i];
+    results[i] = item;
+    siftDown(results, i, 0);
+  }
+
+  return found;
+}
+
+/* Posting lists carry one spare entry each, like their start arrays */
+long getSimilarityPostingBytes(const SimilarityIndex *index, long *used) {
+  long allocated, tableUsed, entries;
+
+  allocated = getNameTableBytes(&index->actors, &tableUsed);
+  *used = tableUsed;
+  allocated += getNameTableBytes(&index->directors, &tableUsed);
+  *used += tableUsed;
+  if (!index->built) {
+    return allocated;
+  }
+
+  entries = (long)index->actors.count + 1 + index->directors.count + 1 +
+            index->actorStart[index->actors.count] +
+            index->directorStart[index->directors.count] +
+            index->genreStart[GENRE_NONE];
+  allocated += (entries + 3) * (long)sizeof(int);
+  *used += entries * (long)sizeof(int);
+  return allocated;
+}
+
+/* Actor rows are reserved at MAX_ACTORS_PER_MOVIE, only the distinct
+   actors are in use */
+long getSimilarityMovieTableBytes(const SimilarityIndex *index,
+                                  long *used) {
+  long rows, actors = 0;
+  int p;
+
+  *used = 0;
+  if (!index->built) {
+    return 0;
+  }
+
+  for (p = 0; p < index->movieCount; p++) {
+    actors += index->movieActorCounts[p];
+  }
+
+  /* Actor counts, directors, shared actors, touched list, candidate flags */
+  rows = (long)index->movieCount + 1;
+  *used = (actors + 4 * (long)index->movieCount) * (long)sizeof(int) +
+          index->movieCount;
+  return (rows * MAX_ACTORS_PER_MOVIE + 4 * rows) * (long)sizeof(int) +
+         rows;
+}
@@ -0,0 +1,56 @@
+#ifndef SIMILAR_H
+#define SIMILAR_H
+
+#include "names.h"
+#include "types.h"
+
+/* Recommendations listed with the movie details */
+#define SIMILAR_MOVIES_SHOWN 10
+
+/* Posting lists (CSR layout) from actors, directors and genres to movie
+   positions, rebuilt when the database version changes */
+typedef struct {
+  int built;
+  unsigned long version; /* Database version the lists belong to */
+  int movieCount;
+  NameTable actors;
+  NameTable directors;
+  /* Postings of actor a are actorPostings[actorStart[a]..actorStart[a+1]],
+     the same for directors and genres */
+  int *actorStart;
+  int *actorPostings;
+  int *directorStart;
+  int *directorPostings;
+  int genreStart[GENRE_NONE + 1];
+  int *genrePostings;
+  /* Distinct actor ids of position p: movieActors[p * MAX_ACTORS_PER_MOVIE]
+     onwards, movieActorCounts[p] of them */
+  int *movieActors;
+  int *movieActorCounts;
+  int *movieDirectors; /* Director id of each position */
+  /* Per-query scratch, cleared through the touched list */
+  int *sharedActors; /* Actors shared with the query movie */
+  char *isCandidate;
+  int *touched;
+} SimilarityIndex;
+
+/* One recommendation */
+typedef struct {
+  int position; /* Index in db->movies */
+  double score;
+} SimilarMovie;
+
+void initSimilarityIndex(SimilarityIndex *index);
+void freeSimilarityIndex(SimilarityIndex *index);
+
+/* Up to k movies most similar to db->movies[position], best first.
+   Returns the number found, or -1 on allocation failure */
+int findSimilarMovies(SimilarityIndex *index, const MovieDatabase *db,
+                      int position, SimilarMovie *results, int k);
+
+/* Heap bytes of the name tables and posting lists, and of the per-movie
+   actor table with the query scratch. Bytes in use go to *used */
+long getSimilarityPostingBytes(const SimilarityIndex *index, long *used);
+long getSimilarityMovieTableBytes(const SimilarityIndex *index, long *used);
+
+#endif /* SIMILAR_H */
@@ -0,0 +1,217 @@
+#include "textsearch.h"
+#include <stddef.h>
+#include <string.h>
+
+/* SIMD kernels are only built for x86 with GCC-compatible compilers;
+   everything else uses the scalar kernel */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__SSE2__))
+#define HAVE_SSE2_KERNEL 1
+#include <emmintrin.h>
+#if defined(__x86_64__) && !defined(__clang__) &&                              \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define HAVE_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+#endif
+
+typedef int (*SubstringKernel)(const SubstringPattern *pattern,
+                               const char *haystack);
+
+/* ASCII-only case folding - matches tolower() in the default C locale */
+static unsigned char foldByte(unsigned char c) {
+  return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+/* Compare the rest of the needle at a candidate whose first byte matched */
+static int matchesAt(const SubstringPattern *pattern, const char *candidate) {
+  int i;
+
+  for (i = 1; i < pattern->length; i++) {
+    if (foldByte((unsigned char)candidate[i]) !=
+        (unsigned char)pattern->needle[i]) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/* Portable kernel - scans for the first byte, then verifies in place */
+static int scalarKernel(const SubstringPattern *pattern, const char *haystack) {
+  const unsigned char *p = (const unsigned char *)haystack;
+
+  for (; *p != '\0'; p++) {
+    if ((*p == pattern->firstLower || *p == pattern->firstUpper) &&
+        matchesAt(pattern, (const char *)p)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+#ifdef HAVE_SSE2_KERNEL
+/* SSE2 kernel - tests 16 bytes per step for either case of the first
+   needle byte and for the terminator. Loads are 16-byte aligned, so they
+   never cross into a page past the end of the string. */
+static int sse2Kernel(const SubstringPattern *pattern, const char *haystack) {
+  const char *block = (const char *)((size_t)haystack & ~(size_t)15);
+  unsigned int skip = (unsigned int)(haystack - block);
+  __m128i lower = _mm_set1_epi8((char)pattern->firstLower);
+  __m128i upper = _mm_set1_epi8((char)pattern->firstUpper);
+  __m128i zero = _mm_setzero_si128();
+  __m128i bytes;
+  unsigned int candidates, terminators;
+  int bit;
+
+  for (;;) {
+    bytes = _mm_load_si128((const __m128i *)block);
+    candidates = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(bytes, lower), _mm_cmpeq_epi8(bytes, upper)));
+    terminators = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero));
+
+    /* Ignore bytes before the start of the string (first block only) */
+    candidates = (candidates >> skip) << skip;
+    terminators = (terminators >> skip) << skip;
+    skip = 0;
+
+    /* Only candidates before the terminator count */
+    if (terminators != 0) {
+      candidates &= (terminators & (0U - terminators)) - 1;
+    }
+
+    while (candidates != 0) {
+      bit = __builtin_ctz(candidates);
+      if (matchesAt(pattern, block + bit)) {
+        return 1;
+      }
+      candidates &= candidates - 1;
+    }
+
+    if (terminators != 0) {
+      return 0;
+    }
+    block += 16;
+  }
+}
+#endif
+
+#ifdef HAVE_AVX2_KERNEL
+/* AVX2 kernel - same scheme as the SSE2 kernel with 32-byte blocks */
+__attribute__((target("avx2"))) static int
+avx2Kernel(const SubstringPattern *pattern, const char *haystack) {
+  const char *block = (const char *)((size_t)haystack & ~(size_t)31);
+  unsigned int skip = (unsigned int)(haystack - block);
+  __m256i lower = _mm256_set1_epi8((char)pattern->firstLower);
+  __m256i upper = _mm256_set1_epi8((char)pattern->firstUpper);
+  __m256i zero = _mm256_setzero_si256();
+  __m256i bytes;
+  unsigned int candidates, terminators;
+  int bit;
+
+  for (;;) {
+    bytes = _mm256_load_si256((const __m256i *)block);
+    candidates = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+        _mm256_cmpeq_epi8(bytes, lower), _mm256_cmpeq_epi8(bytes, upper)));
+    terminators =
+        (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, zero));
+
+    /* Shifting a 32-bit value by 32 is undefined, so skip < 32 is kept */
+    candidates = (candidates >> skip) << skip;
+    terminators = (terminators >> skip) << skip;
+    skip = 0;
+
+    if (terminators != 0) {
+      candidates &= (terminators & (0U - terminators)) - 1;
+    }
+
+    while (candidates != 0) {
+      bit = __builtin_ctz(candidates);
+      if (matchesAt(pattern, block + bit)) {
+        return 1;
+      }
+      candidates &= candidates - 1;
+    }
+
+    if (terminators != 0) {
+      return 0;
+    }
+    block += 32;
+  }
+}
+#endif
+
+/* Kernel chosen by CPU feature detection on first use */
+static SubstringKernel activeKernel = NULL;
+static const char *activeKernelName = "scalar";
+
+/* Select the widest kernel the CPU supports */
+static void selectKernel(void) {
+  SubstringKernel kernel = scalarKernel;
+  const char *name = "scalar";
+
+#ifdef HAVE_SSE2_KERNEL
+  kernel = sse2Kernel;
+  name = "sse2";
+#endif
+#ifdef HAVE_AVX2_KERNEL
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    kernel = avx2Kernel;
+    name = "avx2";
+  }
+#endif
+
+  activeKernelName = name;
+  activeKernel = kernel;
+}
+
+/* Lowercase and store the needle with its first-byte filter values */
+void prepareSubstringPattern(SubstringPattern *pattern, const char *needle) {
+  int i = 0;
+
+  if (pattern == NULL) {
+    return;
+  }
+
+  if (needle != NULL) {
+    while (needle[i] != '\0' && i < MAX_STRING_LENGTH - 1) {
+      pattern->needle[i] = (char)foldByte((unsigned char)needle[i]);
+      i++;
+    }
+  }
+  pattern->needle[i] = '\0';
+  pattern->length = i;
+
+  pattern->firstLower = (unsigned char)pattern->needle[0];
+  pattern->firstUpper = pattern->firstLower;
+  if (pattern->firstLower >= 'a' && pattern->firstLower <= 'z') {
+    pattern->firstUpper = (unsigned char)(pattern->firstLower - ('a' - 'A'));
+  }
+}
+
+/* Case-insensitive test for the pattern inside haystack, without copying */
+int matchSubstringPattern(const SubstringPattern *pattern,
+                          const char *haystack) {
+  if (pattern == NULL || haystack == NULL) {
+    return 0;
+  }
+
+  if (pattern->length == 0) {
+    return 1;
+  }
+
+  if (activeKernel == NULL) {
+    selectKernel();
+  }
+
+  return activeKernel(pattern, haystack);
+}
+
+/* Get the name of the kernel selected for this CPU */
+const char *getSubstringKernelName(void) {
+  if (activeKernel == NULL) {
+    selectKernel();
+  }
+  return activeKernelName;
+}
@@ -0,0 +1,22 @@
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include "types.h"
+
+/* Pre-processed needle for repeated case-insensitive substring matching */
+typedef struct {
+  char needle[MAX_STRING_LENGTH]; /* Lowercased needle */
+  int length;                     /* Needle length */
+  unsigned char firstLower;       /* First byte, lowercase */
+  unsigned char firstUpper;       /* First byte, uppercase */
+} SubstringPattern;
+
+/* Prepare a needle once, then match it against many haystacks */
+void prepareSubstringPattern(SubstringPattern *pattern, const char *needle);
+int matchSubstringPattern(const SubstringPattern *pattern,
+                          const char *haystack);
+
+/* Name of the kernel selected for this CPU ("avx2", "sse2" or "scalar") */
+const char *getSubstringKernelName(void);
+
+#endif /* TEXTSEARCH_H */
@@ -0,0 +1,661 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L /* pread, pwrite, fileno */
+#endif
+
+#include "textstore.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#define INITIAL_ARENA_SIZE 65536
+#define INITIAL_TOKEN_SLOTS 4096
+#define COMPACT_MIN_DEAD_BYTES 16384
+
+/* Encoded byte layout (compressed mode):
+   0x01 b      escaped literal byte b (control or non-ASCII)
+   0x02..0x7F  literal ASCII character
+   0x80..0xFE  dictionary entry 0..126
+   0xFF n      dictionary entry 127 + n */
+#define ESCAPE_BYTE 0x01
+#define FIRST_CODE_BYTE 0x80
+#define TWO_BYTE_PREFIX 0xFF
+#define ONE_BYTE_CODES 127
+
+/* Token frequency entry used while training the dictionary */
+typedef struct {
+  const char *text; /* Points into the training texts (NULL = empty) */
+  int length;
+  long count;
+} TokenCount;
+
+/* Growable open-addressing table of token counts */
+typedef struct {
+  TokenCount *slots;
+  long slotCount; /* Power of two */
+  long used;
+} TokenTable;
+
+/* Sink for the decode benchmark so the loop is not optimised away */
+static unsigned long decodeChecksum = 0;
+
+/* FNV-1a hash of a byte range */
+static unsigned long hashBytes(const char *text, int length) {
+  unsigned long hash = 2166136261UL;
+  int i;
+
+  for (i = 0; i < length; i++) {
+    hash ^= (unsigned long)(unsigned char)text[i];
+    hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+  }
+
+  return hash;
+}
+
+/* Dictionary entry holding exactly text[0..length), or -1 */
+static int findEntry(const TextStore *store, const char *text, int length) {
+  unsigned long slot = hashBytes(text, length) & (TEXT_HASH_SLOTS - 1);
+  int id;
+
+  while ((id = store->slots[slot]) != 0) {
+    id--;
+    if (store->entryStart[id + 1] - store->entryStart[id] == length &&
+        memcmp(store->entries + store->entryStart[id], text, length) == 0) {
+      return id;
+    }
+    slot = (slot + 1) & (TEXT_HASH_SLOTS - 1);
+  }
+
+  return -1;
+}
+
+/* Append a dictionary entry */
+static int addEntry(TextStore *store, const char *text, int length) {
+  unsigned long slot;
+  int start;
+
+  if (store->entryCount >= TEXT_DICTIONARY_SIZE ||
+      length > TEXT_ENTRY_LENGTH) {
+    return 0;
+  }
+
+  start = store->entryStart[store->entryCount];
+  memcpy(store->entries + start, text, length);
+  store->entryStart[store->entryCount + 1] = start + length;
+
+  slot = hashBytes(text, length) & (TEXT_HASH_SLOTS - 1);
+  while (store->slots[slot] != 0) {
+    slot = (slot + 1) & (TEXT_HASH_SLOTS - 1);
+  }
+  store->slots[slot] = store->entryCount + 1;
+  store->entryCount++;
+  return 1;
+}
+
+/* Initialise an empty store */
+void initTextStore(TextStore *store, TextStoreMode mode) {
+  if (store == NULL) {
+    return;
+  }
+
+  store->mode = mode;
+  store->data = NULL;
+  store->file = NULL;
+  store->used = 0;
+  store->capacity = 0;
+  store->deadBytes = 0;
+  store->entryCount = 0;
+  store->entryStart[0] = 0;
+  memset(store->slots, 0, sizeof(store->slots));
+}
+
+/* Release the arena and side file, keeping the mode */
+void freeTextStore(TextStore *store) {
+  if (store == NULL) {
+    return;
+  }
+
+  free(store->data);
+  if (store->file != NULL) {
+    fclose(store->file);
+  }
+  initTextStore(store, store->mode);
+}
+
+/* Append bytes to the side file (created on first use, removed on exit) */
+static int appendToFile(TextStore *store, const char *text, int length) {
+  if (store->file == NULL) {
+    store->file = tmpfile();
+    if (store->file == NULL) {
+      printf("Error: Could not create the description file.\n");
+      return 0;
+    }
+  }
+
+#ifndef _WIN32
+  /* Unbuffered, so reads through the descriptor see it straight away */
+  if (pwrite(fileno(store->file), text, length, (off_t)store->used) !=
+      (ssize_t)length) {
+#else
+  /* Reads move the file position, so always seek before writing */
+  if (fseek(store->file, store->used, SEEK_SET) != 0 ||
+      fwrite(text, 1, length, store->file) != (size_t)length) {
+#endif
+    printf("Error: Could not write to the description file.\n");
+    return 0;
+  }
+
+  return 1;
+}
+
+/* Read a stored text back from the side file - pread leaves the file
+   position alone, so loads on a const store do not race each other */
+static int readFromFile(const TextStore *store, const TextRef *ref,
+                        char *buffer) {
+  if (store->file == NULL) {
+    return 0;
+  }
+#ifndef _WIN32
+  return pread(fileno(store->file), buffer, ref->length,
+               (off_t)ref->offset) == (ssize_t)ref->length;
+#else
+  return fseek(store->file, ref->offset, SEEK_SET) == 0 &&
+         fread(buffer, 1, ref->length, store->file) == (size_t)ref->length;
+#endif
+}
+
+/* Make room for extra bytes at the end of the arena */
+static int reserveBytes(TextStore *store, long extra) {
+  unsigned char *data;
+  long capacity = (store->capacity > 0) ? store->capacity : INITIAL_ARENA_SIZE;
+
+  while (store->used + extra > capacity) {
+    capacity *= 2;
+  }
+
+  if (capacity != store->capacity) {
+    data = (unsigned char *)realloc(store->data, capacity);
+    if (data == NULL) {
+      return 0;
+    }
+    store->data = data;
+    store->capacity = capacity;
+  }
+
+  return 1;
+}
+
+/* Length of the word token at text - an optional leading space followed by
+   a run of letters (0 if text does not start one) */
+static int tokenLength(const char *text, int available) {
+  int length = (text[0] == ' ') ? 1 : 0;
+
+  if (length >= available || !isalpha((unsigned char)text[length])) {
+    return 0;
+  }
+  while (length < available && isalpha((unsigned char)text[length])) {
+    length++;
+  }
+
+  return length;
+}
+
+/* Emit one literal byte */
+static int encodeLiteral(unsigned char *out, unsigned char c) {
+  if (c <= ESCAPE_BYTE || c >= FIRST_CODE_BYTE) {
+    out[0] = ESCAPE_BYTE;
+    out[1] = c;
+    return 2;
+  }
+  out[0] = c;
+  return 1;
+}
+
+/* Emit a dictionary reference */
+static int encodeEntry(unsigned char *out, int id) {
+  if (id < ONE_BYTE_CODES) {
+    out[0] = (unsigned char)(FIRST_CODE_BYTE + id);
+    return 1;
+  }
+  out[0] = TWO_BYTE_PREFIX;
+  out[1] = (unsigned char)(id - ONE_BYTE_CODES);
+  return 2;
+}
+
+/* Dictionary-encode text into out (2 * length bytes), returns the size */
+static int encodeText(const TextStore *store, const char *text, int length,
+                      unsigned char *out) {
+  int in = 0, size = 0;
+  int token, id, i;
+
+  while (in < length) {
+    token = (store->entryCount > 0) ? tokenLength(text + in, length - in) : 0;
+
+    if (token == 0) {
+      size += encodeLiteral(out + size, (unsigned char)text[in++]);
+      continue;
+    }
+
+    /* Prefer the spaced form of a word, then the bare form */
+    id = findEntry(store, text + in, token);
+    if (id < 0 && text[in] == ' ') {
+      id = findEntry(store, text + in + 1, token - 1);
+      if (id >= 0) {
+        size += encodeLiteral(out + size, ' ');
+        in++;
+        token--;
+      }
+    }
+
+    if (id >= 0) {
+      size += encodeEntry(out + size, id);
+    } else {
+      for (i = 0; i < token; i++) {
+        size += encodeLiteral(out + size, (unsigned char)text[in + i]);
+      }
+    }
+    in += token;
+  }
+
+  return size;
+}
+
+/* Append a text to the store */
+int storeText(TextStore *store, const char *text, TextRef *ref) {
+  unsigned char encoded[2 * MAX_DESCRIPTION_LENGTH];
+  int length, size;
+
+  if (store == NULL || text == NULL || ref == NULL) {
+    return 0;
+  }
+
+  ref->offset = 0;
+  ref->length = 0;
+  ref->rawLength = 0;
+
+  length = (int)strlen(text);
+  if (length > MAX_DESCRIPTION_LENGTH - 1) {
+    length = MAX_DESCRIPTION_LENGTH - 1;
+  }
+  if (length == 0) {
+    return 1; /* Empty texts take no space */
+  }
+
+  if (store->mode == TEXT_STORE_DISK) {
+    if (!appendToFile(store, text, length)) {
+      return 0;
+    }
+    ref->offset = store->used;
+    ref->length = length;
+    ref->rawLength = length;
+    store->used += length;
+    return 1;
+  }
+
+  if (store->mode == TEXT_STORE_COMPRESSED) {
+    size = encodeText(store, text, length, encoded);
+  } else {
+    memcpy(encoded, text, length);
+    size = length;
+  }
+
+  if (!reserveBytes(store, size)) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  memcpy(store->data + store->used, encoded, size);
+  ref->offset = store->used;
+  ref->length = size;
+  ref->rawLength = length;
+  store->used += size;
+  return 1;
+}
+
+/* Decode a stored text */
+char *loadText(const TextStore *store, const TextRef *ref, char *buffer) {
+  const unsigned char *in;
+  const unsigned char *end;
+  int size = 0;
+  int id, length;
+
+  if (buffer == NULL) {
+    return NULL;
+  }
+  buffer[0] = '\0';
+
+  if (store == NULL || ref == NULL || ref->length == 0) {
+    return buffer;
+  }
+
+  /* Cold texts are read back from the side file on demand */
+  if (store->mode == TEXT_STORE_DISK) {
+    if (readFromFile(store, ref, buffer)) {
+      buffer[ref->length] = '\0';
+    }
+    return buffer;
+  }
+
+  if (store->data == NULL) {
+    return buffer;
+  }
+
+  in = store->data + ref->offset;
+
+  if (store->mode == TEXT_STORE_PLAIN) {
+    memcpy(buffer, in, ref->length);
+    buffer[ref->length] = '\0';
+    return buffer;
+  }
+
+  end = in + ref->length;
+  while (in < end && size < MAX_DESCRIPTION_LENGTH - 1) {
+    if (*in >= FIRST_CODE_BYTE) {
+      if (*in == TWO_BYTE_PREFIX) {
+        id = ONE_BYTE_CODES + in[1];
+        in += 2;
+      } else {
+        id = *in - FIRST_CODE_BYTE;
+        in++;
+      }
+      length = store->entryStart[id + 1] - store->entryStart[id];
+      if (length > MAX_DESCRIPTION_LENGTH - 1 - size) {
+        length = MAX_DESCRIPTION_LENGTH - 1 - size;
+      }
+      memcpy(buffer + size, store->entries + store->entryStart[id], length);
+      size += length;
+    } else if (*in == ESCAPE_BYTE) {
+      buffer[size++] = (char)in[1];
+      in += 2;
+    } else {
+      buffer[size++] = (char)*in++;
+    }
+  }
+
+  buffer[size] = '\0';
+  return buffer;
+}
+
+/* Mark a text as deleted */
+int releaseText(TextStore *store, const TextRef *ref) {
+  if (store == NULL || ref == NULL) {
+    return 0;
+  }
+
+  store->deadBytes += ref->length;
+  return store->deadBytes >= COMPACT_MIN_DEAD_BYTES &&
+         store->deadBytes * 2 > store->used;
+}
+
+/* Count one token occurrence, growing the table at half load */
+static int countToken(TokenTable *table, const char *text, int length) {
+  TokenCount *oldSlots;
+  long oldCount, mask, slot, i;
+
+  if (table->used * 2 >= table->slotCount) {
+    oldSlots = table->slots;
+    oldCount = table->slotCount;
+    table->slotCount = oldCount * 2;
+    table->slots =
+        (TokenCount *)calloc(table->slotCount, sizeof(TokenCount));
+    if (table->slots == NULL) {
+      table->slots = oldSlots;
+      table->slotCount = oldCount;
+      return 0;
+    }
+    mask = table->slotCount - 1;
+    for (i = 0; i < oldCount; i++) {
+      if (oldSlots[i].text != NULL) {
+        slot = (long)(hashBytes(oldSlots[i].text, oldSlots[i].length) &
+                      (unsigned long)mask);
+        while (table->slots[slot].text != NULL) {
+          slot = (slot + 1) & mask;
+        }
+        table->slots[slot] = oldSlots[i];
+      }
+    }
+    free(oldSlots);
+  }
+
+  mask = table->slotCount - 1;
+  slot = (long)(hashBytes(text, length) & (unsigned long)mask);
+  while (table->slots[slot].text != NULL) {
+    if (table->slots[slot].length == length &&
+        memcmp(table->slots[slot].text, text, length) == 0) {
+      table->slots[slot].count++;
+      return 1;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  table->slots[slot].text = text;
+  table->slots[slot].length = length;
+  table->slots[slot].count = 1;
+  table->used++;
+  return 1;
+}
+
+/* Bytes saved by a token if it gets a one-byte code */
+static long tokenSavings(const TokenCount *token) {
+  return token->count * (token->length - 1);
+}
+
+/* Order by savings, best first */
+static int compareSavings(const void *a, const void *b) {
+  long savingsA = tokenSavings(*(const TokenCount *const *)a);
+  long savingsB = tokenSavings(*(const TokenCount *const *)b);
+
+  return (savingsA < savingsB) - (savingsA > savingsB);
+}
+
+/* Order by frequency, most frequent first */
+static int compareCount(const void *a, const void *b) {
+  long countA = (*(const TokenCount *const *)a)->count;
+  long countB = (*(const TokenCount *const *)b)->count;
+
+  return (countA < countB) - (countA > countB);
+}
+
+/* Build the shared dictionary from the most valuable word tokens - the
+   most frequent of those get the one-byte codes */
+static int trainDictionary(TextStore *store, char **texts, int textCount) {
+  TokenTable table;
+  TokenCount **candidates;
+  int candidateCount = 0;
+  int i, position, length, token;
+  long slot;
+
+  table.slotCount = INITIAL_TOKEN_SLOTS;
+  table.used = 0;
+  table.slots = (TokenCount *)calloc(table.slotCount, sizeof(TokenCount));
+  if (table.slots == NULL) {
+    return 0;
+  }
+
+  for (i = 0; i < textCount; i++) {
+    length = (int)strlen(texts[i]);
+    position = 0;
+    while (position < length) {
+      token = tokenLength(texts[i] + position, length - position);
+      if (token == 0) {
+        position++;
+        continue;
+      }
+      if (token >= 2 && token <= TEXT_ENTRY_LENGTH &&
+          !countToken(&table, texts[i] + position, token)) {
+        free(table.slots);
+        return 0;
+      }
+      position += token;
+    }
+  }
+
+  candidates = (TokenCount **)malloc((table.used + 1) * sizeof(TokenCount *));
+  if (candidates == NULL) {
+    free(table.slots);
+    return 0;
+  }
+
+  for (slot = 0; slot < table.slotCount; slot++) {
+    if (table.slots[slot].text != NULL && table.slots[slot].count > 1) {
+      candidates[candidateCount++] = &table.slots[slot];
+    }
+  }
+
+  qsort(candidates, candidateCount, sizeof(TokenCount *), compareSavings);
+  if (candidateCount > TEXT_DICTIONARY_SIZE) {
+    candidateCount = TEXT_DICTIONARY_SIZE;
+  }
+  qsort(candidates, candidateCount, sizeof(TokenCount *), compareCount);
+
+  for (i = 0; i < candidateCount; i++) {
+    addEntry(store, candidates[i]->text, candidates[i]->length);
+  }
+
+  free(candidates);
+  free(table.slots);
+  return 1;
+}
+
+/* Re-encode all descriptions into a fresh store */
+int rebuildTextStore(MovieDatabase *db, TextStoreMode mode) {
+  TextStore *fresh;
+  TextRef *refs;
+  char **texts;
+  char buffer[MAX_DESCRIPTION_LENGTH];
+  int i, built = 0, ok = 1;
+
+  if (db == NULL) {
+    return 0;
+  }
+
+  fresh = (TextStore *)malloc(sizeof(TextStore));
+  refs = (TextRef *)malloc((db->count + 1) * sizeof(TextRef));
+  texts = (char **)calloc(db->count + 1, sizeof(char *));
+  if (fresh == NULL || refs == NULL || texts == NULL) {
+    free(fresh);
+    free(refs);
+    free(texts);
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  /* Decode everything first - the dictionary trains on the plain text */
+  for (i = 0; i < db->count && ok; i++) {
+    loadText(&db->text, &db->movies[i].description, buffer);
+    texts[i] = (char *)malloc(strlen(buffer) + 1);
+    if (texts[i] == NULL) {
+      ok = 0;
+    } else {
+      strcpy(texts[i], buffer);
+    }
+  }
+
+  initTextStore(fresh, mode);
+  if (ok && mode == TEXT_STORE_COMPRESSED) {
+    ok = trainDictionary(fresh, texts, db->count);
+  }
+
+  for (i = 0; i < db->count && ok; i++) {
+    ok = storeText(fresh, texts[i], &refs[i]);
+    built++;
+  }
+
+  if (ok) {
+    freeTextStore(&db->text);
+    db->text = *fresh;
+    for (i = 0; i < built; i++) {
+      db->movies[i].description = refs[i];
+    }
+  } else {
+    freeTextStore(fresh);
+    printf("Error: Could not rebuild the description store.\n");
+  }
+
+  for (i = 0; i < db->count; i++) {
+    free(texts[i]);
+  }
+  free(texts);
+  free(refs);
+  free(fresh);
+  return ok;
+}
+
+/* Retrain the shared dictionary on a corpus grown by addedCount movies */
+void retrainTextStore(MovieDatabase *db, long addedCount) {
+  if (addedCount > 0 && db->text.mode == TEXT_STORE_COMPRESSED) {
+    rebuildTextStore(db, db->text.mode);
+  }
+}
+
+/* Collect size statistics and time a full decode of every description */
+void measureTextStore(const MovieDatabase *db, TextStoreStats *stats) {
+  char buffer[MAX_DESCRIPTION_LENGTH];
+  clock_t start, elapsed;
+  long passes = 0;
+  int i;
+
+  if (db == NULL || stats == NULL) {
+    return;
+  }
+
+  stats->textCount = 0;
+  stats->rawBytes = 0;
+  stats->storedBytes = 0;
+  stats->arenaBytes = db->text.capacity;
+  stats->diskBytes = (db->text.mode == TEXT_STORE_DISK) ? db->text.used : 0;
+  stats->dictionaryBytes = db->text.entryStart[db->text.entryCount];
+  stats->ratio = 1.0;
+  stats->decodeMicros = 0.0;
+  stats->decodeMegabytes = 0.0;
+
+  for (i = 0; i < db->count; i++) {
+    if (db->movies[i].description.rawLength > 0) {
+      stats->textCount++;
+      stats->rawBytes += db->movies[i].description.rawLength;
+      stats->storedBytes += db->movies[i].description.length;
+    }
+  }
+
+  if (stats->textCount == 0) {
+    return;
+  }
+
+  stats->ratio = (double)stats->rawBytes /
+                 (double)(stats->storedBytes + stats->dictionaryBytes);
+
+  /* Repeat full passes for at least a twentieth of a second */
+  start = clock();
+  do {
+    for (i = 0; i < db->count; i++) {
+      loadText(&db->text, &db->movies[i].description, buffer);
+      decodeChecksum += (unsigned char)buffer[0];
+    }
+    passes++;
+    elapsed = clock() - start;
+  } while (elapsed < CLOCKS_PER_SEC / 20);
+
+  stats->decodeMicros = (double)elapsed * 1000000.0 / CLOCKS_PER_SEC /
+                        ((double)passes * stats->textCount);
+  stats->decodeMegabytes = (double)stats->rawBytes * passes /
+                           ((double)elapsed / CLOCKS_PER_SEC) / 1000000.0;
+}
+
+/* Get the display name of a storage mode */
+const char *getTextStoreModeName(TextStoreMode mode) {
+  switch (mode) {
+  case TEXT_STORE_PLAIN:
+    return "plain";
+  case TEXT_STORE_COMPRESSED:
+    return "compressed (shared dictionary)";
+  case TEXT_STORE_DISK:
+    return "on disk (loaded on demand)";
+  default:
+    return "unknown";
+  }
+}
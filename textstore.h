@@ -0,0 +1,45 @@
+#ifndef TEXTSTORE_H
+#define TEXTSTORE_H
+
+#include "types.h"
+
+/* Size and speed of the description store */
+typedef struct {
+  int textCount;         /* Stored descriptions */
+  long rawBytes;         /* Decoded size of all descriptions */
+  long storedBytes;      /* Encoded size of the live descriptions */
+  long arenaBytes;       /* Allocated arena, including slack and dead texts */
+  long diskBytes;        /* Side file size (disk mode) */
+  long dictionaryBytes;  /* Shared dictionary size */
+  double ratio;          /* rawBytes / (storedBytes + dictionaryBytes) */
+  double decodeMicros;   /* Average time to decode one description */
+  double decodeMegabytes; /* Decoded megabytes per second */
+} TextStoreStats;
+
+void initTextStore(TextStore *store, TextStoreMode mode);
+void freeTextStore(TextStore *store);
+
+/* Append text (at most MAX_DESCRIPTION_LENGTH - 1 characters) */
+int storeText(TextStore *store, const char *text, TextRef *ref);
+
+/* Decode a text into buffer (MAX_DESCRIPTION_LENGTH bytes), returns buffer.
+   Safe alongside other loads, but not alongside changes to the store; on
+   Windows disk mode seeks the shared side file, so loads need the database
+   lock there too */
+char *loadText(const TextStore *store, const TextRef *ref, char *buffer);
+
+/* Mark a text as deleted, returns 1 when the arena is worth compacting */
+int releaseText(TextStore *store, const TextRef *ref);
+
+/* Re-encode every description in the given mode, retraining the dictionary
+   and dropping deleted texts */
+int rebuildTextStore(MovieDatabase *db, TextStoreMode mode);
+
+/* After an import added movies, retrain the compressed mode's dictionary
+   so the new descriptions share it too (other modes need nothing) */
+void retrainTextStore(MovieDatabase *db, long addedCount);
+
+void measureTextStore(const MovieDatabase *db, TextStoreStats *stats);
+const char *getTextStoreModeName(TextStoreMode mode);
+
+#endif /* TEXTSTORE_H */
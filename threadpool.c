@@ -0,0 +1,279 @@
+#ifdef USE_THREADS
+#define _POSIX_C_SOURCE 200112L /* sysconf */
+#endif
+
+#include "threadpool.h"
+#include <stdlib.h>
+#ifdef USE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifdef USE_THREADS
+
+/* Per-worker deque over a contiguous block of morsel numbers - the owner
+   takes from the bottom, thieves steal from the top */
+typedef struct {
+  pthread_mutex_t lock;
+  int top;    /* Next morsel a thief takes */
+  int bottom; /* One past the next morsel the owner takes */
+} WorkDeque;
+
+/* Process-wide pool, started on first use */
+static struct {
+  int started;
+  int workerCount; /* Including the calling thread */
+  int stopping;
+  int busy; /* A parallelFor is running */
+  pthread_t threads[MAX_POOL_THREADS];
+  WorkDeque deques[MAX_POOL_THREADS];
+  pthread_mutex_t lock;
+  pthread_cond_t wake; /* New job or shutdown */
+  pthread_cond_t done; /* Job finished */
+  unsigned long generation;
+  int pending; /* Morsels not yet finished */
+  int active;  /* Worker threads inside the current job */
+  /* Current job */
+  MorselFunction function;
+  void *context;
+  int count;
+  int morselSize;
+} pool;
+
+/* Guards starting and stopping the pool, so the first parallelFor calls
+   from several threads start it only once */
+static pthread_mutex_t startLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Take a morsel from the bottom of our own deque */
+static int popOwn(int worker, int *morsel) {
+  WorkDeque *deque = &pool.deques[worker];
+  int found = 0;
+
+  pthread_mutex_lock(&deque->lock);
+  if (deque->top < deque->bottom) {
+    *morsel = --deque->bottom;
+    found = 1;
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return found;
+}
+
+/* Steal a morsel from the top of another worker's deque */
+static int stealMorsel(int worker, int *morsel) {
+  WorkDeque *deque;
+  int i, victim;
+
+  for (i = 1; i < pool.workerCount; i++) {
+    victim = (worker + i) % pool.workerCount;
+    deque = &pool.deques[victim];
+    pthread_mutex_lock(&deque->lock);
+    if (deque->top < deque->bottom) {
+      *morsel = deque->top++;
+      pthread_mutex_unlock(&deque->lock);
+      return 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+  }
+
+  return 0;
+}
+
+/* Run morsels until every deque is empty */
+static void workLoop(int worker) {
+  int morsel, begin, end;
+
+  while (popOwn(worker, &morsel) || stealMorsel(worker, &morsel)) {
+    begin = morsel * pool.morselSize;
+    end = begin + pool.morselSize;
+    if (end > pool.count) {
+      end = pool.count;
+    }
+    pool.function(pool.context, begin, end, worker);
+
+    pthread_mutex_lock(&pool.lock);
+    if (--pool.pending == 0) {
+      pthread_cond_broadcast(&pool.done);
+    }
+    pthread_mutex_unlock(&pool.lock);
+  }
+}
+
+/* Worker thread body - sleeps until a job is published */
+static void *workerMain(void *argument) {
+  int worker = (int)(long)argument;
+  unsigned long seen = 0;
+
+  pthread_mutex_lock(&pool.lock);
+  while (1) {
+    while (!pool.stopping && pool.generation == seen) {
+      pthread_cond_wait(&pool.wake, &pool.lock);
+    }
+    if (pool.stopping) {
+      break;
+    }
+    seen = pool.generation;
+    pool.active++;
+    pthread_mutex_unlock(&pool.lock);
+
+    workLoop(worker);
+
+    pthread_mutex_lock(&pool.lock);
+    if (--pool.active == 0) {
+      pthread_cond_broadcast(&pool.done);
+    }
+  }
+  pthread_mutex_unlock(&pool.lock);
+
+  return NULL;
+}
+
+/* Size the pool and start its threads */
+static void startPool(void) {
+  const char *setting = getenv("CINEMANIA_THREADS");
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  int i;
+
+  pool.started = 1;
+  pool.workerCount = (setting != NULL) ? atoi(setting) : (int)processors;
+  if (pool.workerCount < 1) {
+    pool.workerCount = 1;
+  }
+  if (pool.workerCount > MAX_POOL_THREADS) {
+    pool.workerCount = MAX_POOL_THREADS;
+  }
+
+  pthread_mutex_init(&pool.lock, NULL);
+  pthread_cond_init(&pool.wake, NULL);
+  pthread_cond_init(&pool.done, NULL);
+  for (i = 0; i < MAX_POOL_THREADS; i++) {
+    pthread_mutex_init(&pool.deques[i].lock, NULL);
+  }
+
+  /* Worker 0 is whichever thread calls parallelFor */
+  for (i = 1; i < pool.workerCount; i++) {
+    if (pthread_create(&pool.threads[i], NULL, workerMain, (void *)(long)i) !=
+        0) {
+      pool.workerCount = i; /* Run with the threads we got */
+      break;
+    }
+  }
+}
+
+/* Start the pool on first use, from whichever thread gets there first */
+static void ensurePoolStarted(void) {
+  pthread_mutex_lock(&startLock);
+  if (!pool.started) {
+    startPool();
+  }
+  pthread_mutex_unlock(&startLock);
+}
+
+/* Report the pool size, starting the pool if needed */
+int getPoolWorkerCount(void) {
+  ensurePoolStarted();
+  return pool.workerCount;
+}
+
+/* Publish the morsels to the workers and take part from the calling
+   thread, or run them inline when the pool cannot help */
+void parallelFor(int count, int morselSize, MorselFunction function,
+                 void *context) {
+  int morselCount, worker, begin;
+
+  if (count <= 0 || function == NULL) {
+    return;
+  }
+  if (morselSize < 1) {
+    morselSize = 1;
+  }
+  morselCount = (count + morselSize - 1) / morselSize;
+
+  ensurePoolStarted();
+
+  pthread_mutex_lock(&pool.lock);
+  if (pool.busy || pool.workerCount == 1 || morselCount == 1) {
+    pthread_mutex_unlock(&pool.lock);
+    for (begin = 0; begin < count; begin += morselSize) {
+      function(context, begin,
+               (begin + morselSize < count) ? begin + morselSize : count, 0);
+    }
+    return;
+  }
+
+  /* Publish the job - each worker owns a contiguous block of morsels */
+  pool.busy = 1;
+  pool.function = function;
+  pool.context = context;
+  pool.count = count;
+  pool.morselSize = morselSize;
+  pool.pending = morselCount;
+  for (worker = 0; worker < pool.workerCount; worker++) {
+    pthread_mutex_lock(&pool.deques[worker].lock);
+    pool.deques[worker].top =
+        (int)((long)morselCount * worker / pool.workerCount);
+    pool.deques[worker].bottom =
+        (int)((long)morselCount * (worker + 1) / pool.workerCount);
+    pthread_mutex_unlock(&pool.deques[worker].lock);
+  }
+  pool.generation++;
+  pthread_cond_broadcast(&pool.wake);
+  pthread_mutex_unlock(&pool.lock);
+
+  workLoop(0);
+
+  /* Wait for the morsels and for the workers to leave the job */
+  pthread_mutex_lock(&pool.lock);
+  while (pool.pending > 0 || pool.active > 0) {
+    pthread_cond_wait(&pool.done, &pool.lock);
+  }
+  pool.busy = 0;
+  pthread_mutex_unlock(&pool.lock);
+}
+
+/* Wake the workers with the stop flag and join them */
+void shutdownThreadPool(void) {
+  int i;
+
+  pthread_mutex_lock(&startLock);
+  if (!pool.started) {
+    pthread_mutex_unlock(&startLock);
+    return;
+  }
+
+  pthread_mutex_lock(&pool.lock);
+  pool.stopping = 1;
+  pthread_cond_broadcast(&pool.wake);
+  pthread_mutex_unlock(&pool.lock);
+
+  for (i = 1; i < pool.workerCount; i++) {
+    pthread_join(pool.threads[i], NULL);
+  }
+  pool.started = 0;
+  pool.stopping = 0;
+  pthread_mutex_unlock(&startLock);
+}
+
+#else /* Sequential fallback */
+
+int getPoolWorkerCount(void) { return 1; }
+
+void parallelFor(int count, int morselSize, MorselFunction function,
+                 void *context) {
+  int begin;
+
+  if (count <= 0 || function == NULL) {
+    return;
+  }
+  if (morselSize < 1) {
+    morselSize = 1;
+  }
+
+  for (begin = 0; begin < count; begin += morselSize) {
+    function(context, begin,
+             (begin + morselSize < count) ? begin + morselSize : count, 0);
+  }
+}
+
+void shutdownThreadPool(void) {}
+
+#endif
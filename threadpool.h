@@ -0,0 +1,26 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#define MAX_POOL_THREADS 16
+
+/* Work on one morsel [begin, end) of a parallel loop; worker identifies the
+   calling thread (0 .. getPoolWorkerCount() - 1) */
+typedef void (*MorselFunction)(void *context, int begin, int end,
+                               int worker);
+
+/* Split [0, count) into morsels of morselSize items and run them on the
+   pool, returning once all are done. Morsel boundaries are multiples of
+   morselSize. Runs inline when threads are unavailable or the pool is
+   already busy (nested calls, or another thread's job). Safe to call from
+   any thread; the first call starts the pool */
+void parallelFor(int count, int morselSize, MorselFunction function,
+                 void *context);
+
+/* Threads taking part in parallelFor, including the caller. Defaults to
+   the number of online processors, overridable with CINEMANIA_THREADS */
+int getPoolWorkerCount(void);
+
+/* Stop and join the worker threads */
+void shutdownThreadPool(void);
+
+#endif /* THREADPOOL_H */
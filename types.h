@@ -1,6 +1,8 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <stdio.h>
+
 /* Maximum capacity constraints */
 #define MAX_MOVIES 2000
 #define MAX_STRING_LENGTH 256
@@ -9,9 +11,21 @@
 #define MAX_ACTORS_PER_MOVIE 50
 #define MAX_ACTOR_NAME_LENGTH 100
 
+/* Valid release year range (cinema started around 1888) */
+#define MIN_YEAR 1888
+#define MAX_YEAR 2100
+#define YEAR_BUCKETS (MAX_YEAR - MIN_YEAR + 1)
+
 /* Pagination */
 #define LINES_PER_PAGE 25
 
+/* Description text store - dictionary of 127 one-byte and 256 two-byte
+   codes, each entry at most TEXT_ENTRY_LENGTH characters */
+#define TEXT_DICTIONARY_SIZE 383
+#define TEXT_ENTRY_LENGTH 31
+#define TEXT_DICTIONARY_BYTES (TEXT_DICTIONARY_SIZE * TEXT_ENTRY_LENGTH)
+#define TEXT_HASH_SLOTS 1024
+
 /* Genre enumeration - corresponds to the 20 genres specified in requirements */
 typedef enum {
   GENRE_ACTION,
@@ -41,13 +55,20 @@ typedef enum {
   GENRE_NONE
 } Genre;
 
+/* Reference to a text held out of line in the database text store */
+typedef struct {
+  long offset;   /* Byte offset of the stored form */
+  int length;    /* Stored (possibly compressed) length in bytes */
+  int rawLength; /* Decoded length in characters */
+} TextRef;
+
 /* Movie structure */
 typedef struct {
   int code;                                 /* Unique code (immutable) */
   char title[MAX_STRING_LENGTH];            /* Movie title */
   Genre genres[MAX_GENRES_PER_MOVIE];       /* Array of genres */
   int genreCount;                           /* Number of genres */
-  char description[MAX_DESCRIPTION_LENGTH]; /* Movie description */
+  TextRef description;                      /* Movie description (db->text) */
   char director[MAX_STRING_LENGTH];         /* Director name */
   char actors[MAX_ACTORS_PER_MOVIE][MAX_ACTOR_NAME_LENGTH]; /* Actor names */
   int actorCount; /* Number of actors */
@@ -58,11 +79,56 @@ typedef struct {
   float revenue;  /* Revenue in millions */
 } Movie;
 
+/* Numeric fields with an ordered secondary index */
+typedef enum {
+  INDEX_YEAR,
+  INDEX_RATING,
+  INDEX_DURATION,
+  INDEX_REVENUE,
+  INDEX_CODE,
+  INDEX_FIELD_COUNT
+} IndexField;
+
+/* Secondary indexes - movie positions ordered by (field value, position) */
+typedef struct {
+  int byField[INDEX_FIELD_COUNT][MAX_MOVIES];
+  /* Year bucket directory: byField[INDEX_YEAR] entries for year y start at
+     yearStart[y - MIN_YEAR] and end at yearStart[y - MIN_YEAR + 1] */
+  int yearStart[YEAR_BUCKETS + 1];
+  int genreCounts[GENRE_NONE]; /* Movies listed under each genre */
+} MovieIndexes;
+
+/* Description storage modes */
+typedef enum {
+  TEXT_STORE_PLAIN,      /* Raw text in memory */
+  TEXT_STORE_COMPRESSED, /* Dictionary-encoded text in memory */
+  TEXT_STORE_DISK        /* Raw text in a side file, read on demand */
+} TextStoreMode;
+
+/* Append-only arena holding the movie descriptions */
+typedef struct {
+  TextStoreMode mode;
+  unsigned char *data; /* Stored texts, back to back (memory modes) */
+  FILE *file;          /* Side file holding the texts (disk mode) */
+  long used;           /* Bytes in use (live and dead) */
+  long capacity;       /* Allocated bytes */
+  long deadBytes;      /* Bytes of deleted texts awaiting compaction */
+  /* Shared dictionary: entry i spans entries[entryStart[i]..entryStart[i+1]]
+     and slots is an open-addressing hash of entry + 1 (0 = empty) */
+  int entryCount;
+  int entryStart[TEXT_DICTIONARY_SIZE + 1];
+  char entries[TEXT_DICTIONARY_BYTES];
+  int slots[TEXT_HASH_SLOTS];
+} TextStore;
+
 /* Movie database structure */
 typedef struct {
   Movie movies[MAX_MOVIES]; /* Array of movies */
   int count;                /* Current number of movies */
   int nextCode;             /* Next available code for new movies */
+  MovieIndexes indexes;     /* Secondary indexes over movies */
+  unsigned long version;    /* Bumped on every change (cache invalidation) */
+  TextStore text;           /* Out-of-line description storage */
 } MovieDatabase;
 
 /* Sort order enumeration */
@@ -76,4 +142,54 @@ typedef enum {
   SEARCH_BY_ACTOR
 } SearchType;
 
+/* Ranking field enumeration (top-K queries) */
+typedef enum {
+  RANK_BY_RATING,
+  RANK_BY_REVENUE,
+  RANK_BY_FAVORITE,
+  RANK_BY_DURATION
+} RankField;
+
+/* Numeric range predicate (e.g. 1990 <= year <= 1999) */
+typedef struct {
+  IndexField field;
+  double min;
+  double max;
+  int minOpen; /* Non-zero if min itself is excluded (field > min) */
+  int maxOpen; /* Non-zero if max itself is excluded (field < max) */
+} RangePredicate;
+
+/* Bulk delete criteria */
+typedef enum {
+  DELETE_BY_GENRE,
+  DELETE_BY_YEAR_RANGE,
+  DELETE_BY_DIRECTOR,
+  DELETE_BY_CODES
+} DeleteCriterion;
+
+/* Movies removed by a bulk delete - only the criterion's fields are used */
+typedef struct {
+  DeleteCriterion criterion;
+  Genre genre;
+  int minYear; /* Inclusive year range */
+  int maxYear;
+  const char *director; /* Case-insensitive exact name */
+  const int *codes;
+  int codeCount;
+} DeletePredicate;
+
+/* Group-by keys for analytics reports */
+typedef enum {
+  GROUP_BY_GENRE,
+  GROUP_BY_DIRECTOR,
+  GROUP_BY_DECADE,
+  GROUP_BY_YEAR
+} GroupBy;
+
+/* Optional filter applied to top-K queries */
+typedef struct {
+  Genre genre; /* GENRE_NONE matches any genre */
+  int year;    /* 0 matches any year */
+} RankFilter;
+
 #endif /* TYPES_H */
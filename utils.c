@@ -1,4 +1,5 @@
 #include "utils.h"
+#include "textsearch.h"
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -19,22 +20,55 @@ const char *getGenreName(Genre genre) {
   return "Unknown";
 }
 
+/* Perfect hash over the lowercase genre names: no two names share a slot of
+   genreSlots, so a lookup is one hash and one comparison. The multipliers
+   were searched offline; changing genreNames means searching again. */
+#define GENRE_HASH_SLOTS 32
+#define MIN_GENRE_NAME_LENGTH 3
+#define MAX_GENRE_NAME_LENGTH 9
+
+static const Genre genreSlots[GENRE_HASH_SLOTS] = {
+    GENRE_NONE,      GENRE_NONE,      GENRE_FANTASY,   GENRE_NONE,
+    GENRE_NONE,      GENRE_MYSTERY,   GENRE_CRIME,     GENRE_NONE,
+    GENRE_WAR,       GENRE_ANIMATION, GENRE_NONE,      GENRE_HORROR,
+    GENRE_ROMANCE,   GENRE_NONE,      GENRE_THRILLER,  GENRE_DRAMA,
+    GENRE_WESTERN,   GENRE_COMEDY,    GENRE_NONE,      GENRE_NONE,
+    GENRE_HISTORY,   GENRE_NONE,      GENRE_FAMILY,    GENRE_SPORT,
+    GENRE_ACTION,    GENRE_NONE,      GENRE_ADVENTURE, GENRE_MUSIC,
+    GENRE_MUSICAL,   GENRE_SCI_FI,    GENRE_BIOGRAPHY, GENRE_NONE};
+
+/* ASCII lowercase, independent of the locale */
+static int foldCase(char c) {
+  return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : (unsigned char)c;
+}
+
 /* Convert string to genre enum (case insensitive) */
 Genre getGenreFromString(const char *genreStr) {
-  int i;
-  char lowerStr[MAX_STRING_LENGTH];
-  char lowerGenre[MAX_STRING_LENGTH];
+  const char *name;
+  unsigned int hash;
+  size_t length, i;
+  Genre genre;
+
+  length = strlen(genreStr);
+  if (length < MIN_GENRE_NAME_LENGTH || length > MAX_GENRE_NAME_LENGTH) {
+    return GENRE_NONE;
+  }
 
-  toLowerString(lowerStr, genreStr);
+  hash = (unsigned int)(length * 12 + foldCase(genreStr[0]) * 13 +
+                        foldCase(genreStr[1]) * 7 +
+                        foldCase(genreStr[length - 1]));
+  genre = genreSlots[hash % GENRE_HASH_SLOTS];
+  if (genre == GENRE_NONE) {
+    return GENRE_NONE;
+  }
 
-  for (i = GENRE_ACTION; i <= GENRE_WESTERN; i++) {
-    toLowerString(lowerGenre, genreNames[i]);
-    if (strcmp(lowerStr, lowerGenre) == 0) {
-      return (Genre)i;
+  name = genreNames[genre];
+  for (i = 0; i <= length; i++) {
+    if (foldCase(genreStr[i]) != foldCase(name[i])) {
+      return GENRE_NONE;
     }
   }
-
-  return GENRE_NONE;
+  return genre;
 }
 
 /* Print list of all available genres */
@@ -87,15 +121,13 @@ void toLowerString(char *dest, const char *src) {
   dest[i] = '\0';
 }
 
-/* Case-insensitive substring search */
+/* Case-insensitive substring search (callers matching one needle against
+   many haystacks should prepare a SubstringPattern once instead) */
 int containsSubstring(const char *haystack, const char *needle) {
-  char lowerHaystack[MAX_DESCRIPTION_LENGTH];
-  char lowerNeedle[MAX_STRING_LENGTH];
-
-  toLowerString(lowerHaystack, haystack);
-  toLowerString(lowerNeedle, needle);
+  SubstringPattern pattern;
 
-  return (strstr(lowerHaystack, lowerNeedle) != NULL);
+  prepareSubstringPattern(&pattern, needle);
+  return matchSubstringPattern(&pattern, haystack);
 }
 
 /* Read integer with validation */
@@ -177,7 +209,7 @@ int readConfirmation(const char *prompt) {
 
 /* Validation functions */
 int isValidYear(int year) {
-  return year >= 1888 && year <= 2100; /* Cinema started around 1888 */
+  return year >= MIN_YEAR && year <= MAX_YEAR;
 }
 
 int isValidDuration(int duration) {
@@ -205,11 +237,18 @@ void pauseScreen(void) {
 }
 
 void printLine(int length) {
-  int i;
-  for (i = 0; i < length; i++) {
-    printf("-");
+  static const char dashes[] = "----------------------------------------"
+                               "----------------------------------------";
+  int chunk;
+
+  /* Emit dashes in blocks rather than one printf per character */
+  while (length > 0) {
+    chunk = length < (int)(sizeof(dashes) - 1) ? length
+                                               : (int)(sizeof(dashes) - 1);
+    fwrite(dashes, 1, chunk, stdout);
+    length -= chunk;
   }
-  printf("\n");
+  putchar('\n');
 }
 
 void printHeader(const char *title) {
@@ -0,0 +1,703 @@
+#define _POSIX_C_SOURCE 200809L /* stat, st_mtim, poll */
+
+#include "watch.h"
+#include "bgimport.h"
+#include "compress.h"
+#include "fileio.h"
+#include "movie.h"
+#include "textstore.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#ifdef USE_THREADS
+#include <pthread.h>
+#endif
+#if defined(USE_THREADS) && defined(__linux__)
+#define USE_INOTIFY
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/* Sub-second part of the modification time - st_mtim is POSIX.1-2008,
+   elsewhere only whole seconds are compared */
+#if defined(_WIN32) || defined(__APPLE__)
+#define MODIFIED_NANOS(info) 0L
+#else
+#define MODIFIED_NANOS(info) ((long)(info).st_mtim.tv_nsec)
+#endif
+
+/* Milliseconds between stop checks while waiting for inotify events */
+#define WATCH_STOP_CHECK_MS 500
+
+/* Result of reading one physical line */
+typedef enum {
+  WATCH_LINE_COMPLETE, /* Terminated line */
+  WATCH_LINE_TOO_LONG, /* Terminated, but longer than the buffer */
+  WATCH_LINE_PARTIAL,  /* Unterminated last line, still being written */
+  WATCH_LINE_END
+} WatchLine;
+
+/* Code seen in the file, with the hash of its line */
+typedef struct {
+  int code;           /* 0 marks a free slot (codes start at 1) */
+  unsigned long hash; /* 0 when the row could not be applied */
+  unsigned int scan; /* Last scan that saw the code */
+} WatchEntry;
+
+/* Valid row to add once the scan is done */
+typedef struct {
+  Movie movie;
+  char description[MAX_DESCRIPTION_LENGTH];
+  int replaces; /* Changed line of a code already applied */
+} PendingMovie;
+
+/* Process-wide watch, at most one file at a time. Only touched with the
+   database lock held, except status (watchLock) */
+static struct {
+  int active;
+  char filename[MAX_STRING_LENGTH];
+  MovieDatabase *db;
+  StreamFormat format;
+  /* Open-addressing table from code to line hash */
+  WatchEntry *entries;
+  int capacity; /* Power of two */
+  int used;
+  unsigned int scan; /* Current full scan */
+  /* What the last sync saw */
+  long syncedSize;        /* End of the last complete line applied */
+  unsigned long tailHash; /* Hash of the bytes just before syncedSize */
+  long size;
+  time_t modified;
+  long modifiedNanos;
+  int retry; /* Rows failed to apply, so the next sync diffs in full */
+  dev_t device;
+  ino_t inode;
+  /* Changes collected by a scan */
+  PendingMovie *pending;
+  int pendingCount;
+  int pendingCapacity;
+  int *removals; /* Codes to delete, gone or changed */
+  int removalCount;
+  int removalCapacity;
+  WatchStatus status;
+#ifdef USE_THREADS
+  int threaded;
+  int stopping;
+  pthread_t thread;
+  int notifyFd; /* -1 when polling */
+#endif
+} watch;
+
+#ifdef USE_THREADS
+static pthread_mutex_t watchLock = PTHREAD_MUTEX_INITIALIZER;
+/* Signalled when the watcher thread should stop */
+static pthread_cond_t watchStop = PTHREAD_COND_INITIALIZER;
+#endif
+
+/* FNV-1a over a line, ignoring its line ending */
+static unsigned long hashLine(const char *line) {
+  unsigned long hash = 2166136261UL;
+
+  while (*line != '\0' && *line != '\n' && *line != '\r') {
+    hash ^= (unsigned char)*line++;
+    hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+  }
+  return hash;
+}
+
+/* Hash of the bytes [start, end) of the file, 0 if they cannot be read */
+static unsigned long hashFileRange(const char *filename, long start,
+                                   long end) {
+  char buffer[WATCH_TAIL_BYTES];
+  unsigned long hash = 2166136261UL;
+  size_t length, i;
+  FILE *file;
+
+  file = fopen(filename, "rb");
+  if (file == NULL) {
+    return 0;
+  }
+  length = (size_t)(end - start);
+  if (fseek(file, start, SEEK_SET) != 0 ||
+      fread(buffer, 1, length, file) != length) {
+    fclose(file);
+    return 0;
+  }
+  fclose(file);
+
+  for (i = 0; i < length; i++) {
+    hash ^= (unsigned char)buffer[i];
+    hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+  }
+  return hash;
+}
+
+static long tailStart(long end) {
+  return end > WATCH_TAIL_BYTES ? end - WATCH_TAIL_BYTES : 0;
+}
+
+static WatchEntry *findEntry(int code) {
+  unsigned int mask = (unsigned int)watch.capacity - 1;
+  unsigned int slot = ((unsigned int)code * 2654435761U) & mask;
+
+  while (watch.entries[slot].code != 0) {
+    if (watch.entries[slot].code == code) {
+      return &watch.entries[slot];
+    }
+    slot = (slot + 1) & mask;
+  }
+  return NULL;
+}
+
+/* Rehash into capacity slots, keeping entries seen by keepScan (or all
+   when keepScan is 0) */
+static int resizeTable(int capacity, unsigned int keepScan) {
+  WatchEntry *old = watch.entries;
+  int oldCapacity = watch.capacity;
+  unsigned int mask = (unsigned int)capacity - 1;
+  unsigned int slot;
+  int i;
+
+  watch.entries = (WatchEntry *)calloc((size_t)capacity, sizeof(WatchEntry));
+  if (watch.entries == NULL) {
+    watch.entries = old;
+    return 0;
+  }
+  watch.capacity = capacity;
+  watch.used = 0;
+
+  for (i = 0; i < oldCapacity; i++) {
+    if (old[i].code == 0 || (keepScan != 0 && old[i].scan != keepScan)) {
+      continue;
+    }
+    slot = ((unsigned int)old[i].code * 2654435761U) & mask;
+    while (watch.entries[slot].code != 0) {
+      slot = (slot + 1) & mask;
+    }
+    watch.entries[slot] = old[i];
+    watch.used++;
+  }
+  free(old);
+  return 1;
+}
+
+static WatchEntry *insertEntry(int code) {
+  unsigned int mask, slot;
+
+  /* Keep the load under 3/4 */
+  if ((watch.used + 1) * 4 > watch.capacity * 3 &&
+      !resizeTable(watch.capacity * 2, 0)) {
+    return NULL;
+  }
+
+  mask = (unsigned int)watch.capacity - 1;
+  slot = ((unsigned int)code * 2654435761U) & mask;
+  while (watch.entries[slot].code != 0) {
+    slot = (slot + 1) & mask;
+  }
+  watch.entries[slot].code = code;
+  watch.used++;
+  return &watch.entries[slot];
+}
+
+/* Make room for one more element, doubling the capacity. Returns the
+   (possibly moved) array, or NULL with items left as they were */
+static void *growArray(void *items, int *capacity, int count, size_t size) {
+  void *grown;
+  int wanted;
+
+  if (count < *capacity) {
+    return items;
+  }
+  wanted = *capacity == 0 ? 16 : *capacity * 2;
+  grown = realloc(items, (size_t)wanted * size);
+  if (grown != NULL) {
+    *capacity = wanted;
+  }
+  return grown;
+}
+
+static int addRemoval(int code) {
+  int *grown = (int *)growArray(watch.removals, &watch.removalCapacity,
+                                watch.removalCount, sizeof(int));
+
+  if (grown == NULL) {
+    return 0;
+  }
+  watch.removals = grown;
+  watch.removals[watch.removalCount++] = code;
+  return 1;
+}
+
+/* Read one physical line, skipping the rest of lines too long for the
+   buffer */
+static WatchLine readWatchedLine(LineReader *reader, char *buffer, int size) {
+  size_t length;
+
+  if (readLine(reader, buffer, size) == NULL) {
+    return WATCH_LINE_END;
+  }
+  length = strlen(buffer);
+  if (length > 0 && buffer[length - 1] == '\n') {
+    return WATCH_LINE_COMPLETE;
+  }
+
+  while (readLine(reader, buffer, size) != NULL) {
+    length = strlen(buffer);
+    if (length > 0 && buffer[length - 1] == '\n') {
+      return WATCH_LINE_TOO_LONG;
+    }
+  }
+  return WATCH_LINE_PARTIAL;
+}
+
+/* Compare one data line with what the table knows about its code, and
+   queue the row if it is new or changed */
+static void scanLine(char *line, long *rejected) {
+  unsigned long hash = hashLine(line);
+  PendingMovie *row;
+  WatchEntry *entry;
+  CsvRowStatus status;
+  int replaces;
+
+  row = (PendingMovie *)growArray(watch.pending, &watch.pendingCapacity,
+                                  watch.pendingCount, sizeof(PendingMovie));
+  if (row == NULL) {
+    (*rejected)++;
+    return;
+  }
+  watch.pending = row;
+  row = &watch.pending[watch.pendingCount];
+
+  status = parseMovieCSVLine(line, &row->movie, row->description);
+  if (status == CSV_ROW_BAD_CODE) {
+    (*rejected)++;
+    return;
+  }
+
+  entry = findEntry(row->movie.code);
+  if (entry != NULL && entry->scan == watch.scan) {
+    return; /* Later line with the same code, the first one wins */
+  }
+  if (entry != NULL && entry->hash == hash) {
+    entry->scan = watch.scan;
+    return;
+  }
+
+  replaces = entry != NULL && entry->hash != 0;
+  if (entry == NULL) {
+    entry = insertEntry(row->movie.code);
+    if (entry == NULL) {
+      (*rejected)++;
+      return;
+    }
+  }
+  entry->hash = hash;
+  entry->scan = watch.scan;
+
+  /* An invalid new version leaves the applied one in place */
+  if (status != CSV_ROW_OK || checkMovieData(&row->movie) != NULL) {
+    (*rejected)++;
+    return;
+  }
+  /* Loaded before the watch started, kept until its line changes */
+  if (!replaces && movieCodeExists(watch.db, row->movie.code)) {
+    return;
+  }
+  if (replaces && !addRemoval(row->movie.code)) {
+    (*rejected)++;
+    return;
+  }
+
+  row->replaces = replaces;
+  watch.pendingCount++;
+}
+
+/* Scan lines up to the end of the file, remembering where the last
+   complete one ends */
+static void scanLines(LineReader *reader, long *rejected) {
+  char line[4096];
+  WatchLine result;
+
+  for (;;) {
+    result = readWatchedLine(reader, line, sizeof(line));
+    if (result == WATCH_LINE_END || result == WATCH_LINE_PARTIAL) {
+      break;
+    }
+    if (result == WATCH_LINE_COMPLETE && strlen(line) > 1) {
+      scanLine(line, rejected);
+    } else if (result == WATCH_LINE_TOO_LONG) {
+      (*rejected)++;
+    }
+    watch.syncedSize = getLineReaderOffset(reader);
+  }
+}
+
+/* Diff the whole file against the table */
+static int scanWholeFile(long *rejected, long *removed) {
+  char header[4096];
+  LineReader reader;
+  int i, code;
+
+  if (!openLineReader(&reader, watch.filename)) {
+    return 0;
+  }
+  watch.format = reader.format;
+
+  /* A new scan number, clearing the marks when it wraps */
+  if (++watch.scan == 0) {
+    for (i = 0; i < watch.capacity; i++) {
+      watch.entries[i].scan = 0;
+    }
+    watch.scan = 1;
+  }
+
+  watch.syncedSize = 0;
+  if (readWatchedLine(&reader, header, sizeof(header)) !=
+      WATCH_LINE_PARTIAL) {
+    watch.syncedSize = getLineReaderOffset(&reader);
+    scanLines(&reader, rejected);
+  }
+  closeLineReader(&reader);
+
+  /* Codes the scan did not see have gone from the file */
+  for (i = 0; i < watch.capacity; i++) {
+    code = watch.entries[i].code;
+    if (code != 0 && watch.entries[i].scan != watch.scan &&
+        movieCodeExists(watch.db, code)) {
+      if (addRemoval(code)) {
+        (*removed)++;
+      }
+    }
+  }
+  resizeTable(watch.capacity, watch.scan);
+  return 1;
+}
+
+/* Scan only what was appended after the synced offset */
+static int scanAppended(long *rejected) {
+  LineReader reader;
+
+  if (!openLineReader(&reader, watch.filename)) {
+    return 0;
+  }
+  if (reader.format != STREAM_PLAIN ||
+      fseek(reader.file, watch.syncedSize, SEEK_SET) != 0) {
+    closeLineReader(&reader);
+    return 0;
+  }
+  scanLines(&reader, rejected);
+  closeLineReader(&reader);
+  return 1;
+}
+
+/* Apply the queued removals and rows, then add the counts to the status.
+   Changed rows go first, into the room their removals made, so new rows
+   cannot crowd them out */
+static void applyChanges(MovieDatabase *db, int appended, long rejected,
+                         long removed) {
+  DeletePredicate predicate;
+  PendingMovie *row;
+  WatchEntry *entry;
+  long added = 0, changed = 0;
+  int i, pass;
+
+  if (watch.removalCount > 0) {
+    predicate.criterion = DELETE_BY_CODES;
+    predicate.codes = watch.removals;
+    predicate.codeCount = watch.removalCount;
+    deleteMatchingMovies(db, &predicate);
+  }
+
+  for (pass = 1; pass >= 0; pass--) {
+    for (i = 0; i < watch.pendingCount; i++) {
+      row = &watch.pending[i];
+      if (row->replaces != pass) {
+        continue;
+      }
+      if (db->count < MAX_MOVIES && !movieCodeExists(db, row->movie.code) &&
+          addMovie(db, &row->movie, row->description)) {
+        if (row->replaces) {
+          changed++;
+        } else {
+          added++;
+        }
+        continue;
+      }
+      /* Forget the line so the next sync tries it again */
+      entry = findEntry(row->movie.code);
+      if (entry != NULL) {
+        entry->hash = 0;
+      }
+      watch.retry = 1;
+      rejected++;
+    }
+  }
+
+  retrainTextStore(db, added + changed);
+
+  watch.pendingCount = 0;
+  watch.removalCount = 0;
+
+#ifdef USE_THREADS
+  pthread_mutex_lock(&watchLock);
+#endif
+  if (appended) {
+    watch.status.appendScans++;
+  } else {
+    watch.status.fullScans++;
+  }
+  watch.status.added += added;
+  watch.status.changed += changed;
+  watch.status.removed += removed;
+  watch.status.rejected += rejected;
+#ifdef USE_THREADS
+  pthread_mutex_unlock(&watchLock);
+#endif
+}
+
+/* Bring db in step with the file. Appends are read from the synced
+   offset when the file grew in place and the bytes before that offset
+   still match, anything else is diffed in full. Returns 0 if the file
+   could not be read */
+static int syncWatchedFile(MovieDatabase *db, int force) {
+  struct stat info;
+  long rejected = 0, removed = 0, previousSize = watch.size;
+  int sameFile, appended = 0;
+
+  if (stat(watch.filename, &info) != 0) {
+    return 0; /* Gone for now, e.g. while being replaced */
+  }
+  sameFile = info.st_dev == watch.device && info.st_ino == watch.inode;
+  if (!force && sameFile && (long)info.st_size == watch.size &&
+      info.st_mtime == watch.modified &&
+      MODIFIED_NANOS(info) == watch.modifiedNanos) {
+    return 1;
+  }
+
+  watch.size = (long)info.st_size;
+  watch.modified = info.st_mtime;
+  watch.modifiedNanos = MODIFIED_NANOS(info);
+  watch.device = info.st_dev;
+  watch.inode = info.st_ino;
+
+  /* A file that did not grow was edited in place, which the tail hash
+     alone cannot rule out; failed rows need the full diff to be retried */
+  if (sameFile && watch.format == STREAM_PLAIN && watch.syncedSize > 0 &&
+      !watch.retry && watch.size > previousSize &&
+      watch.size >= watch.syncedSize &&
+      hashFileRange(watch.filename, tailStart(watch.syncedSize),
+                    watch.syncedSize) == watch.tailHash) {
+    appended = scanAppended(&rejected);
+  }
+  if (!appended) {
+    if (!scanWholeFile(&rejected, &removed)) {
+      return 0;
+    }
+    watch.retry = 0;
+  }
+
+  if (watch.format == STREAM_PLAIN) {
+    watch.tailHash = hashFileRange(
+        watch.filename, tailStart(watch.syncedSize), watch.syncedSize);
+  }
+  applyChanges(db, appended, rejected, removed);
+  return 1;
+}
+
+void checkWatchedFile(MovieDatabase *db) {
+  if (watch.active) {
+    syncWatchedFile(db, 0);
+  }
+}
+
+#ifdef USE_THREADS
+
+/* Watch the directory rather than the file, so replacing the file (as
+   editors do when saving) keeps the watch alive */
+static void startNotify(void) {
+  watch.notifyFd = -1;
+#ifdef USE_INOTIFY
+  {
+    char directory[MAX_STRING_LENGTH];
+    char *slash;
+
+    strcpy(directory, watch.filename);
+    slash = strrchr(directory, '/');
+    if (slash == NULL) {
+      strcpy(directory, ".");
+    } else if (slash == directory) {
+      directory[1] = '\0';
+    } else {
+      *slash = '\0';
+    }
+
+    watch.notifyFd = inotify_init();
+    if (watch.notifyFd != -1 &&
+        inotify_add_watch(watch.notifyFd, directory,
+                          IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO |
+                              IN_CREATE | IN_DELETE) == -1) {
+      close(watch.notifyFd);
+      watch.notifyFd = -1;
+    }
+  }
+#endif
+  watch.status.usingInotify = watch.notifyFd != -1;
+}
+
+static void stopNotify(void) {
+#ifdef USE_INOTIFY
+  if (watch.notifyFd != -1) {
+    close(watch.notifyFd);
+  }
+#endif
+  watch.notifyFd = -1;
+
+  pthread_mutex_lock(&watchLock);
+  watch.status.usingInotify = 0;
+  pthread_mutex_unlock(&watchLock);
+}
+
+static int isStopping(void) {
+  int stopping;
+
+  pthread_mutex_lock(&watchLock);
+  stopping = watch.stopping;
+  pthread_mutex_unlock(&watchLock);
+  return stopping;
+}
+
+/* Wait for the next possible change, returns 0 once asked to stop */
+static int waitForChange(void) {
+  struct timespec deadline;
+  int stopping, waited = 0;
+#ifdef USE_INOTIFY
+  struct pollfd descriptor;
+  char events[4096];
+
+  while (watch.notifyFd != -1 && !isStopping()) {
+    descriptor.fd = watch.notifyFd;
+    descriptor.events = POLLIN;
+    if (poll(&descriptor, 1, WATCH_STOP_CHECK_MS) > 0) {
+      /* Any event in the directory - the sync skips unrelated ones */
+      if (read(watch.notifyFd, events, sizeof(events)) > 0) {
+        return 1;
+      }
+      stopNotify(); /* Poll the file from now on */
+    }
+  }
+#endif
+
+  pthread_mutex_lock(&watchLock);
+  deadline.tv_sec = time(NULL) + WATCH_POLL_SECONDS;
+  deadline.tv_nsec = 0;
+  while (!watch.stopping && waited == 0) {
+    waited = pthread_cond_timedwait(&watchStop, &watchLock, &deadline);
+  }
+  stopping = watch.stopping;
+  pthread_mutex_unlock(&watchLock);
+  return !stopping;
+}
+
+/* Watcher thread - syncs whenever the file may have changed */
+static void *watchFile(void *argument) {
+  (void)argument;
+
+  while (waitForChange()) {
+    lockDatabase();
+    syncWatchedFile(watch.db, 0);
+    unlockDatabase();
+  }
+  return NULL;
+}
+
+#endif /* USE_THREADS */
+
+static void freeWatch(void) {
+  free(watch.entries);
+  free(watch.pending);
+  free(watch.removals);
+  memset(&watch, 0, sizeof(watch));
+}
+
+int startWatch(MovieDatabase *db, const char *filename) {
+  struct stat info;
+
+  if (watch.active) {
+    printf("Error: Already watching '%s'.\n", watch.filename);
+    return 0;
+  }
+
+  memset(&watch, 0, sizeof(watch));
+  strncpy(watch.filename, filename, MAX_STRING_LENGTH - 1);
+  watch.db = db;
+  watch.capacity = 64;
+  watch.entries = (WatchEntry *)calloc((size_t)watch.capacity,
+                                       sizeof(WatchEntry));
+  if (watch.entries == NULL) {
+    printf("Error: Memory allocation failed.\n");
+    return 0;
+  }
+
+  /* The first sync is a full scan of the file */
+  if (stat(filename, &info) != 0) {
+    printf("Error: Could not open file '%s'.\n", filename);
+    freeWatch();
+    return 0;
+  }
+  if (!syncWatchedFile(db, 1)) {
+    freeWatch();
+    return 0;
+  }
+
+  strcpy(watch.status.filename, watch.filename);
+  watch.status.active = 1;
+  watch.active = 1;
+
+#ifdef USE_THREADS
+  startNotify();
+  watch.stopping = 0;
+  watch.threaded =
+      pthread_create(&watch.thread, NULL, watchFile, NULL) == 0;
+  if (!watch.threaded) {
+    stopNotify();
+  }
+#endif
+
+  return 1;
+}
+
+void getWatchStatus(WatchStatus *status) {
+#ifdef USE_THREADS
+  pthread_mutex_lock(&watchLock);
+#endif
+  *status = watch.status;
+#ifdef USE_THREADS
+  pthread_mutex_unlock(&watchLock);
+#endif
+}
+
+void stopWatch(void) {
+  if (!watch.active) {
+    return;
+  }
+
+#ifdef USE_THREADS
+  if (watch.threaded) {
+    pthread_mutex_lock(&watchLock);
+    watch.stopping = 1;
+    pthread_cond_signal(&watchStop);
+    pthread_mutex_unlock(&watchLock);
+    pthread_join(watch.thread, NULL);
+    stopNotify();
+  }
+  pthread_mutex_lock(&watchLock);
+#endif
+  freeWatch();
+#ifdef USE_THREADS
+  pthread_mutex_unlock(&watchLock);
+#endif
+}
@@ -0,0 +1,44 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "types.h"
+
+/* Seconds between checks when inotify is not available */
+#define WATCH_POLL_SECONDS 2
+
+/* Bytes before the synced offset that must be unchanged for a change to
+   count as an append */
+#define WATCH_TAIL_BYTES 256
+
+/* State and running totals of the watched file */
+typedef struct {
+  int active;
+  char filename[MAX_STRING_LENGTH];
+  int usingInotify; /* Otherwise the file is polled */
+  long appendScans; /* Changes handled by reading only the appended lines */
+  long fullScans;   /* Changes handled by a full per-code diff */
+  long added;
+  long changed;
+  long removed;
+  long rejected; /* Invalid rows, or rows that did not fit */
+} WatchStatus;
+
+/* Watch a CSV file (plain or gzip) and keep db in step with it. The first
+   line per code wins, as in a normal import; movies loaded before the
+   watch started keep their data until their line changes. A row is only
+   applied once its line is terminated, so half-written appends wait.
+   Does the initial sync right away - call with the database lock held.
+   Returns 0 if the file could not be read */
+int startWatch(MovieDatabase *db, const char *filename);
+
+/* Apply changes since the last sync, if any - call with the database lock
+   held. The watcher thread does this by itself, the menu loop calls it so
+   builds without threads stay in step too */
+void checkWatchedFile(MovieDatabase *db);
+
+void getWatchStatus(WatchStatus *status);
+
+/* Stop watching - call without the database lock */
+void stopWatch(void);
+
+#endif /* WATCH_H */